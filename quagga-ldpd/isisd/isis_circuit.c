@@ -39,6 +39,7 @@
 #include "hash.h"
 #include "prefix.h"
 #include "stream.h"
+#include "zclient.h"
 
 #include "isisd/dict.h"
 #include "isisd/include-netbsd/iso.h"
@@ -621,6 +622,34 @@ isis_circuit_stream(struct isis_circuit *circuit, struct stream **stream)
     }
 }
 
+/*
+ * LDP-IGP synchronization (RFC 5443): ldpd reported a new state for the
+ * link, regenerate our LSPs so the IS neighbor metric follows it.
+ */
+void
+isis_circuit_ldp_sync_set (struct isis_circuit *circuit, u_char state)
+{
+  if (circuit->ldp_sync == state)
+    return;
+  circuit->ldp_sync = state;
+
+  if (circuit->area && circuit->area->ldp_sync)
+    lsp_regenerate_schedule (circuit->area, circuit->is_type, 0);
+}
+
+/*
+ * Should the link be advertised with the maximum metric while LDP has not
+ * finished exchanging labels over it?
+ */
+int
+isis_circuit_ldp_sync_hold (struct isis_circuit *circuit)
+{
+  if (circuit->area == NULL || !circuit->area->ldp_sync)
+    return 0;
+
+  return (circuit->ldp_sync == LDP_IGP_SYNC_NOT_ACHIEVED);
+}
+
 int
 isis_circuit_up (struct isis_circuit *circuit)
 {
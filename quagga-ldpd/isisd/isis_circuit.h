@@ -126,6 +126,7 @@ struct isis_circuit
   u_int16_t upadjcount[2];
 #define ISIS_CIRCUIT_FLAPPED_AFTER_SPF 0x01
   u_char flags;
+  u_char ldp_sync;		/* LDP-IGP sync state reported by ldpd */
   /*
    * Counters as in 10589--11.2.5.9
    */
@@ -166,5 +167,7 @@ void isis_circuit_print_vty (struct isis_circuit *circuit, struct vty *vty,
                              char detail);
 size_t isis_circuit_pdu_size(struct isis_circuit *circuit);
 void isis_circuit_stream(struct isis_circuit *circuit, struct stream **stream);
+void isis_circuit_ldp_sync_set (struct isis_circuit *circuit, u_char state);
+int isis_circuit_ldp_sync_hold (struct isis_circuit *circuit);
 
 #endif /* _ZEBRA_ISIS_CIRCUIT_H */
@@ -31,6 +31,7 @@
 #define MAX_NARROW_PATH_METRIC        1023
 #define MAX_WIDE_LINK_METRIC          0x00FFFFFF  /* RFC4444 */
 #define MAX_WIDE_PATH_METRIC          0xFE000000  /* RFC3787 */
+#define LDP_SYNC_WIDE_LINK_METRIC     0x00FFFFFE  /* RFC5443 */
 #define ISO_SAP                       0xFE
 #define INTRADOMAIN_ROUTEING_SELECTOR 0
 #define SEQUENCE_MODULUS              4294967296
@@ -1581,6 +1581,8 @@ lsp_build (struct isis_lsp *lsp, struct isis_area *area)
 		    memcpy (is_neigh->neigh_id,
 			    circuit->u.bc.l2_desig_is, ISIS_SYS_ID_LEN + 1);
 		  is_neigh->metrics = circuit->metrics[level - 1];
+		  if (isis_circuit_ldp_sync_hold (circuit))
+		    is_neigh->metrics.metric_default = MAX_NARROW_LINK_METRIC;
                   if (!memcmp (is_neigh->neigh_id, zero_id,
                                ISIS_SYS_ID_LEN + 1))
                     {
@@ -1615,6 +1617,8 @@ lsp_build (struct isis_lsp *lsp, struct isis_area *area)
 		    metric = circuit->metrics[level - 1].metric_default;
 		  else
 		    metric = circuit->te_metric[level - 1];
+		  if (isis_circuit_ldp_sync_hold (circuit))
+		    metric = LDP_SYNC_WIDE_LINK_METRIC;
 		  SET_TE_METRIC(te_is_neigh, metric);
                   if (!memcmp (te_is_neigh->neigh_id, zero_id,
                                ISIS_SYS_ID_LEN + 1))
@@ -1652,6 +1656,8 @@ lsp_build (struct isis_lsp *lsp, struct isis_area *area)
 		  is_neigh = XCALLOC (MTYPE_ISIS_TLV, sizeof (struct is_neigh));
 		  memcpy (is_neigh->neigh_id, nei->sysid, ISIS_SYS_ID_LEN);
 		  is_neigh->metrics = circuit->metrics[level - 1];
+		  if (isis_circuit_ldp_sync_hold (circuit))
+		    is_neigh->metrics.metric_default = MAX_NARROW_LINK_METRIC;
 		  listnode_add (tlv_data.is_neighs, is_neigh);
 		  lsp_debug("ISIS (%s): Adding old-style is reach for %s", area->area_tag,
                             sysid_print(is_neigh->neigh_id));
@@ -1669,6 +1675,8 @@ lsp_build (struct isis_lsp *lsp, struct isis_area *area)
 					 sizeof (struct te_is_neigh));
 		  memcpy (te_is_neigh->neigh_id, nei->sysid, ISIS_SYS_ID_LEN);
 		  metric = circuit->te_metric[level - 1];
+		  if (isis_circuit_ldp_sync_hold (circuit))
+		    metric = LDP_SYNC_WIDE_LINK_METRIC;
 		  SET_TE_METRIC(te_is_neigh, metric);
 		  listnode_add (tlv_data.te_is_neighs, te_is_neigh);
 		  lsp_debug("ISIS (%s): Adding te-style is reach for %s", area->area_tag,
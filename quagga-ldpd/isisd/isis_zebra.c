@@ -158,6 +158,30 @@ isis_zebra_if_state_down (int command, struct zclient *zclient,
   return 0;
 }
 
+static int
+isis_zebra_ldp_sync_update (int command, struct zclient *zclient,
+			    zebra_size_t length, vrf_id_t vrf_id)
+{
+  struct stream *stream = zclient->ibuf;
+  struct interface *ifp;
+  struct isis_circuit *circuit;
+  ifindex_t ifindex;
+  u_char state;
+
+  ifindex = stream_getl (stream);
+  state = stream_getc (stream);
+
+  ifp = if_lookup_by_index_vrf (ifindex, vrf_id);
+  if (ifp == NULL)
+    return 0;
+
+  circuit = circuit_scan_by_ifp (ifp);
+  if (circuit)
+    isis_circuit_ldp_sync_set (circuit, state);
+
+  return 0;
+}
+
 static int
 isis_zebra_if_address_add (int command, struct zclient *zclient,
 			   zebra_size_t length, vrf_id_t vrf_id)
@@ -680,6 +704,7 @@ isis_zebra_init (struct thread_master *master)
   zclient->interface_address_delete = isis_zebra_if_address_del;
   zclient->ipv4_route_add = isis_zebra_read_ipv4;
   zclient->ipv4_route_delete = isis_zebra_read_ipv4;
+  zclient->ldp_sync_update = isis_zebra_ldp_sync_update;
 #ifdef HAVE_IPV6
   zclient->ipv6_route_add = isis_zebra_read_ipv6;
   zclient->ipv6_route_delete = isis_zebra_read_ipv6;
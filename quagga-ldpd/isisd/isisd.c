@@ -2382,6 +2382,47 @@ DEFUN (no_dynamic_hostname,
   return CMD_SUCCESS;
 }
 
+DEFUN (isis_mpls_ldp_sync,
+       isis_mpls_ldp_sync_cmd,
+       "mpls ldp-sync",
+       "MPLS specific commands\n"
+       "Enable LDP-IGP synchronization\n")
+{
+  struct isis_area *area;
+
+  area = vty->index;
+  assert (area);
+
+  if (!area->ldp_sync)
+    {
+      area->ldp_sync = 1;
+      lsp_regenerate_schedule (area, IS_LEVEL_1 | IS_LEVEL_2, 0);
+    }
+
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_isis_mpls_ldp_sync,
+       no_isis_mpls_ldp_sync_cmd,
+       "no mpls ldp-sync",
+       NO_STR
+       "MPLS specific commands\n"
+       "Enable LDP-IGP synchronization\n")
+{
+  struct isis_area *area;
+
+  area = vty->index;
+  assert (area);
+
+  if (area->ldp_sync)
+    {
+      area->ldp_sync = 0;
+      lsp_regenerate_schedule (area, IS_LEVEL_1 | IS_LEVEL_2, 0);
+    }
+
+  return CMD_SUCCESS;
+}
+
 DEFUN (spf_interval,
        spf_interval_cmd,
        "spf-interval <1-120>",
@@ -3022,6 +3063,12 @@ isis_config_write (struct vty *vty)
 	    vty_out (vty, " no hostname dynamic%s", VTY_NEWLINE);
 	    write++;
 	  }
+	/* ISIS - LDP-IGP synchronization */
+	if (area->ldp_sync)
+	  {
+	    vty_out (vty, " mpls ldp-sync%s", VTY_NEWLINE);
+	    write++;
+	  }
 	/* ISIS - Metric-Style - when true displays wide */
 	if (area->newmetric)
 	  {
@@ -3442,6 +3489,9 @@ isis_init ()
   install_element (ISIS_NODE, &dynamic_hostname_cmd);
   install_element (ISIS_NODE, &no_dynamic_hostname_cmd);
 
+  install_element (ISIS_NODE, &isis_mpls_ldp_sync_cmd);
+  install_element (ISIS_NODE, &no_isis_mpls_ldp_sync_cmd);
+
   install_element (ISIS_NODE, &metric_style_cmd);
   install_element (ISIS_NODE, &no_metric_style_cmd);
 
@@ -103,6 +103,8 @@ struct isis_area
   char overload_bit;
   /* L1/L2 router identifier for inter-area traffic */
   char attached_bit;
+  /* RFC5443 LDP-IGP synchronization */
+  char ldp_sync;
   u_int16_t lsp_refresh[ISIS_LEVELS];
   /* minimum time allowed before lsp retransmission */
   u_int16_t lsp_gen_interval[ISIS_LEVELS];
@@ -25,12 +25,63 @@
 #include "ldpe.h"
 #include "log.h"
 
-static int	 adj_itimer(struct thread *);
+static __inline int adj_compare(struct adj *, struct adj *);
+static void	 adj_itimer(void *);
 static void	 tnbr_del(struct tnbr *);
 static int	 tnbr_hello_timer(struct thread *);
 static void	 tnbr_start_hello_timer(struct tnbr *);
 static void	 tnbr_stop_hello_timer(struct tnbr *);
 
+RB_GENERATE(global_adj_head, adj, global_entry, adj_compare)
+
+/*
+ * Adjacencies are indexed by lsr-id and hello source, so that every
+ * received hello finds its adjacency without a list walk. Targeted sources
+ * compare by address rather than by tnbr, which lets recv_hello() look an
+ * adjacency up before it knows the tnbr.
+ */
+static __inline int
+adj_compare(struct adj *a, struct adj *b)
+{
+	int		 r;
+
+	if (ntohl(a->lsr_id.s_addr) < ntohl(b->lsr_id.s_addr))
+		return (-1);
+	if (ntohl(a->lsr_id.s_addr) > ntohl(b->lsr_id.s_addr))
+		return (1);
+	if (a->source.type < b->source.type)
+		return (-1);
+	if (a->source.type > b->source.type)
+		return (1);
+
+	switch (a->source.type) {
+	case HELLO_LINK:
+		/* a lookup key without an interface sorts first */
+		if (a->source.link.ia == NULL || b->source.link.ia == NULL)
+			return ((a->source.link.ia != NULL) -
+			    (b->source.link.ia != NULL));
+		if (a->source.link.ia->af < b->source.link.ia->af)
+			return (-1);
+		if (a->source.link.ia->af > b->source.link.ia->af)
+			return (1);
+		r = strcmp(a->source.link.ia->iface->name,
+		    b->source.link.ia->iface->name);
+		if (r != 0)
+			return (r);
+		return (ldp_addrcmp(a->source.link.ia->af,
+		    &a->source.link.src_addr, &b->source.link.src_addr));
+	case HELLO_TARGETED:
+		if (a->source.target->af < b->source.target->af)
+			return (-1);
+		if (a->source.target->af > b->source.target->af)
+			return (1);
+		return (ldp_addrcmp(a->source.target->af,
+		    &a->source.target->addr, &b->source.target->addr));
+	default:
+		fatalx("adj_compare: unknown hello type");
+	}
+}
+
 struct adj *
 adj_new(struct in_addr lsr_id, struct hello_source *source,
     union ldpd_addr *addr)
@@ -47,8 +98,10 @@ adj_new(struct in_addr lsr_id, struct hello_source *source,
 	adj->nbr = NULL;
 	adj->source = *source;
 	adj->trans_addr = *addr;
+	wheel_timer_init(&adj->inactivity_timer, adj_itimer, adj);
 
-	LIST_INSERT_HEAD(&global.adj_list, adj, global_entry);
+	if (RB_INSERT(global_adj_head, &global.adj_tree, adj) != NULL)
+		fatalx("adj_new: RB_INSERT failed");
 
 	switch (source->type) {
 	case HELLO_LINK:
@@ -65,17 +118,21 @@ adj_new(struct in_addr lsr_id, struct hello_source *source,
 static void
 adj_del_single(struct adj *adj)
 {
+	struct iface	*iface = NULL;
+
 	log_debug("%s: lsr-id %s, %s (%s)", __func__, inet_ntoa(adj->lsr_id),
 	    log_hello_src(&adj->source), af_name(adj_get_af(adj)));
 
 	adj_stop_itimer(adj);
 
-	LIST_REMOVE(adj, global_entry);
+	RB_REMOVE(global_adj_head, &global.adj_tree, adj);
 	if (adj->nbr)
 		LIST_REMOVE(adj, nbr_entry);
 	switch (adj->source.type) {
 	case HELLO_LINK:
 		LIST_REMOVE(adj, ia_entry);
+		if (adj->nbr)
+			iface = adj->source.link.ia->iface;
 		break;
 	case HELLO_TARGETED:
 		adj->source.target->adj = NULL;
@@ -83,6 +140,9 @@ adj_del_single(struct adj *adj)
 	}
 
 	free(adj);
+
+	if (iface)
+		if_ldp_sync_update(iface);
 }
 
 void
@@ -107,29 +167,14 @@ adj_del(struct adj *adj, uint32_t notif_status)
 }
 
 struct adj *
-adj_find(struct hello_source *source)
+adj_find(struct in_addr lsr_id, struct hello_source *source)
 {
-	struct adj *adj;
-
-	LIST_FOREACH(adj, &global.adj_list, global_entry) {
-		if (adj->source.type != source->type)
-			continue;
-
-		switch (source->type) {
-		case HELLO_LINK:
-			if (ldp_addrcmp(source->link.ia->af,
-			    &adj->source.link.src_addr,
-			    &source->link.src_addr) == 0)
-				return (adj);
-			break;
-		case HELLO_TARGETED:
-			if (adj->source.target == source->target)
-				return (adj);
-			break;
-		}
-	}
+	struct adj	 adj;
 
-	return (NULL);
+	adj.lsr_id = lsr_id;
+	adj.source = *source;
+
+	return (RB_FIND(global_adj_head, &global.adj_tree, &adj));
 }
 
 int
@@ -147,13 +192,10 @@ adj_get_af(struct adj *adj)
 
 /* adjacency timers */
 
-/* ARGSUSED */
-static int
-adj_itimer(struct thread *thread)
+static void
+adj_itimer(void *arg)
 {
-	struct adj *adj = THREAD_ARG(thread);
-
-	adj->inactivity_timer = NULL;
+	struct adj *adj = arg;
 
 	log_debug("%s: lsr-id %s", __func__, inet_ntoa(adj->lsr_id));
 
@@ -162,28 +204,26 @@ adj_itimer(struct thread *thread)
 		    adj->source.target->pw_count == 0) {
 			/* remove dynamic targeted neighbor */
 			tnbr_del(adj->source.target);
-			return (0);
+			return;
 		}
 		adj->source.target->adj = NULL;
 	}
 
 	adj_del(adj, S_HOLDTIME_EXP);
-
-	return (0);
 }
 
+/* re-armed on every hello, so it lives on the ldpe timer wheel */
 void
 adj_start_itimer(struct adj *adj)
 {
-	THREAD_TIMER_OFF(adj->inactivity_timer);
-	adj->inactivity_timer = thread_add_timer(master, adj_itimer, adj,
-	    adj->holdtime);
+	wheel_timer_add(ldpe_timers, &adj->inactivity_timer,
+	    adj->holdtime * 1000UL);
 }
 
 void
 adj_stop_itimer(struct adj *adj)
 {
-	THREAD_TIMER_OFF(adj->inactivity_timer);
+	wheel_timer_del(ldpe_timers, &adj->inactivity_timer);
 }
 
 /* targeted neighbors */
@@ -241,9 +241,11 @@ control_dispatch_imsg(struct thread *thread)
 			ldpe_adj_ctl(c);
 			break;
 		case IMSG_CTL_MLDP_LSP:
+		case IMSG_CTL_SHOW_MLDP:
 		case IMSG_CTL_SHOW_LIB:
 		case IMSG_CTL_SHOW_L2VPN_PW:
 		case IMSG_CTL_SHOW_L2VPN_BINDING:
+		case IMSG_CTL_SHOW_LABELS:
 			c->iev.ibuf.pid = imsg.hdr.pid;
 			ldpe_imsg_compose_lde(imsg.hdr.type, 0, imsg.hdr.pid,
 			    imsg.data, imsg.hdr.len - IMSG_HEADER_SIZE);
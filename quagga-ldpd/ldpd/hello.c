@@ -39,7 +39,7 @@ send_hello(enum hello_type type, struct iface_af *ia, struct tnbr *tnbr)
 	union ldpd_addr		 dst;
 	uint16_t		 size, holdtime = 0, flags = 0;
 	int			 fd = 0;
-	struct ibuf		*buf;
+	static struct ibuf	*buf;
 	int			 err = 0;
 
 	switch (type) {
@@ -94,9 +94,10 @@ send_hello(enum hello_type type, struct iface_af *ia, struct tnbr *tnbr)
 	if (ldp_is_dual_stack(leconf))
 		size += sizeof(struct hello_prms_opt4_tlv);
 
-	/* generate message */
-	if ((buf = ibuf_open(size)) == NULL)
+	/* generate message, hellos are small so one buffer serves them all */
+	if (buf == NULL && (buf = ibuf_open(LDP_MAX_LEN)) == NULL)
 		fatal(__func__);
+	buf->wpos = 0;
 
 	err |= gen_ldp_hdr(buf, size);
 	size -= LDP_HDR_SIZE;
@@ -133,10 +134,8 @@ send_hello(enum hello_type type, struct iface_af *ia, struct tnbr *tnbr)
 	if (ldp_is_dual_stack(leconf))
 		err |= gen_ds_hello_prms_tlv(buf, leconf->trans_pref);
 
-	if (err) {
-		ibuf_free(buf);
+	if (err)
 		return (-1);
-	}
 
 	switch (type) {
 	case HELLO_LINK:
@@ -153,7 +152,6 @@ send_hello(enum hello_type type, struct iface_af *ia, struct tnbr *tnbr)
 	}
 
 	send_packet(fd, af, &dst, ia, buf->buf, buf->wpos);
-	ibuf_free(buf);
 
 	return (0);
 }
@@ -163,7 +161,7 @@ recv_hello(struct in_addr lsr_id, struct ldp_msg *msg, int af,
     union ldpd_addr *src, struct iface *iface, int multicast, char *buf,
     uint16_t len)
 {
-	struct adj		*adj = NULL;
+	struct adj		*adj = NULL, *stale;
 	struct nbr		*nbr, *nbrt;
 	uint16_t		 holdtime = 0, flags = 0;
 	int			 tlvs_rcvd;
@@ -176,6 +174,7 @@ recv_hello(struct in_addr lsr_id, struct ldp_msg *msg, int af,
 	struct hello_source	 source;
 	struct iface_af		*ia = NULL;
 	struct tnbr		*tnbr = NULL;
+	struct tnbr		 tkey;
 
 	r = tlv_decode_hello_prms(buf, len, &holdtime, &flags);
 	if (r == -1) {
@@ -255,13 +254,26 @@ recv_hello(struct in_addr lsr_id, struct ldp_msg *msg, int af,
 			return;
 		}
 
-		tnbr = tnbr_find(leconf, af, src);
+		/*
+		 * Fast path: an existing adjacency leads straight to its
+		 * tnbr, the lookup key only needs the address.
+		 */
+		tkey.af = af;
+		tkey.addr = *src;
+		source.type = HELLO_TARGETED;
+		source.target = &tkey;
+		if ((adj = adj_find(lsr_id, &source)) != NULL)
+			tnbr = adj->source.target;
+		else
+			tnbr = tnbr_find(leconf, af, src);
 
 		/* remove the dynamic tnbr if the 'R' bit was cleared */
 		if (tnbr && (tnbr->flags & F_TNBR_DYNAMIC) &&
 		    !((flags & F_HELLO_REQ_TARG))) {
 			tnbr->flags &= ~F_TNBR_DYNAMIC;
 			tnbr = tnbr_check(tnbr);
+			if (tnbr == NULL)
+				adj = NULL;
 		}
 
 		if (!tnbr) {
@@ -276,16 +288,30 @@ recv_hello(struct in_addr lsr_id, struct ldp_msg *msg, int af,
 			LIST_INSERT_HEAD(&leconf->tnbr_list, tnbr, entry);
 		}
 
-		source.type = HELLO_TARGETED;
 		source.target = tnbr;
+
+		/* the remote lsr-id changed, the old adjacency is stale */
+		if (adj == NULL && tnbr->adj)
+			adj_del(tnbr->adj, S_SHUTDOWN);
 	} else {
 		ia = iface_af_get(iface, af);
 		source.type = HELLO_LINK;
 		source.link.ia = ia;
 		source.link.src_addr = *src;
+		adj = adj_find(lsr_id, &source);
+
+		/* the remote lsr-id changed, the old adjacency is stale */
+		if (adj == NULL) {
+			LIST_FOREACH(stale, &ia->adj_list, ia_entry) {
+				if (ldp_addrcmp(af, &stale->source.link.src_addr,
+				    src) == 0) {
+					adj_del(stale, S_SHUTDOWN);
+					break;
+				}
+			}
+		}
 	}
 
-	adj = adj_find(&source);
 	nbr = nbr_find_ldpid(lsr_id.s_addr);
 
 	/* check dual-stack tlv */
@@ -365,6 +391,8 @@ recv_hello(struct in_addr lsr_id, struct ldp_msg *msg, int af,
 		if (nbr) {
 			adj->nbr = nbr;
 			LIST_INSERT_HEAD(&nbr->adj_list, adj, nbr_entry);
+			if (source.type == HELLO_LINK)
+				if_ldp_sync_update(source.link.ia->iface);
 		}
 	}
 
@@ -24,6 +24,7 @@
 #include "ldp_debug.h"
 
 static int	gen_init_prms_tlv(struct ibuf *, struct nbr *);
+static int	gen_ft_sess_tlv(struct ibuf *);
 
 void
 send_init(struct nbr *nbr)
@@ -35,6 +36,8 @@ send_init(struct nbr *nbr)
 	debug_msg_send("initialization: lsr-id %s", inet_ntoa(nbr->id));
 
 	size = LDP_HDR_SIZE + LDP_MSG_SIZE + SESS_PRMS_SIZE;
+	if (leconf->flags & F_LDPD_GR)
+		size += FT_SESS_SIZE;
 	if ((buf = ibuf_open(size)) == NULL)
 		fatal(__func__);
 
@@ -43,6 +46,8 @@ send_init(struct nbr *nbr)
 	err |= gen_msg_hdr(buf, MSG_TYPE_INIT, size);
 	size -= LDP_MSG_SIZE;
 	err |= gen_init_prms_tlv(buf, nbr);
+	if (leconf->flags & F_LDPD_GR)
+		err |= gen_ft_sess_tlv(buf);
 	if (err) {
 		ibuf_free(buf);
 		return;
@@ -56,6 +61,7 @@ recv_init(struct nbr *nbr, char *buf, uint16_t len)
 {
 	struct ldp_msg		msg;
 	struct sess_prms_tlv	sess;
+	struct ft_sess_tlv	ft;
 	uint16_t		max_pdu_len;
 
 	debug_msg_recv("initialization: lsr-id %s", inet_ntoa(nbr->id));
@@ -90,6 +96,8 @@ recv_init(struct nbr *nbr, char *buf, uint16_t len)
 	buf += SESS_PRMS_SIZE;
 	len -= SESS_PRMS_SIZE;
 
+	nbr->flags &= ~F_NBR_GR_NEGOTIATED;
+
 	/* Optional Parameters */
 	while (len > 0) {
 		struct tlv 	tlv;
@@ -116,6 +124,24 @@ recv_init(struct nbr *nbr, char *buf, uint16_t len)
 		case TLV_TYPE_FRSESSION:
 			session_shutdown(nbr, S_BAD_TLV_VAL, msg.id, msg.type);
 			return (-1);
+		case TLV_TYPE_FTSESSION:
+			if (tlv_len != FT_SESS_LEN) {
+				session_shutdown(nbr, S_BAD_TLV_LEN, msg.id,
+				    msg.type);
+				return (-1);
+			}
+			memcpy(&ft, buf - TLV_HDR_SIZE, sizeof(ft));
+
+			/* RFC 3478: graceful restart uses only the L flag */
+			if (!(leconf->flags & F_LDPD_GR) ||
+			    !(ntohs(ft.flags) & F_FT_LEARN))
+				break;
+			nbr->flags |= F_NBR_GR_NEGOTIATED;
+			nbr->gr_reconnect = min(ntohl(ft.reconnect_time) / 1000,
+			    0xffff);
+			nbr->gr_recovery = min(ntohl(ft.recovery_time) / 1000,
+			    0xffff);
+			break;
 		default:
 			if (!(ntohs(tlv.type) & UNKNOWN_FLAG))
 				send_notification_nbr(nbr, S_UNKNOWN_TLV,
@@ -163,3 +189,28 @@ gen_init_prms_tlv(struct ibuf *buf, struct nbr *nbr)
 
 	return (ibuf_add(buf, &parms, SESS_PRMS_SIZE));
 }
+
+static int
+gen_ft_sess_tlv(struct ibuf *buf)
+{
+	struct ft_sess_tlv	ft;
+	struct timeval		now;
+	uint32_t		recovery = 0;
+
+	/*
+	 * Only advertise a recovery time while zebra still holds the LSPs of
+	 * our previous incarnation, see ldp_zebra_read_gr_stale().
+	 */
+	gettimeofday(&now, NULL);
+	if (global.gr_recovery_end > now.tv_sec)
+		recovery = global.gr_recovery_end - now.tv_sec;
+
+	memset(&ft, 0, sizeof(ft));
+	ft.type = htons(TLV_TYPE_FTSESSION);
+	ft.length = htons(FT_SESS_LEN);
+	ft.flags = htons(F_FT_LEARN);
+	ft.reconnect_time = htonl(DEFAULT_GR_RECONNECT * 1000);
+	ft.recovery_time = htonl(recovery * 1000);
+
+	return (ibuf_add(buf, &ft, FT_SESS_SIZE));
+}
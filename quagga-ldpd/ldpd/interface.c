@@ -93,6 +93,10 @@ if_exit(struct iface *iface)
 	if (iface->ipv6.state == IF_STA_ACTIVE)
 		if_reset(iface, AF_INET6);
 
+	/* LDP is no longer configured here, release the IGP */
+	iface->ipv4.enabled = iface->ipv6.enabled = 0;
+	if_ldp_sync_update(iface);
+
 	while ((if_addr = LIST_FIRST(&iface->addr_list)) != NULL) {
 		LIST_REMOVE(if_addr, entry);
 		free(if_addr);
@@ -373,6 +377,8 @@ if_update(struct iface *iface, int af)
 		if_update_af(&iface->ipv4, link_ok);
 	if (af == AF_INET6 || af == AF_UNSPEC)
 		if_update_af(&iface->ipv6, link_ok);
+
+	if_ldp_sync_update(iface);
 }
 
 void
@@ -384,6 +390,41 @@ if_update_all(int af)
 		if_update(iface, af);
 }
 
+/*
+ * LDP-IGP synchronization (RFC 5443). The IGP keeps advertising the
+ * maximum metric on an LDP-enabled link until a session discovered on it
+ * has received our whole label database.
+ */
+void
+if_ldp_sync_update(struct iface *iface)
+{
+	struct adj		*adj;
+	struct ldp_sync		 sync;
+	int			 state;
+
+	if (!iface->ipv4.enabled && !iface->ipv6.enabled)
+		state = LDP_SYNC_OFF;
+	else {
+		state = LDP_SYNC_NOT_ACHIEVED;
+		LIST_FOREACH(adj, &iface->ipv4.adj_list, ia_entry)
+			if (adj->nbr && adj->nbr->state == NBR_STA_OPER &&
+			    adj->nbr->flags & F_NBR_LDP_SYNC)
+				state = LDP_SYNC_ACHIEVED;
+		LIST_FOREACH(adj, &iface->ipv6.adj_list, ia_entry)
+			if (adj->nbr && adj->nbr->state == NBR_STA_OPER &&
+			    adj->nbr->flags & F_NBR_LDP_SYNC)
+				state = LDP_SYNC_ACHIEVED;
+	}
+
+	if (iface->ldp_sync == state || iface->ifindex == 0)
+		return;
+	iface->ldp_sync = state;
+
+	sync.ifindex = iface->ifindex;
+	sync.state = state;
+	ldpe_imsg_compose_parent(IMSG_LDP_IGP_SYNC, 0, &sync, sizeof(sync));
+}
+
 uint16_t
 if_get_hello_holdtime(struct iface_af *ia)
 {
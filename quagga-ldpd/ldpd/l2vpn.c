@@ -272,7 +272,7 @@ l2vpn_pw_ok(struct l2vpn_pw *pw, struct fec_nh *fnh)
 		fatalx("l2vpn_pw_ok: unknown af");
 	}
 
-	fn = (struct fec_node *)fec_find(&ft, &fec);
+	fn = fec_node_find(&fec);
 	if (fn == NULL || fn->local_label == NO_LABEL)
 		return (0);
 	/*
@@ -365,7 +365,7 @@ l2vpn_recv_pw_status(struct lde_nbr *ln, struct notify_msg *nm)
 		return;
 
 	lde_map2fec(&nm->fec, ln->id, &fec);
-	fn = (struct fec_node *)fec_find(&ft, &fec);
+	fn = fec_node_find(&fec);
 	if (fn == NULL)
 		/* unknown fec */
 		return;
@@ -405,7 +405,7 @@ l2vpn_sync_pws(int af, union ldpd_addr *addr)
 				continue;
 
 			l2vpn_pw_fec(pw, &fec);
-			fn = (struct fec_node *)fec_find(&ft, &fec);
+			fn = fec_node_find(&fec);
 			if (fn == NULL)
 				continue;
 			fnh = fec_nh_find(fn, AF_INET, (union ldpd_addr *)
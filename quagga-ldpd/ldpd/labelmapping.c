@@ -39,7 +39,10 @@ enqueue_pdu(struct nbr *nbr, struct ibuf *buf, uint16_t size)
 
 	ldp_hdr = ibuf_seek(buf, 0, sizeof(struct ldp_hdr));
 	ldp_hdr->length = htons(size);
-	evbuf_enqueue(&nbr->tcp->wbuf, buf);
+	if (buf != nbr->tcp->lbuf) {
+		evbuf_enqueue(&nbr->tcp->wbuf, buf);
+		nbr->tcp->lbuf = buf;
+	}
 }
 
 /* Generic function that handles all Label Message types */
@@ -56,6 +59,16 @@ send_labelmessage(struct nbr *nbr, uint16_t type, struct mapping_head *mh)
 	if (TAILQ_EMPTY(mh))
 		return;
 
+	/*
+	 * Keep filling the last label pdu if nothing was queued after it and
+	 * it has not been written yet (session_write() resets lbuf).
+	 */
+	if (nbr->tcp->lbuf && TAILQ_NEXT(nbr->tcp->lbuf, entry) == NULL) {
+		buf = nbr->tcp->lbuf;
+		size = buf->wpos - LDP_HDR_DEAD_LEN;
+		first = 0;
+	}
+
 	while ((me = TAILQ_FIRST(mh)) != NULL) {
 		/* generate pdu */
 		if (first) {
@@ -89,6 +102,13 @@ send_labelmessage(struct nbr *nbr, uint16_t type, struct mapping_head *mh)
 	    		if (me->map.flags & F_MAP_PW_STATUS)
 				msg_size += PW_STATUS_TLV_SIZE;
 			break;
+		case MAP_TYPE_P2MP:
+		case MAP_TYPE_MP2MP_UP:
+		case MAP_TYPE_MP2MP_DOWN:
+			msg_size += FEC_ELM_MLDP_MIN_LEN +
+			    sizeof(struct in_addr) +
+			    me->map.fec.mldp.opaque_len;
+			break;
 		}
 		if (me->map.label != NO_LABEL)
 			msg_size += LABEL_TLV_SIZE;
@@ -119,7 +139,12 @@ send_labelmessage(struct nbr *nbr, uint16_t type, struct mapping_head *mh)
 			err |= gen_status_tlv(buf, me->map.st.status_code,
 			    me->map.st.msg_id, me->map.st.msg_type);
 		if (err) {
-			ibuf_free(buf);
+			if (buf == nbr->tcp->lbuf) {
+				/* already queued: drop just this message */
+				buf->wpos = LDP_HDR_DEAD_LEN + size - msg_size;
+				enqueue_pdu(nbr, buf, size - msg_size);
+			} else
+				ibuf_free(buf);
 			return;
 		}
 
@@ -146,8 +171,8 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 	uint32_t		 pw_status = 0;
 	uint8_t			 flags = 0;
 	int			 feclen, lbllen, tlen;
-	struct mapping_entry	*me;
-	struct mapping_head	 mh;
+	char			*fecbuf;
+	uint16_t		 fectotal;
 	struct map		 map;
 
 	memcpy(&msg, buf, sizeof(msg));
@@ -174,14 +199,20 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 	buf += TLV_HDR_SIZE;	/* just advance to the end of the fec header */
 	len -= TLV_HDR_SIZE;
 
-	TAILQ_INIT(&mh);
+	/*
+	 * First pass: validate the FEC elements in place. They are decoded a
+	 * second time, straight into the lde batch, once the label and the
+	 * optional TLVs that apply to all of them are known.
+	 */
+	fecbuf = buf;
+	fectotal = feclen;
 	do {
 		memset(&map, 0, sizeof(map));
 		map.msg_id = msg.id;
 
 		if ((tlen = tlv_decode_fec_elm(nbr, &msg, buf, feclen,
 		    &map)) == -1)
-			goto err;
+			return (-1);
 		if (map.type == MAP_TYPE_PWID &&
 		    !(map.flags & F_MAP_PW_ID) &&
 		    type != MSG_TYPE_LABELWITHDRAW &&
@@ -202,7 +233,7 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 			case MSG_TYPE_LABELABORTREQ:
 				session_shutdown(nbr, S_UNKNOWN_FEC, msg.id,
 				    msg.type);
-				goto err;
+				return (-1);
 			default:
 				break;
 			}
@@ -215,11 +246,9 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 		if (type != MSG_TYPE_LABELMAPPING &&
 		    tlen != feclen) {
 			session_shutdown(nbr, S_BAD_TLV_VAL, msg.id, msg.type);
-			goto err;
+			return (-1);
 		}
 
-		mapping_list_add(&mh, &map);
-
 		buf += tlen;
 		len -= tlen;
 		feclen -= tlen;
@@ -229,7 +258,7 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 	if (type == MSG_TYPE_LABELMAPPING) {
 		lbllen = tlv_decode_label(nbr, &msg, buf, len, &label);
 		if (lbllen == -1)
-			goto err;
+			return (-1);
 
 		buf += lbllen;
 		len -= lbllen;
@@ -243,14 +272,14 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 
 		if (len < sizeof(tlv)) {
 			session_shutdown(nbr, S_BAD_TLV_LEN, msg.id, msg.type);
-			goto err;
+			return (-1);
 		}
 
 		memcpy(&tlv, buf, TLV_HDR_SIZE);
 		tlv_len = ntohs(tlv.length);
 		if (tlv_len + TLV_HDR_SIZE > len) {
 			session_shutdown(nbr, S_BAD_TLV_LEN, msg.id, msg.type);
-			goto err;
+			return (-1);
 		}
 		buf += TLV_HDR_SIZE;
 		len -= TLV_HDR_SIZE;
@@ -263,7 +292,7 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 				if (tlv_len != REQID_TLV_LEN) {
 					session_shutdown(nbr, S_BAD_TLV_LEN,
 					    msg.id, msg.type);
-					goto err;
+					return (-1);
 				}
 
 				flags |= F_MAP_REQ_ID;
@@ -286,7 +315,7 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 				if (tlv_len != LABEL_TLV_LEN) {
 					session_shutdown(nbr, S_BAD_TLV_LEN,
 					    msg.id, msg.type);
-					goto err;
+					return (-1);
 				}
 
 				memcpy(&labelbuf, buf, sizeof(labelbuf));
@@ -305,7 +334,7 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 				/* unsupported */
 				session_shutdown(nbr, S_BAD_TLV_VAL, msg.id,
 				    msg.type);
-				goto err;
+				return (-1);
 				break;
 			default:
 				/* ignore */
@@ -316,7 +345,7 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 			if (tlv_len != STATUS_TLV_LEN) {
 				session_shutdown(nbr, S_BAD_TLV_LEN, msg.id,
 				    msg.type);
-				goto err;
+				return (-1);
 			}
 			/* ignore */
 			break;
@@ -326,7 +355,7 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 				if (tlv_len != PW_STATUS_TLV_LEN) {
 					session_shutdown(nbr, S_BAD_TLV_LEN,
 					    msg.id, msg.type);
-					goto err;
+					return (-1);
 				}
 
 				flags |= F_MAP_PW_STATUS;
@@ -349,31 +378,36 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 		len -= tlv_len;
 	}
 
-	/* notify lde about the received message. */
-	while ((me = TAILQ_FIRST(&mh)) != NULL) {
+	/* second pass: notify lde about the received message. */
+	for (buf = fecbuf, feclen = fectotal; feclen > 0;
+	    buf += tlen, feclen -= tlen) {
 		int imsg_type = IMSG_NONE;
 
-		me->map.flags |= flags;
-		switch (me->map.type) {
+		memset(&map, 0, sizeof(map));
+		map.msg_id = msg.id;
+		tlen = tlv_decode_fec_elm(nbr, &msg, buf, feclen, &map);
+
+		map.flags |= flags;
+		switch (map.type) {
 		case MAP_TYPE_PREFIX:
-			switch (me->map.fec.prefix.af) {
+			switch (map.fec.prefix.af) {
 			case AF_IPV4:
 				if (label == MPLS_LABEL_IPV6NULL) {
 					session_shutdown(nbr, S_BAD_TLV_VAL,
 					    msg.id, msg.type);
-					goto err;
+					return (-1);
 				}
 				if (!nbr->v4_enabled)
-					goto next;
+					continue;
 				break;
 			case AF_IPV6:
 				if (label == MPLS_LABEL_IPV4NULL) {
 					session_shutdown(nbr, S_BAD_TLV_VAL,
 					    msg.id, msg.type);
-					goto err;
+					return (-1);
 				}
 				if (!nbr->v6_enabled)
-					goto next;
+					continue;
 				break;
 			default:
 				fatalx("recv_labelmessage: unknown af");
@@ -383,21 +417,27 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 			if (label <= MPLS_LABEL_RESERVED_MAX) {
 				session_shutdown(nbr, S_BAD_TLV_VAL, msg.id,
 				    msg.type);
-				goto err;
+				return (-1);
 			}
-			if (me->map.flags & F_MAP_PW_STATUS)
-				me->map.pw_status = pw_status;
+			if (map.flags & F_MAP_PW_STATUS)
+				map.pw_status = pw_status;
+			break;
+		case MAP_TYPE_P2MP:
+		case MAP_TYPE_MP2MP_UP:
+		case MAP_TYPE_MP2MP_DOWN:
+			if (!nbr->v4_enabled)
+				continue;
 			break;
 		default:
 			break;
 		}
-		me->map.label = label;
-		if (me->map.flags & F_MAP_REQ_ID)
-			me->map.requestid = reqid;
+		map.label = label;
+		if (map.flags & F_MAP_REQ_ID)
+			map.requestid = reqid;
 
 		debug_msg_recv("%s: lsr-id %s fec %s label %s", msg_name(type),
-		    inet_ntoa(nbr->id), log_map(&me->map),
-		    log_label(me->map.label));
+		    inet_ntoa(nbr->id), log_map(&map),
+		    log_label(map.label));
 
 		switch (type) {
 		case MSG_TYPE_LABELMAPPING:
@@ -419,20 +459,10 @@ recv_labelmessage(struct nbr *nbr, char *buf, uint16_t len, uint16_t type)
 			break;
 		}
 
-		ldpe_imsg_compose_lde(imsg_type, nbr->peerid, 0, &me->map,
-		    sizeof(struct map));
-
-next:
-		TAILQ_REMOVE(&mh, me, entry);
-		free(me);
+		ldpe_imsg_batch_lde(imsg_type, nbr->peerid, &map);
 	}
 
 	return (0);
-
-err:
-	mapping_list_clr(&mh);
-
-	return (-1);
 }
 
 /* Other TLV related functions */
@@ -523,8 +553,8 @@ int
 gen_fec_tlv(struct ibuf *buf, struct map *map)
 {
 	struct tlv	ft;
-	uint16_t	family, len, pw_type, ifmtu;
-	uint8_t		pw_len = 0;
+	uint16_t	family, len, pw_type, ifmtu, opaque_len;
+	uint8_t		pw_len = 0, addr_len;
 	uint32_t	group_id, pwid;
 	int		err = 0;
 
@@ -585,6 +615,26 @@ gen_fec_tlv(struct ibuf *buf, struct map *map)
 			err |= ibuf_add(buf, &ifmtu, sizeof(uint16_t));
 		}
 		break;
+	case MAP_TYPE_P2MP:
+	case MAP_TYPE_MP2MP_UP:
+	case MAP_TYPE_MP2MP_DOWN:
+		ft.length = htons(FEC_ELM_MLDP_MIN_LEN +
+		    sizeof(map->fec.mldp.root) + map->fec.mldp.opaque_len);
+		err |= ibuf_add(buf, &ft, sizeof(ft));
+
+		err |= ibuf_add(buf, &map->type, sizeof(map->type));
+		family = htons(AF_IPV4);
+		err |= ibuf_add(buf, &family, sizeof(family));
+		addr_len = sizeof(map->fec.mldp.root);
+		err |= ibuf_add(buf, &addr_len, sizeof(addr_len));
+		err |= ibuf_add(buf, &map->fec.mldp.root,
+		    sizeof(map->fec.mldp.root));
+		opaque_len = htons(map->fec.mldp.opaque_len);
+		err |= ibuf_add(buf, &opaque_len, sizeof(opaque_len));
+		if (map->fec.mldp.opaque_len)
+			err |= ibuf_add(buf, map->fec.mldp.opaque,
+			    map->fec.mldp.opaque_len);
+		break;
 	default:
 		break;
 	}
@@ -596,8 +646,8 @@ int
 tlv_decode_fec_elm(struct nbr *nbr, struct ldp_msg *msg, char *buf,
     uint16_t len, struct map *map)
 {
-	uint16_t	off = 0;
-	uint8_t		pw_len;
+	uint16_t	off = 0, af;
+	uint8_t		pw_len, addr_len;
 
 	map->type = *buf;
 	off += sizeof(uint8_t);
@@ -732,6 +782,54 @@ tlv_decode_fec_elm(struct nbr *nbr, struct ldp_msg *msg, char *buf,
 		}
 
 		return (off);
+	case MAP_TYPE_P2MP:
+	case MAP_TYPE_MP2MP_UP:
+	case MAP_TYPE_MP2MP_DOWN:
+		if (len < FEC_ELM_MLDP_MIN_LEN) {
+			session_shutdown(nbr, S_BAD_TLV_LEN, msg->id,
+			    msg->type);
+			return (-1);
+		}
+
+		/* Address Family and Address Length */
+		memcpy(&af, buf + off, sizeof(af));
+		af = ntohs(af);
+		off += sizeof(af);
+		addr_len = buf[off];
+		off += sizeof(uint8_t);
+		if (len < FEC_ELM_MLDP_MIN_LEN + addr_len) {
+			session_shutdown(nbr, S_BAD_TLV_LEN, msg->id,
+			    msg->type);
+			return (-1);
+		}
+		if (af != AF_IPV4 || addr_len != sizeof(map->fec.mldp.root)) {
+			send_notification_nbr(nbr, S_UNSUP_ADDR, msg->id,
+			    msg->type);
+			return (-1);
+		}
+
+		/* Root Node Address */
+		memcpy(&map->fec.mldp.root, buf + off, addr_len);
+		off += addr_len;
+
+		/* Opaque Value */
+		memcpy(&map->fec.mldp.opaque_len, buf + off, sizeof(uint16_t));
+		map->fec.mldp.opaque_len = ntohs(map->fec.mldp.opaque_len);
+		off += sizeof(uint16_t);
+		if (len < off + map->fec.mldp.opaque_len) {
+			session_shutdown(nbr, S_BAD_TLV_LEN, msg->id,
+			    msg->type);
+			return (-1);
+		}
+		if (map->fec.mldp.opaque_len > MLDP_OPAQUE_MAX_LEN) {
+			send_notification_nbr(nbr, S_UNKNOWN_FEC, msg->id,
+			    msg->type);
+			return (-1);
+		}
+		memcpy(map->fec.mldp.opaque, buf + off,
+		    map->fec.mldp.opaque_len);
+
+		return (off + map->fec.mldp.opaque_len);
 	default:
 		send_notification_nbr(nbr, S_UNKNOWN_FEC, msg->id, msg->type);
 		break;
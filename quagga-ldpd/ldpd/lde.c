@@ -38,51 +38,60 @@
 static void		 lde_shutdown(void);
 static int		 lde_dispatch_imsg(struct thread *);
 static int		 lde_dispatch_parent(struct thread *);
+static void		 lde_dispatch_map(int, struct map *, struct lde_nbr *);
+static void		 lde_dispatch_kroute(int, struct kroute *);
 static __inline		 int lde_nbr_compare(struct lde_nbr *,
 			    struct lde_nbr *);
+static __inline int	 lde_nbr_id_compare(struct lde_nbr *,
+			    struct lde_nbr *);
 static struct lde_nbr	*lde_nbr_new(uint32_t, struct lde_nbr *);
 static void		 lde_nbr_del(struct lde_nbr *);
 //static struct lde_nbr	*lde_nbr_find(uint32_t);
 static void		 lde_nbr_clear(void);
+static void		 lde_nbr_gr_down(struct lde_nbr *);
+static void		 lde_nbr_gr_up(struct lde_nbr *);
+static int		 lde_nbr_gr_timer(struct thread *);
+static void		 lde_nbr_gr_flush(struct lde_nbr *);
+static void		 lde_gr_label_reserve(uint32_t);
+static void		 lde_gr_label_release(void);
+static int		 lde_gr_label_timer(struct thread *);
+static void		 lde_gr_label_recovery(uint32_t);
 
-///////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////
-static __inline int	 label_nbr_compare(struct label_nbr *, struct label_nbr *);
-
-//static struct label_nbr  *label_nbr_add(uint32_t,uint32_t ,uint32_t,struct fec *fec,enum stream_type);
-static struct label_nbr	 *label_nbr_find(uint32_t,uint32_t,struct fec *);
-static	void	label_nbr_del(struct label_nbr*);
-static void		label_nbr_clear(void);
-
-static void 	tree_up(struct in_addr root,uint8_t ov);
-static void 	tree_down(struct in_addr root,uint8_t ov);
-
-///////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////
 static void		 lde_map_free(void *);
+static void		 lde_wdraw_free(void *);
+static __inline int	 lde_addr_compare(struct lde_addr *,
+			    struct lde_addr *);
 static int		 lde_address_add(struct lde_nbr *, struct lde_addr *);
 static int		 lde_address_del(struct lde_nbr *, struct lde_addr *);
 static void		 lde_address_list_free(struct lde_nbr *);
-//static struct Information	init_info(void);
+static void		 lde_adv_filter_result(struct adv_filter_addr *);
+static void		 lde_adv_fec_update(struct fec_node *);
+static void		 lde_adv_nbr_update(struct lde_nbr *);
+static void		 lde_adv_reconcile(struct lde_nbr *, struct fec_node *,
+			    int);
 RB_GENERATE(nbr_tree, lde_nbr, entry, lde_nbr_compare)
-///////////////////////////////////////////////////////////////////
-RB_GENERATE(label_nbr_tree, label_nbr, entry, label_nbr_compare)
-
-/////////////////////////////////////////////////////////////////////
+RB_GENERATE(lde_nbr_id_tree, lde_nbr, id_entry, lde_nbr_id_compare)
+RB_GENERATE(lde_addr_tree, lde_addr, index_entry, lde_addr_compare)
 
 struct ldpd_conf	*ldeconf;
 struct nbr_tree		 lde_nbrs = RB_INITIALIZER(&lde_nbrs);
 
-////////////////////////////////////////////////////////////////////////
-struct label_nbr_tree	label_nbrs = RB_INITIALIZER(&label_nbrs);
-//struct Information  	info ;
-int leaf ;
-//////////////////////////////////////////////////////////////////////
+/* neighbors by lsr-id */
+static struct lde_nbr_id_tree lde_nbrs_id = RB_INITIALIZER(&lde_nbrs_id);
+
+/* addresses of all neighbors, by (af, addr, peerid) */
+static struct lde_addr_tree lde_addrs = RB_INITIALIZER(&lde_addrs);
 
+/* graceful restart: bindings of neighbors whose session went down */
+static LIST_HEAD(, lde_nbr) lde_nbrs_stale =
+    LIST_HEAD_INITIALIZER(lde_nbrs_stale);
 
 static struct imsgev	*iev_ldpe;
 static struct imsgev	*iev_main;
 
+/* whether neighbor lsr-ids are registered with the parent for the "to" list */
+static int		 adv_nbr_registered;
+
 /* Master of threads. */
 struct thread_master *master;
 
@@ -133,6 +142,7 @@ lde(const char *user, const char *group)
 	struct timeval		 now;
 
 	ldeconf = config_new_empty();
+	lde_label_init();
 
 #ifdef HAVE_SETPROCTITLE
 	setproctitle("label decision engine");
@@ -166,9 +176,6 @@ lde(const char *user, const char *group)
 	iev_main->handler_write = ldp_write_handler;
 	iev_main->ev_write = NULL;
 
-	/* start the LIB garbage collector */
-	lde_gc_start_timer();
-
 	gettimeofday(&now, NULL);
 	global.uptime = now.tv_sec;
 
@@ -183,12 +190,12 @@ lde(const char *user, const char *group)
 static void
 lde_shutdown(void)
 {
-	lde_gc_stop_timer();
 	lde_nbr_clear();
+	mldp_lsp_clear();
 	fec_tree_clear();
-//////////////////////
-	label_nbr_clear();
-//////////////////////
+	lde_gc_stop_timer();
+	lde_gr_label_release();
+	lde_label_clear();
 	config_clear(ldeconf);
 
 	log_info("label decision engine exiting");
@@ -218,6 +225,42 @@ lde_imsg_compose_ldpe(int type, uint32_t peerid, pid_t pid, void *data,
 	     -1, data, datalen));
 }
 
+static void
+lde_dispatch_map(int type, struct map *map, struct lde_nbr *ln)
+{
+	/* mLDP FECs are kept out of the unicast LIB */
+	if (map->type == MAP_TYPE_P2MP ||
+	    map->type == MAP_TYPE_MP2MP_UP ||
+	    map->type == MAP_TYPE_MP2MP_DOWN) {
+		mldp_recv_labelmessage(type, map, ln);
+		return;
+	}
+
+	switch (type) {
+	case IMSG_LABEL_MAPPING:
+		lde_check_mapping(map, ln);
+		break;
+	case IMSG_LABEL_REQUEST:
+		lde_check_request(map, ln);
+		break;
+	case IMSG_LABEL_RELEASE:
+		if (map->type == MAP_TYPE_WILDCARD)
+			lde_check_release_wcard(map, ln);
+		else
+			lde_check_release(map, ln);
+		break;
+	case IMSG_LABEL_WITHDRAW:
+		if (map->type == MAP_TYPE_WILDCARD)
+			lde_check_withdraw_wcard(map, ln);
+		else
+			lde_check_withdraw(map, ln);
+		break;
+	case IMSG_LABEL_ABORT:
+		/* not necessary */
+		break;
+	}
+}
+
 /* ARGSUSED */
 static int
 lde_dispatch_imsg(struct thread *thread)
@@ -226,37 +269,21 @@ lde_dispatch_imsg(struct thread *thread)
 	struct imsgbuf		*ibuf = &iev->ibuf;
 	struct imsg		 	imsg;
 	struct lde_nbr		*ln;
-///////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////
-	struct fec			fec1,fec5;
-	struct fec			*fec2,*fec3,*fec4;
-	struct fec_node 	*fn,*fn1,*fn2,*fn3;
-	struct fec_nh		*fnh,*fnh1;
-	struct lde_nbr		*ln1,*ln2;
-	struct label_nbr    *lnr,*lnr1,*lnr2,*lnr3;
-	//struct Information	info1,info2;
-	struct nbr          *nbrs;
-	struct lde_map		*me;
-	int i;
-	struct in_addr local;
-	//unit_32		peerid;
-/////////////////////////////////////////////////////
-////////////////////////////////////////////////////
-
-	struct map			 map; 
+	struct map		 map;
 	struct lde_addr		 lde_addr;
 	struct notify_msg	 nm;
+	struct mldp_lsp_info	 lsp;
+	struct fec		 fec;
 	ssize_t			 n;
+	size_t			 len, off;
 	int			 shut = 0;
-	
-	struct mldp_lsp_info	lsp;
+
 	iev->ev_read = NULL;
 
 	if ((n = imsg_read(ibuf)) == -1 && errno != EAGAIN)
 		fatal("imsg_read error");
 	if (n == 0)	/* connection closed */
 		shut = 1;
-	//init_info(info);
 	for (;;) {
 		if ((n = imsg_get(ibuf, &imsg)) == -1)
 			fatal("lde_dispatch_imsg: imsg_get error");
@@ -279,9 +306,10 @@ lde_dispatch_imsg(struct thread *thread)
 		case IMSG_LABEL_RELEASE:
 		case IMSG_LABEL_WITHDRAW:
 		case IMSG_LABEL_ABORT:
-			if (imsg.hdr.len - IMSG_HEADER_SIZE != sizeof(map))
+			/* ldpe packs a run of same-type maps into one imsg */
+			len = imsg.hdr.len - IMSG_HEADER_SIZE;
+			if (len == 0 || len % sizeof(map) != 0)
 				fatalx("lde_dispatch_imsg: wrong imsg len");
-			memcpy(&map, imsg.data, sizeof(map));
 
 			ln = lde_nbr_find(imsg.hdr.peerid);
 			if (ln == NULL) {
@@ -290,250 +318,11 @@ lde_dispatch_imsg(struct thread *thread)
 				break;
 			}
 
-			switch (imsg.hdr.type) {
-			case IMSG_LABEL_MAPPING:
-				lde_check_mapping(&map, ln);
-			/////////////////////////////////////////////////////////////
-				printf("IMSG_LABEL_MAPPING  map_label:%d pid:%d\n",map.label,ln->peerid);
-				//info1=init_info();
-				local.s_addr=inet_addr("0.0.0.0");
-				lde_map2fec(&map, ln->id, &fec1);
-				//printf("fec1:root:%s  ov:%s\n",inet_ntoa(fec1.u.ipv4.prefix),fec1.u.ipv4.prefixlen);
-				
-				lnr=label_nbr_find(map.label,ln->peerid,&fec1);
-				if(lnr==NULL){//下游节点发送的mapping
-					printf("down stream send\n");
-					RB_FOREACH(fec4,fec_tree,&ft){
-						if(fec4->u.ipv4.prefix.s_addr==fec1.u.ipv4.prefix.s_addr){
-							fn1=(struct fec_node*)fec_find(&ft,fec4);
-							printf("root:prefix:%s\n",inet_ntoa(fn1->fec.u.ipv4.prefix));
-							break;
-						}
-					}
-					
-					LIST_FOREACH(fnh1, &fn1->nexthops, entry){
-						if(fnh1->nexthop.v4.s_addr==local.s_addr){
-							printf("nexthop:%s\n",inet_ntoa(fnh1->nexthop.v4));
-							leaf = 2;
-							break;
-						}
-							
-					}
-					if(leaf==2){
-						fn = calloc(1, sizeof(*fn));
-						if (fn == NULL)
-							fatal(__func__);
-
-						fn->fec = fec1;
-						printf("fec ov:%d\n",fec1.u.ipv4.prefixlen);
-						//RB_FOREACH(lnr1, label_nbr_tree, &label_nbrs){
-							//if(info1.root_addr.s_addr==fec1.u.ipv4.prefix.s_addr&&info1.ov==fec1.u.ipv4.prefixlen){
-								printf("root find down\n");
-								RB_FOREACH(lnr,label_nbr_tree,&label_nbrs)
-									if(lnr->fec.u.ipv4.prefix.s_addr==fec1.u.ipv4.prefix.s_addr&&lnr->fec.u.ipv4.prefixlen==fec1.u.ipv4.prefixlen)
-										break;
-                                if(lnr)
-									fn->local_label=lnr->local_label;
-								else
-									fn->local_label =lde_assign_label();
-								label_nbr_add(map.label,fn->local_label,ln->peerid, &fec1, STREAM_TYPE_DOWN);
-								
-								//break;
-							//}
-                            //else printf("can't find\n");
-						//}
-									
-						LIST_INIT(&fn->upstream);
-						LIST_INIT(&fn->downstream);
-						LIST_INIT(&fn->nexthops);
-						//遍历label_nbr tree,fec=fec1,找出peerid，回复label
-					
-						if(!fec_find(&ln->sent_map, &fn->fec)){
-							lde_send_labelmapping(ln, fn, 1);
-							printf("root send labelmapping  lnid:%s\n",inet_ntoa(ln->id));
-							//printf("map infor: ln_id:%s:")
-						}
-						
-						
-						free(fn);
-					}
-					else{//下游节点发来，
-						leaf = 0;
-						RB_FOREACH(fec3,fec_tree,&ft)
-								printf("fectree:%s\n",inet_ntoa(fec3->u.ipv4.prefix));
-						printf("insert trans \n");
-						fn = calloc(1, sizeof(*fn));
-						if (fn == NULL)
-							fatal(__func__);
-						fn->fec = fec1;
-						//if(info1.root_addr.s_addr==fec1.u.ipv4.prefix.s_addr&&info1.ov==fec1.u.ipv4.prefixlen){
-								printf("real down\n");
-								RB_FOREACH(lnr,label_nbr_tree,&label_nbrs)
-									if(lnr->fec.u.ipv4.prefix.s_addr==fec1.u.ipv4.prefix.s_addr&&lnr->fec.u.ipv4.prefixlen==fec1.u.ipv4.prefixlen)
-										break;
-                                if(lnr)
-									fn->local_label=lnr->local_label;
-								else
-									fn->local_label =lde_assign_label();
-								label_nbr_add(map.label,fn->local_label,ln->peerid, &fec1, STREAM_TYPE_DOWN);
-								RB_FOREACH(lnr,label_nbr_tree,&label_nbrs){
-									printf("lnr_addr:%s  nbr:%s\n",inet_ntoa(lnr->fec.u.ipv4.prefix),inet_ntoa(lde_nbr_find(ln->peerid)->id));
-									
-								}
-								//break;
-					//	}
-							RB_FOREACH(fec3,fec_tree,&ft)
-								printf("fectree:%s\n",inet_ntoa(fec3->u.ipv4.prefix));		
-						//fn->local_label =lde_assign_label();
-						LIST_INIT(&fn->upstream);
-						LIST_INIT(&fn->downstream);
-						LIST_INIT(&fn->nexthops);
-						
-						RB_FOREACH(fec2, fec_tree, &ft){
-							if(fec2->u.ipv4.prefix.s_addr==fec1.u.ipv4.prefix.s_addr){
-								fn3=(struct fec_node*)fec_find(&ft, fec2);//找下一跳
-								LIST_FOREACH(fnh, &fn3->nexthops, entry) {
-									printf("next:%s\n",inet_ntoa(fnh->nexthop.v4));
-									ln1=lde_nbr_find_by_addr(fnh->af,&fnh->nexthop);
-									if (ln1) {
-		
-										me = (struct lde_map *)fec_find(&ln1->sent_map, &fec1);
-										if (me==NULL){
-											label_nbr_add(NO_LABEL,fn->local_label, ln1->peerid, &fec1, STREAM_TYPE_UP);
-											lde_send_labelmapping(ln1, fn, 1);
-											printf("trans sent mapping\n");
-
-										}
-		
-										else{
-											lde_send_labelmapping(ln, fn, 1);
-										}
-									}
-									
-									free(fn);
-									//free(fn3);
-									break;
-								}
-								break;//*fec2,找出root的fec_node
-							}
-						}
-							
-										
-							RB_FOREACH(fec3,fec_tree,&ft)
-								printf("fectree:%s\n",inet_ntoa(fec3->u.ipv4.prefix));
-						
-					}
-				}
-				
-				else{
-					printf("up stream send\n");
-					lnr->label=map.label;
-					if(leaf!=1){
-						//if(lnr.label==NO_LABEL){//上游发送的mapping，本节点为transit节点
-						printf("trans to down\n");
-							fn = calloc(1, sizeof(*fn));
-							if (fn == NULL)
-								fatal(__func__);
-							fn->fec = fec1;
-							RB_FOREACH(lnr1, label_nbr_tree, &label_nbrs){
-								if(lnr1->fec.u.ipv4.prefix.s_addr==fec1.u.ipv4.prefix.s_addr&&lnr1->fec.u.ipv4.prefixlen==fec1.u.ipv4.prefixlen){
-									printf("real up\n");
-									if(lnr1->local_label==NO_LABEL){
-                                		fn->local_label =lde_assign_label();
-										printf("no label");
-									}
-									else{
-										fn->local_label =lnr1->local_label;
-										printf("label:%d",fn->local_label);
-									}
-									break;
-								}
-
-							}
-							//fn->local_label =lde_assign_label();
-							LIST_INIT(&fn->upstream);
-							LIST_INIT(&fn->downstream);
-							LIST_INIT(&fn->nexthops);
-							RB_FOREACH(lnr1, label_nbr_tree, &label_nbrs){//遍历label_nbr tree,找出.type==STREAM_TYPE_DOWN
-								printf("fec1:%s--l%s--nbr:%s\n",inet_ntoa(fec1.u.ipv4.prefix),inet_ntoa(lnr1->fec.u.ipv4.prefix),inet_ntoa(lde_nbr_find(lnr1->peerid)->id));
-								printf("fec1:%d----nbr:%d\n",lnr1->fec.u.ipv4.prefixlen,fec1.u.ipv4.prefixlen);
-								if(lnr1->type==STREAM_TYPE_DOWN&&lnr1->fec.u.ipv4.prefix.s_addr==fec1.u.ipv4.prefix.s_addr&&lnr1->fec.u.ipv4.prefixlen==fec1.u.ipv4.prefixlen)
-								{	ln1=lde_nbr_find(lnr1->peerid);
-
-									printf("find down");
-								}
-								if(!fec_find(&(ln1->sent_map), &fn->fec)){
-									lde_send_labelmapping(ln1, fn, 1);
-									printf("trans->down mapping");	
-								}
-							}
-							free(fn);
-							RB_FOREACH(fec3,fec_tree,&ft)
-								printf("fectree:%s\n",inet_ntoa(fec3->u.ipv4.prefix));
-						
-						}
-						
-					}
-				
-					RB_FOREACH(lnr, label_nbr_tree, &label_nbrs){
-						ln1=lde_nbr_find(lnr->peerid);
-						if(lnr->type==STREAM_TYPE_UP)i=1;
-						else i=0;
-						printf("rtctl.prefix.v4:%s  rtctl.prefixlen:%d  \n",inet_ntoa(lnr->fec.u.ipv4.prefix),lnr->fec.u.ipv4.prefixlen); 
-						printf("rtctl.local_label:%d   \n",lnr->local_label);
-						printf("nexthop:%s\n",inet_ntoa(ln1->id));
-						printf("in_use:%d\n",i);
-						printf("rtctl.r_label:%d\n",lnr->label);
-					}
-			////////////////////////////////////////////////////////////////
-				break;
-			case IMSG_LABEL_REQUEST:
-				lde_check_request(&map, ln);
-				break;
-			case IMSG_LABEL_RELEASE:
-				if (map.type == MAP_TYPE_WILDCARD)
-					lde_check_release_wcard(&map, ln);
-				else
-					lde_check_release(&map, ln);
-				break;
-			case IMSG_LABEL_WITHDRAW:
-				if (map.type == MAP_TYPE_WILDCARD){
-					printf("rev withdraw1\n");
-					lde_check_withdraw_wcard(&map, ln);
-/////////////////////////////////////////////////////////////////////////////////////
-					printf("rev withdraw\n");
-					lde_map2fec(&map, ln->id, &fec5);
-					RB_FOREACH(lnr2,label_nbr_tree,&label_nbrs)
-						if(lnr2->local_label==map.label&&lnr2->peerid==ln->peerid)
-							break;
-					//lnr2=label_nbr_find(map.label,ln->peerid,&fec5);		
-					if(lnr2!=NULL)printf("find lnr\n");
-					label_nbr_del(lnr2);
-					RB_FOREACH(lnr,label_nbr_tree,&label_nbrs)
-						if(lnr->type==STREAM_TYPE_DOWN)break;
-					
-					//info2=init_info();
-					if(leaf!=2&&lnr==NULL){
-						RB_FOREACH(lnr3, label_nbr_tree, &label_nbrs){
-							if(lnr3->type==STREAM_TYPE_UP){		
-								lde_send_labelwithdraw(lde_nbr_find(lnr3->peerid),NULL, lnr3->label, NULL);
-								lde_send_labelrelease(lde_nbr_find(lnr3->peerid), NULL, lnr3->label);
-								label_nbr_del(lnr3);
-							}
-						}
-					}
-									
-						
-				}
-//////////////////////////////////////////////////////////////////////////////////////
-				else
-					lde_check_withdraw(&map, ln);
-				break;
-				
-			case IMSG_LABEL_ABORT:
-				/* not necessary */
-				break;
-				}
+			for (off = 0; off < len; off += sizeof(map)) {
+				memcpy(&map, (char *)imsg.data + off,
+				    sizeof(map));
+				lde_dispatch_map(imsg.hdr.type, &map, ln);
+			}
 			break;
 		case IMSG_ADDRESS_ADD:
 			if (imsg.hdr.len - IMSG_HEADER_SIZE != sizeof(lde_addr))
@@ -551,6 +340,7 @@ lde_dispatch_imsg(struct thread *thread)
 				    "already exists", __func__,
 				    log_addr(lde_addr.af, &lde_addr.addr));
 			}
+			mldp_root_update_all();
 			break;
 		case IMSG_ADDRESS_DEL:
 			if (imsg.hdr.len - IMSG_HEADER_SIZE != sizeof(lde_addr))
@@ -568,6 +358,7 @@ lde_dispatch_imsg(struct thread *thread)
 				    "does not exist", __func__,
 				    log_addr(lde_addr.af, &lde_addr.addr));
 			}
+			mldp_root_update_all();
 			break;
 		case IMSG_NOTIFICATION:
 			if (imsg.hdr.len - IMSG_HEADER_SIZE != sizeof(nm))
@@ -590,7 +381,6 @@ lde_dispatch_imsg(struct thread *thread)
 			}
 			break;
 		case IMSG_NEIGHBOR_UP:
-			printf("nbr up\n");
 			if (imsg.hdr.len - IMSG_HEADER_SIZE !=
 			    sizeof(struct lde_nbr))
 				fatalx("lde_dispatch_imsg: wrong imsg len");
@@ -598,66 +388,17 @@ lde_dispatch_imsg(struct thread *thread)
 			if (lde_nbr_find(imsg.hdr.peerid))
 				fatalx("lde_dispatch_imsg: "
 				    "neighbor already exists");
-			lde_nbr_new(imsg.hdr.peerid, imsg.data);
-
-			////////////////////////////////////////////////////////////////////////////////
-		/*	info2=init_info();
-			printf("send label start4 :%d  ,%s\n ",info2.leaf,inet_ntoa(info2.root_addr));
-			if(info2.leaf==1){
-				printf("leaf\n");
-				RB_FOREACH(fec3, fec_tree, &ft){
-					 printf("fec_prefix: %s\n",inet_ntoa(fec3->u.ipv4.prefix));
-					if(fec3->u.ipv4.prefix.s_addr==info2.root_addr.s_addr){//root路由信息已记录
-						printf("find root\n");
-						fn2 = (struct fec_node*)fec_find(&ft, fec3);
-						printf("fn2 prefix:%s\n",inet_ntoa(fn2->fec.u.ipv4.prefix));
-						LIST_FOREACH(fnh1, &fn2->nexthops, entry) {	
-							printf("next:%s\n",inet_ntoa(fnh1->nexthop.v4));
-						   ln2=lde_nbr_find_by_lsrid(fnh1->nexthop.v4);
-						
-						}
-						printf("imsg.hdr.peerid:%d  ln2 pid:%d  \n",imsg.hdr.peerid,ln2->peerid);
-						if(lde_nbr_find(imsg.hdr.peerid)==ln2){//新建立的会话是上游节点
-							printf("real up\n");
-							fec4 = calloc(1, sizeof(*fec4));
-							if (fec4 == NULL)
-								fatal(__func__);
-							fec4->type=fec3->type;
-							fec4->u.ipv4.prefix=info2.root_addr;
-							fec4->u.ipv4.prefixlen=info2.ov;
-							if(!fec_find(&(ln2->sent_map), fec4)){//未向上游发过labelmapping
-							
-								fn1 = calloc(1, sizeof(*fn1));
-								if (fn1 == NULL)
-									fatal(__func__);
-								fn1->fec = *fec4;
-								fn1->local_label =lde_assign_label();
-								LIST_INIT(&fn1->upstream);
-								LIST_INIT(&fn1->downstream);
-								LIST_INIT(&fn1->nexthops);
-								label_nbr_add(NO_LABEL, fn1->local_label, imsg.hdr.peerid, fec4, STREAM_TYPE_UP);
-								lde_send_labelmapping(ln2, fn1, 1);
-								printf("send labelmapping local label:%d  root:%s    ov:%d\n",fn1->local_label, inet_ntoa(fn1->fec.u.ipv4.prefix),fn1->fec.u.ipv4.prefixlen);
-								free(fn1);
-								RB_FOREACH(lnr1,label_nbr_tree, &label_nbrs)
-									printf("label_nbr_add:  clabel:%d  pid:%d  \n",lnr1->local_label,lnr1->peerid);
-					
-						
-							}
-						
-							free(fec4);
-							break;
-						}
-					}
-				}
-			
-			}*/
-			//////////////////////////////////////////////////////////////////////////////////
-
-			
+			ln = lde_nbr_new(imsg.hdr.peerid, imsg.data);
+			lde_nbr_gr_up(ln);
 			break;
 		case IMSG_NEIGHBOR_DOWN:
-			lde_nbr_del(lde_nbr_find(imsg.hdr.peerid));
+			ln = lde_nbr_find(imsg.hdr.peerid);
+			if (ln && ln->gr_reconnect > 0 &&
+			    (ldeconf->flags & F_LDPD_GR))
+				lde_nbr_gr_down(ln);
+			else
+				lde_nbr_del(ln);
+			mldp_root_update_all();
 			break;
 		case IMSG_CTL_SHOW_LIB:
 			rt_dump(imsg.hdr.pid);
@@ -670,16 +411,29 @@ lde_dispatch_imsg(struct thread *thread)
 			if (imsg.hdr.len - IMSG_HEADER_SIZE != sizeof(lsp))
 				fatalx("lde_dispatch_imsg: wrong imsg len");
 			memcpy(&lsp, imsg.data, sizeof(lsp));
-			log_debug("mpls mldp %s root-ip:%s lsp-id:%u", 
-			 lsp.protocol_type == MLDP_TYPE_MP2MP ? "p2mp" : "mp2mp",			 	
-			 lsp.op == OP_TYPE_ADD ? "add" : "del",
-			 inet_ntoa(lsp.root_ip), lsp.lsp_id);
-			 if(lsp.op == OP_TYPE_ADD)
-			 	tree_up(lsp.root_ip,lsp.lsp_id);
-			 if(lsp.op == OP_TYPE_DEL)
-			 	tree_down(lsp.root_ip,lsp.lsp_id);
-			lde_imsg_compose_ldpe(IMSG_CTL_MLDP_LSP, 0, imsg.hdr.pid, NULL, 0);
-			 break;
+			debug_mldp("%s %s root-ip:%s lsp-id:%u",
+			    lsp.protocol_type == MLDP_TYPE_MP2MP ? "mp2mp" :
+			    "p2mp", lsp.op == OP_TYPE_ADD ? "add" : "del",
+			    inet_ntoa(lsp.root_ip), lsp.lsp_id);
+			mldp_fec(&fec, lsp.protocol_type, lsp.root_ip,
+			    lsp.lsp_id);
+			if (lsp.op == OP_TYPE_ADD)
+				mldp_tree_up(&fec);
+			if (lsp.op == OP_TYPE_DEL)
+				mldp_tree_down(&fec);
+			mldp_fec_unref(&fec);
+			lde_imsg_compose_ldpe(IMSG_CTL_MLDP_LSP, 0, imsg.hdr.pid,
+			    NULL, 0);
+			break;
+		case IMSG_CTL_SHOW_MLDP:
+			if (imsg.hdr.len - IMSG_HEADER_SIZE !=
+			    sizeof(struct ctl_mldp_req))
+				fatalx("lde_dispatch_imsg: wrong imsg len");
+			mldp_ctl(imsg.hdr.pid, imsg.data);
+
+			lde_imsg_compose_ldpe(IMSG_CTL_END, 0,
+			    imsg.hdr.pid, NULL, 0);
+			break;
 		case IMSG_CTL_SHOW_L2VPN_PW:
 			l2vpn_pw_ctl(imsg.hdr.pid);
 
@@ -689,6 +443,12 @@ lde_dispatch_imsg(struct thread *thread)
 		case IMSG_CTL_SHOW_L2VPN_BINDING:
 			l2vpn_binding_ctl(imsg.hdr.pid);
 
+			lde_imsg_compose_ldpe(IMSG_CTL_END, 0,
+			    imsg.hdr.pid, NULL, 0);
+			break;
+		case IMSG_CTL_SHOW_LABELS:
+			lde_label_ctl(imsg.hdr.pid);
+
 			lde_imsg_compose_ldpe(IMSG_CTL_END, 0,
 			    imsg.hdr.pid, NULL, 0);
 			break;
@@ -711,6 +471,46 @@ lde_dispatch_imsg(struct thread *thread)
 	return (0);
 }
 
+static void
+lde_dispatch_kroute(int type, struct kroute *kr)
+{
+	struct fec	 fec;
+	struct fec_node	*fn;
+
+	switch (kr->af) {
+	case AF_INET:
+		fec.type = FEC_TYPE_IPV4;
+		fec.u.ipv4.prefix = kr->prefix.v4;
+		fec.u.ipv4.prefixlen = kr->prefixlen;
+		break;
+	case AF_INET6:
+		fec.type = FEC_TYPE_IPV6;
+		fec.u.ipv6.prefix = kr->prefix.v6;
+		fec.u.ipv6.prefixlen = kr->prefixlen;
+		break;
+	default:
+		fatalx("lde_dispatch_kroute: unknown af");
+	}
+
+	switch (type) {
+	case IMSG_NETWORK_ADD:
+		lde_kernel_insert(&fec, kr->af, &kr->nexthop, kr->priority,
+		    kr->flags & F_CONNECTED, NULL);
+
+		/* routes the "for" list now treats differently come again */
+		fn = fec_node_find(&fec);
+		if (fn && (fn->flags & F_FEC_NO_ADVERTISE) !=
+		    (kr->flags & F_NO_ADVERTISE ? F_FEC_NO_ADVERTISE : 0)) {
+			fn->flags ^= F_FEC_NO_ADVERTISE;
+			lde_adv_fec_update(fn);
+		}
+		break;
+	case IMSG_NETWORK_DEL:
+		lde_kernel_remove(&fec, kr->af, &kr->nexthop, kr->priority);
+		break;
+	}
+}
+
 /* ARGSUSED */
 static int
 lde_dispatch_parent(struct thread *thread)
@@ -719,17 +519,20 @@ lde_dispatch_parent(struct thread *thread)
 	struct iface		*niface;
 	struct tnbr		*ntnbr;
 	struct nbr_params	*nnbrp;
+	struct lsrid_alias	*nalias;
 	static struct l2vpn	*nl2vpn;
 	struct l2vpn_if		*nlif;
 	struct l2vpn_pw		*npw;
 	struct imsg		 imsg;
 	struct kroute		 kr;
+	struct adv_filter_addr	 fa;
 	int			 fd = THREAD_FD(thread);
 	struct imsgev		*iev = THREAD_ARG(thread);
 	struct imsgbuf		*ibuf = &iev->ibuf;
 	ssize_t			 n;
 	int			 shut = 0;
-	struct fec		 fec;
+	size_t			 len, off;
+	uint32_t		 label, recovery;
 
 	iev->ev_read = NULL;
 
@@ -747,37 +550,46 @@ lde_dispatch_parent(struct thread *thread)
 		switch (imsg.hdr.type) {
 		case IMSG_NETWORK_ADD:
 		case IMSG_NETWORK_DEL:
-			if (imsg.hdr.len != IMSG_HEADER_SIZE + sizeof(kr)) {
+			/* the parent sends route updates in batches */
+			len = imsg.hdr.len - IMSG_HEADER_SIZE;
+			if (len == 0 || len % sizeof(kr) != 0) {
 				log_warnx("%s: wrong imsg len", __func__);
 				break;
 			}
-			memcpy(&kr, imsg.data, sizeof(kr));
-
-			switch (kr.af) {
-			case AF_INET:
-				fec.type = FEC_TYPE_IPV4;
-				fec.u.ipv4.prefix = kr.prefix.v4;
-				fec.u.ipv4.prefixlen = kr.prefixlen;
-				break;
-			case AF_INET6:
-				fec.type = FEC_TYPE_IPV6;
-				fec.u.ipv6.prefix = kr.prefix.v6;
-				fec.u.ipv6.prefixlen = kr.prefixlen;
+			for (off = 0; off < len; off += sizeof(kr)) {
+				memcpy(&kr, (char *)imsg.data + off,
+				    sizeof(kr));
+				lde_dispatch_kroute(imsg.hdr.type, &kr);
+			}
+			break;
+		case IMSG_ADV_FILTER_RESULT:
+			if (imsg.hdr.len != IMSG_HEADER_SIZE + sizeof(fa)) {
+				log_warnx("%s: wrong imsg len", __func__);
 				break;
-			default:
-				fatalx("lde_dispatch_parent: unknown af");
 			}
-
-			switch (imsg.hdr.type) {
-			case IMSG_NETWORK_ADD:
-				lde_kernel_insert(&fec, kr.af, &kr.nexthop,
-				    kr.priority, kr.flags & F_CONNECTED, NULL);
+			memcpy(&fa, imsg.data, sizeof(fa));
+			lde_adv_filter_result(&fa);
+			break;
+		case IMSG_GR_STALE_LABELS:
+			len = imsg.hdr.len - IMSG_HEADER_SIZE;
+			if (len % sizeof(label)) {
+				log_warnx("%s: wrong imsg len", __func__);
 				break;
-			case IMSG_NETWORK_DEL:
-				lde_kernel_remove(&fec, kr.af, &kr.nexthop,
-				    kr.priority);
+			}
+			for (off = 0; off < len; off += sizeof(label)) {
+				memcpy(&label, (char *)imsg.data + off,
+				    sizeof(label));
+				lde_gr_label_reserve(label);
+			}
+			break;
+		case IMSG_GR_RECOVERY:
+			if (imsg.hdr.len != IMSG_HEADER_SIZE +
+			    sizeof(recovery)) {
+				log_warnx("%s: wrong imsg len", __func__);
 				break;
 			}
+			memcpy(&recovery, imsg.data, sizeof(recovery));
+			lde_gr_label_recovery(recovery);
 			break;
 		case IMSG_SOCKET_IPC:
 			if (iev_ldpe) {
@@ -809,6 +621,7 @@ lde_dispatch_parent(struct thread *thread)
 			LIST_INIT(&nconf->iface_list);
 			LIST_INIT(&nconf->tnbr_list);
 			LIST_INIT(&nconf->nbrp_list);
+			RB_INIT(&nconf->alias_tree);
 			LIST_INIT(&nconf->l2vpn_list);
 			break;
 		case IMSG_RECONF_IFACE:
@@ -838,6 +651,14 @@ lde_dispatch_parent(struct thread *thread)
 
 			LIST_INSERT_HEAD(&nconf->nbrp_list, nnbrp, entry);
 			break;
+		case IMSG_RECONF_ALIAS:
+			if ((nalias = malloc(sizeof(struct lsrid_alias))) ==
+			    NULL)
+				fatal(NULL);
+			memcpy(nalias, imsg.data, sizeof(struct lsrid_alias));
+
+			RB_INSERT(lsrid_alias_head, &nconf->alias_tree, nalias);
+			break;
 		case IMSG_RECONF_L2VPN:
 			if ((nl2vpn = malloc(sizeof(struct l2vpn))) == NULL)
 				fatal(NULL);
@@ -904,19 +725,319 @@ lde_dispatch_parent(struct thread *thread)
 	return (0);
 }
 
-uint32_t
-lde_assign_label(void)
+/*
+ * Local label allocation.  Every configured label block gets its own pool
+ * and applications without a block share the rest of the dynamic range.
+ * A pool tracks its labels in a bitmap and hands out released labels in
+ * FIFO order, so a label stays idle as long as possible before it is
+ * reused; untouched labels are taken from a cursor that only moves up.
+ * Both allocation and release are O(1).
+ */
+struct label_pool {
+	uint32_t	 min;
+	uint32_t	 max;
+	uint32_t	 next;		/* lowest label never handed out */
+	uint32_t	 used;
+	uint32_t	 reserved;	/* labels lent to configured blocks */
+	uint8_t		*inuse;		/* one bit per label */
+	uint32_t	*ring;		/* released labels, oldest first */
+	uint32_t	 ring_head;
+	uint32_t	 ring_count;
+	uint32_t	 ring_size;
+};
+
+#define LABEL_RING_MIN		64
+#define LABEL_BIT(lp, l)	((l) - (lp)->min)
+#define LABEL_ISSET(lp, l)	\
+	((lp)->inuse[LABEL_BIT(lp, l) >> 3] & (1 << (LABEL_BIT(lp, l) & 7)))
+#define LABEL_SET(lp, l)	\
+	((lp)->inuse[LABEL_BIT(lp, l) >> 3] |= (1 << (LABEL_BIT(lp, l) & 7)))
+#define LABEL_CLR(lp, l)	\
+	((lp)->inuse[LABEL_BIT(lp, l) >> 3] &= ~(1 << (LABEL_BIT(lp, l) & 7)))
+
+/* one pool per label application, the shared range is at LABEL_APP_MAX */
+static struct label_pool label_pools[LABEL_APP_MAX + 1];
+
+/*
+ * In-labels zebra still forwards on from before we restarted. They stay
+ * allocated until the graceful restart recovery period ends, so they
+ * cannot be bound to a different FEC while the stale LSPs exist.
+ */
+static uint32_t		*gr_labels;
+static uint32_t		 gr_labels_count;
+static uint32_t		 gr_labels_size;
+static struct thread	*gr_labels_timer;
+
+static void
+label_pool_init(struct label_pool *lp, uint32_t min, uint32_t max)
+{
+	memset(lp, 0, sizeof(*lp));
+	lp->min = min;
+	lp->max = max;
+	lp->next = min;
+	if ((lp->inuse = calloc((max - min) / 8 + 1, 1)) == NULL)
+		fatal(__func__);
+}
+
+static void
+label_pool_free(struct label_pool *lp)
+{
+	free(lp->inuse);
+	free(lp->ring);
+	memset(lp, 0, sizeof(*lp));
+}
+
+/* find the pool a label was allocated from */
+static struct label_pool *
+label_pool_lookup(uint32_t label)
+{
+	struct label_pool	*lp;
+	int			 app;
+
+	for (app = 0; app < LABEL_APP_MAX; app++) {
+		lp = &label_pools[app];
+		if (lp->inuse && label >= lp->min && label <= lp->max)
+			return (lp);
+	}
+	lp = &label_pools[LABEL_APP_MAX];
+	if (lp->inuse && label >= lp->min && label <= lp->max)
+		return (lp);
+
+	return (NULL);
+}
+
+/*
+ * Labels outside every pool (reserved, NO_LABEL) are ignored. Returns
+ * whether the label was free until now.
+ */
+static int
+label_pool_mark(uint32_t label)
+{
+	struct label_pool	*lp;
+
+	if ((lp = label_pool_lookup(label)) == NULL || LABEL_ISSET(lp, label))
+		return (0);
+	LABEL_SET(lp, label);
+	lp->used++;
+	return (1);
+}
+
+static void
+label_pool_release(struct label_pool *lp, uint32_t label)
 {
-	static uint32_t label = MPLS_LABEL_RESERVED_MAX;
+	uint32_t	*ring;
+	uint32_t	 size, i;
+
+	if (lp->ring_count == lp->ring_size) {
+		size = lp->ring_size ? lp->ring_size * 2 : LABEL_RING_MIN;
+		if ((ring = calloc(size, sizeof(*ring))) == NULL)
+			fatal(__func__);
+		for (i = 0; i < lp->ring_count; i++)
+			ring[i] = lp->ring[(lp->ring_head + i) % lp->ring_size];
+		free(lp->ring);
+		lp->ring = ring;
+		lp->ring_size = size;
+		lp->ring_head = 0;
+	}
+	lp->ring[(lp->ring_head + lp->ring_count) % lp->ring_size] = label;
+	lp->ring_count++;
+}
+
+static uint32_t
+label_pool_get(struct label_pool *lp)
+{
+	uint32_t	 label;
 
 	/*
-	 * TODO: request label to zebra or define a range of labels for ldpd.
+	 * After a rebuild the cursor may hand out a label that is still
+	 * queued in the ring, so stale ring entries are skipped here.
 	 */
+	while (lp->ring_count > 0) {
+		label = lp->ring[lp->ring_head];
+		lp->ring_head = (lp->ring_head + 1) % lp->ring_size;
+		lp->ring_count--;
+		if (!LABEL_ISSET(lp, label))
+			goto found;
+	}
 
-	label++;
+	while (lp->next <= lp->max && LABEL_ISSET(lp, lp->next))
+		lp->next++;
+	if (lp->next > lp->max)
+		return (NO_LABEL);
+	label = lp->next++;
+
+ found:
+	LABEL_SET(lp, label);
+	lp->used++;
 	return (label);
 }
 
+/*
+ * (Re)build the label pools from the configured blocks and re-mark the
+ * labels that are currently bound to a FEC.
+ */
+void
+lde_label_init(void)
+{
+	struct label_pool	*shared;
+	struct label_block	*lb;
+	struct fec		*f;
+	struct fec_node		*fn;
+	struct mldp_lsp		*lsp;
+	uint32_t		 label, i;
+	int			 app;
+
+	lde_label_clear();
+
+	shared = &label_pools[LABEL_APP_MAX];
+	label_pool_init(shared, MPLS_LABEL_RESERVED_MAX + 1, MPLS_LABEL_MAX);
+	for (app = 0; app < LABEL_APP_MAX; app++) {
+		lb = &ldeconf->label_blocks[app];
+		if (lb->min == 0)
+			continue;
+
+		label_pool_init(&label_pools[app], lb->min, lb->max);
+		/* keep the shared range out of the block */
+		for (label = lb->min; label <= lb->max; label++) {
+			if (LABEL_ISSET(shared, label))
+				continue;
+			LABEL_SET(shared, label);
+			shared->reserved++;
+		}
+	}
+
+	RB_FOREACH(f, fec_tree, &ft) {
+		fn = (struct fec_node *)f;
+		label_pool_mark(fn->local_label);
+	}
+	RB_FOREACH(lsp, mldp_lsp_tree, &mldp_lsps)
+		label_pool_mark(lsp->fn.local_label);
+	for (i = 0; i < gr_labels_count; i++)
+		label_pool_mark(gr_labels[i]);
+}
+
+void
+lde_label_clear(void)
+{
+	int	 app;
+
+	for (app = 0; app <= LABEL_APP_MAX; app++)
+		label_pool_free(&label_pools[app]);
+}
+
+uint32_t
+lde_assign_label(enum label_app app)
+{
+	struct label_pool	*lp;
+	uint32_t		 label;
+
+	lp = &label_pools[app];
+	if (lp->inuse == NULL)
+		lp = &label_pools[LABEL_APP_MAX];
+
+	label = label_pool_get(lp);
+	if (label == NO_LABEL)
+		log_warnx("%s: %s label space exhausted", __func__,
+		    label_app_name(lp == &label_pools[app] ? app :
+		    LABEL_APP_MAX));
+
+	return (label);
+}
+
+void
+lde_free_label(uint32_t label)
+{
+	struct label_pool	*lp;
+
+	if ((lp = label_pool_lookup(label)) == NULL ||
+	    !LABEL_ISSET(lp, label))
+		return;
+
+	LABEL_CLR(lp, label);
+	lp->used--;
+	label_pool_release(lp, label);
+}
+
+static void
+lde_gr_label_reserve(uint32_t label)
+{
+	/* already reserved, or bound before zebra told us about it */
+	if (!label_pool_mark(label))
+		return;
+
+	if (gr_labels_count == gr_labels_size) {
+		gr_labels_size = gr_labels_size ? gr_labels_size * 2 :
+		    LABEL_RING_MIN;
+		gr_labels = reallocarray(gr_labels, gr_labels_size,
+		    sizeof(*gr_labels));
+		if (gr_labels == NULL)
+			fatal(__func__);
+	}
+	gr_labels[gr_labels_count++] = label;
+}
+
+static void
+lde_gr_label_release(void)
+{
+	uint32_t	 i;
+
+	THREAD_TIMER_OFF(gr_labels_timer);
+	if (gr_labels_count > 0)
+		log_info("graceful restart: releasing %u stale labels",
+		    gr_labels_count);
+
+	for (i = 0; i < gr_labels_count; i++)
+		lde_free_label(gr_labels[i]);
+	free(gr_labels);
+	gr_labels = NULL;
+	gr_labels_count = gr_labels_size = 0;
+}
+
+static int
+lde_gr_label_timer(struct thread *thread)
+{
+	gr_labels_timer = NULL;
+	lde_gr_label_release();
+
+	return (0);
+}
+
+/* zebra sweeps the stale LSPs after this many seconds */
+static void
+lde_gr_label_recovery(uint32_t seconds)
+{
+	if (seconds == 0) {
+		lde_gr_label_release();
+		return;
+	}
+	THREAD_TIMER_OFF(gr_labels_timer);
+	gr_labels_timer = thread_add_timer(master, lde_gr_label_timer, NULL,
+	    seconds);
+}
+
+void
+lde_label_ctl(pid_t pid)
+{
+	struct label_pool	*lp;
+	struct ctl_label_space	 lctl;
+	int			 app;
+
+	for (app = 0; app <= LABEL_APP_MAX; app++) {
+		lp = &label_pools[app];
+		if (lp->inuse == NULL)
+			continue;
+
+		memset(&lctl, 0, sizeof(lctl));
+		lctl.app = app;
+		lctl.min = lp->min;
+		lctl.max = lp->max;
+		lctl.used = lp->used;
+		lctl.avail = lp->max - lp->min + 1 - lp->used - lp->reserved;
+		lde_imsg_compose_ldpe(IMSG_CTL_SHOW_LABELS, 0, pid, &lctl,
+		    sizeof(lctl));
+	}
+}
+
 void
 lde_send_change_klabel(struct fec_node *fn, struct fec_nh *fnh)
 {
@@ -979,6 +1100,8 @@ lde_send_change_klabel(struct fec_node *fn, struct fec_nh *fnh)
 		lde_imsg_compose_parent(IMSG_KPWLABEL_CHANGE, 0, &kpw,
 		    sizeof(kpw));
 		break;
+	case FEC_TYPE_MLDP:
+		break;
 	}
 }
 
@@ -1042,14 +1165,17 @@ lde_send_delete_klabel(struct fec_node *fn, struct fec_nh *fnh)
 		lde_imsg_compose_parent(IMSG_KPWLABEL_DELETE, 0, &kpw,
 		    sizeof(kpw));
 		break;
+	case FEC_TYPE_MLDP:
+		break;
 	}
 }
 
 void
 lde_fec2map(struct fec *fec, struct map *map)
 {
+	const uint8_t	*opaque;
+
 	memset(map, 0, sizeof(*map));
-	printf("fec2map:root:%s  ov:%d\n", inet_ntoa(fec->u.ipv4.prefix),fec->u.ipv4.prefixlen);
 	switch (fec->type) {
 	case FEC_TYPE_IPV4:
 		map->type = MAP_TYPE_PREFIX;
@@ -1070,14 +1196,25 @@ lde_fec2map(struct fec *fec, struct map *map)
 		map->flags |= F_MAP_PW_ID;
 		map->fec.pwid.pwid = fec->u.pwid.pwid;
 		break;
+	case FEC_TYPE_MLDP:
+		if (fec->u.mldp.type == MLDP_TYPE_P2MP)
+			map->type = MAP_TYPE_P2MP;
+		else
+			map->type = MAP_TYPE_MP2MP_DOWN;
+		map->fec.mldp.root = fec->u.mldp.root;
+		opaque = mldp_opaque_data(fec->u.mldp.opaque,
+		    &map->fec.mldp.opaque_len);
+		memcpy(map->fec.mldp.opaque, opaque,
+		    map->fec.mldp.opaque_len);
+		break;
 	}
 }
 
+/* mLDP FECs hold a reference on their opaque value, see mldp_fec_unref() */
 void
 lde_map2fec(struct map *map, struct in_addr lsr_id, struct fec *fec)
 {
 	memset(fec, 0, sizeof(*fec));
-	printf("map:root:%s   ov:%d\n",inet_ntoa(map->fec.prefix.prefix.v4), map->fec.prefix.prefixlen);
 	switch (map->type) {
 	case MAP_TYPE_PREFIX:
 		switch (map->fec.prefix.af) {
@@ -1102,6 +1239,18 @@ lde_map2fec(struct map *map, struct in_addr lsr_id, struct fec *fec)
 		fec->u.pwid.pwid = map->fec.pwid.pwid;
 		fec->u.pwid.lsr_id = lsr_id;
 		break;
+	case MAP_TYPE_P2MP:
+	case MAP_TYPE_MP2MP_UP:
+	case MAP_TYPE_MP2MP_DOWN:
+		fec->type = FEC_TYPE_MLDP;
+		if (map->type == MAP_TYPE_P2MP)
+			fec->u.mldp.type = MLDP_TYPE_P2MP;
+		else
+			fec->u.mldp.type = MLDP_TYPE_MP2MP;
+		fec->u.mldp.root = map->fec.mldp.root;
+		fec->u.mldp.opaque = mldp_opaque_get(map->fec.mldp.opaque,
+		    map->fec.mldp.opaque_len);
+		break;
 	}
 }
 
@@ -1119,6 +1268,9 @@ lde_send_labelmapping(struct lde_nbr *ln, struct fec_node *fn, int single)
 	 * ldpd).
 	 */
 
+	if (!lde_adv_permitted(ln, fn))
+		return;
+
 	lde_fec2map(&fn->fec, &map);
 	switch (fn->fec.type) {
 	case FEC_TYPE_IPV4:
@@ -1145,6 +1297,11 @@ lde_send_labelmapping(struct lde_nbr *ln, struct fec_node *fn, int single)
 			map.pw_status = PW_FORWARDING;
 		}
 		break;
+	case FEC_TYPE_MLDP:
+		if (!ln->v4_enabled)
+			return;
+		map.type = mldp_map_type(fn, ln, 0);
+		break;
 	}
 	map.label = fn->local_label;
 
@@ -1202,6 +1359,11 @@ lde_send_labelwithdraw(struct lde_nbr *ln, struct fec_node *fn, uint32_t label,
 			if (pw->flags & F_PW_CWORD)
 				map.flags |= F_MAP_PW_CWORD;
 			break;
+		case FEC_TYPE_MLDP:
+			if (!ln->v4_enabled)
+				return;
+			map.type = mldp_map_type(fn, ln, 0);
+			break;
 		}
 		map.label = fn->local_label;
 	} else {
@@ -1276,6 +1438,11 @@ lde_send_labelrelease(struct lde_nbr *ln, struct fec_node *fn, uint32_t label)
 			if (pw->flags & F_PW_CWORD)
 				map.flags |= F_MAP_PW_CWORD;
 			break;
+		case FEC_TYPE_MLDP:
+			if (!ln->v4_enabled)
+				return;
+			map.type = mldp_map_type(fn, ln, 1);
+			break;
 		}
 	} else {
 		memset(&map, 0, sizeof(map));
@@ -1310,6 +1477,16 @@ lde_nbr_compare(struct lde_nbr *a, struct lde_nbr *b)
 	return (a->peerid - b->peerid);
 }
 
+static __inline int
+lde_nbr_id_compare(struct lde_nbr *a, struct lde_nbr *b)
+{
+	if (ntohl(a->id.s_addr) < ntohl(b->id.s_addr))
+		return (-1);
+	if (ntohl(a->id.s_addr) > ntohl(b->id.s_addr))
+		return (1);
+	return (0);
+}
+
 static struct lde_nbr *
 lde_nbr_new(uint32_t peerid, struct lde_nbr *new)
 {
@@ -1321,6 +1498,8 @@ lde_nbr_new(uint32_t peerid, struct lde_nbr *new)
 	ln->id = new->id;
 	ln->v4_enabled = new->v4_enabled;
 	ln->v6_enabled = new->v6_enabled;
+	ln->gr_reconnect = new->gr_reconnect;
+	ln->gr_recovery = new->gr_recovery;
 	ln->peerid = peerid;
 	fec_init(&ln->recv_map);
 	fec_init(&ln->sent_map);
@@ -1328,9 +1507,20 @@ lde_nbr_new(uint32_t peerid, struct lde_nbr *new)
 	fec_init(&ln->sent_req);
 	fec_init(&ln->sent_wdraw);
 	TAILQ_INIT(&ln->addr_list);
+	LIST_INIT(&ln->label_nbrs);
+
+	/* nothing goes out until the "to" list permits it */
+	ln->adv_permit = 1;
+	if (adv_nbr_registered) {
+		ln->adv_permit = 0;
+		lde_adv_filter_register(IMSG_ADV_FILTER_ADD, ADV_FILTER_NBR,
+		    ln->id);
+	}
 
 	if (RB_INSERT(nbr_tree, &lde_nbrs, ln) != NULL)
 		fatalx("lde_nbr_new: RB_INSERT failed");
+	if (RB_INSERT(lde_nbr_id_tree, &lde_nbrs_id, ln) != NULL)
+		fatalx("lde_nbr_new: RB_INSERT(id) failed");
 
 	return (ln);
 }
@@ -1346,6 +1536,9 @@ lde_nbr_del(struct lde_nbr *ln)
 	if (ln == NULL)
 		return;
 
+	if (ln->gr_stale)
+		lde_nbr_gr_flush(ln->gr_stale);
+
 	/* uninstall received mappings */
 	RB_FOREACH(f, fec_tree, &ft) {
 		fn = (struct fec_node *)f;
@@ -1374,15 +1567,21 @@ lde_nbr_del(struct lde_nbr *ln)
 		}
 	}
 
+	if (adv_nbr_registered)
+		lde_adv_filter_register(IMSG_ADV_FILTER_DEL, ADV_FILTER_NBR,
+		    ln->id);
+	fec_snap_cancel(ln);
+	mldp_nbr_del(ln);
 	lde_address_list_free(ln);
 
 	fec_clear(&ln->recv_map, lde_map_free);
 	fec_clear(&ln->sent_map, lde_map_free);
 	fec_clear(&ln->recv_req, free);
 	fec_clear(&ln->sent_req, free);
-	fec_clear(&ln->sent_wdraw, free);
+	fec_clear(&ln->sent_wdraw, lde_wdraw_free);
 
 	RB_REMOVE(nbr_tree, &lde_nbrs, ln);
+	RB_REMOVE(lde_nbr_id_tree, &lde_nbrs_id, ln);
 
 	free(ln);
 }
@@ -1393,49 +1592,45 @@ lde_nbr_find(uint32_t peerid)
 	struct lde_nbr		 ln;
 
 	ln.peerid = peerid;
-	printf("lde_nbr_find:peerid:%d\n",peerid);
 	return (RB_FIND(nbr_tree, &lde_nbrs, &ln));
 }
 
+/* addr is either an lsr-id or an address configured as its alias */
 struct lde_nbr *
 lde_nbr_find_by_lsrid(struct in_addr addr)
 {
-	struct lde_nbr		*ln;
-	struct in_addr	addr1=addr;
-	struct in_addr  rt1,rt2;
-	rt1.s_addr=inet_addr("192.168.228.134");
-	rt2.s_addr=inet_addr("192.168.228.128");
-	if(rt1.s_addr==addr1.s_addr){
-		printf("addr==134   ");
-		addr1.s_addr=inet_addr("9.9.9.9");
-		printf("addr:%s",inet_ntoa(addr1));
-		}
-	else if(rt2.s_addr==addr1.s_addr)
-		addr1.s_addr=inet_addr("8.8.8.8");
-	RB_FOREACH(ln, nbr_tree, &lde_nbrs){
-		printf("ln_f_lsid:id:%s\n",inet_ntoa(ln->id));
-		if (ln->id.s_addr == addr1.s_addr){
-			printf("find lnbr\n");
-			return (ln);
-			}
-		}
-	return (NULL);
+	struct lde_nbr		 ln;
+	struct lsrid_alias	*alias;
+
+	ln.id = addr;
+	alias = lsrid_alias_find(ldeconf, addr);
+	if (alias) {
+		debug_mldp("%s: lsr-id alias %s", __func__,
+		    inet_ntoa(alias->lsr_id));
+		ln.id = alias->lsr_id;
+	}
+
+	return (RB_FIND(lde_nbr_id_tree, &lde_nbrs_id, &ln));
 }
 
+/*
+ * If several neighbors advertise the same address the one with the lowest
+ * peerid wins, as it did when walking lde_nbrs in order.
+ */
 struct lde_nbr *
 lde_nbr_find_by_addr(int af, union ldpd_addr *addr)
 {
-	struct lde_nbr		*ln;
+	struct lde_addr		*lde_addr, key;
 
-	RB_FOREACH(ln, nbr_tree, &lde_nbrs){
-		printf("nbr id:%s \n ",inet_ntoa(ln->id));
-		if (lde_address_find(ln, af, addr) != NULL){
-			printf("yes\n");
-			return (ln);
-			}
-		}
-	printf("no\n");	
-	return (NULL);
+	key.af = af;
+	key.addr = *addr;
+	key.peerid = 0;
+	lde_addr = RB_NFIND(lde_addr_tree, &lde_addrs, &key);
+	if (lde_addr == NULL || lde_addr->af != af ||
+	    ldp_addrcmp(af, &lde_addr->addr, addr) != 0)
+		return (NULL);
+
+	return (lde_addr->nbr);
 }
 
 
@@ -1446,210 +1641,178 @@ lde_nbr_clear(void)
 
 	 while ((ln = RB_ROOT(&lde_nbrs)) != NULL)
 		lde_nbr_del(ln);
+	while ((ln = LIST_FIRST(&lde_nbrs_stale)) != NULL)
+		lde_nbr_gr_flush(ln);
 }
 
-////////////////////////////////////////////////////////////////
+/*
+ * RFC 3478 helper: the session to a neighbor that preserves its forwarding
+ * state across a restart went down. Keep the prefix bindings learned from
+ * it, and the FIB entries using them, until it reconnects and re-advertises
+ * them or the reconnect time runs out. Pseudowires and mLDP are torn down
+ * as usual.
+ */
+static void
+lde_nbr_gr_down(struct lde_nbr *ln)
+{
+	struct fec		*f, *safe;
+	struct fec_node		*fn;
+	struct fec_nh		*fnh;
+	struct l2vpn_pw		*pw;
+	struct lde_addr		*lde_addr;
 
-/////////////////////////////////////////////////////////////////////////////
+	/* a second restart before the first one recovered */
+	if (ln->gr_stale)
+		lde_nbr_gr_flush(ln->gr_stale);
 
-/*struct Information
-init_info(void){
-	struct Information in;
-	in.leaf=0;
-	in.root=1;
-	in.ov=0x20;
-	in.root_addr.s_addr=inet_addr("8.8.8.8");
-	printf("leaf:%d  root:%d  ov:%d  addr:%s\n",in.leaf,in.root,in.ov,inet_ntoa(in.root_addr));
-	return (in);
-}*/
-static __inline int
-label_nbr_compare(struct label_nbr *a, struct label_nbr *b)
-{
-	if (a->fec.type < b->fec.type)
-		return (-1);
-	if (a->fec.type > b->fec.type)
-		return (1);
-	switch (a->fec.type) {
-	case FEC_TYPE_IPV4:
-		if (ntohl(a->fec.u.ipv4.prefix.s_addr) <
-		    ntohl(b->fec.u.ipv4.prefix.s_addr))
-			return (-1);
-		if (ntohl(a->fec.u.ipv4.prefix.s_addr) >
-		    ntohl(b->fec.u.ipv4.prefix.s_addr))
-			return (1);
-		if (a->fec.u.ipv4.prefixlen < b->fec.u.ipv4.prefixlen)
-			return (-1);
-		if (a->fec.u.ipv4.prefixlen > b->fec.u.ipv4.prefixlen)
-			return (1);
-		if(a->peerid > b->peerid)
-			return(1);
-		if(a->peerid < b->peerid)
-			return(-1);
-		return (0);
-		
-	case FEC_TYPE_IPV6:
-		if (memcmp(&a->fec.u.ipv6.prefix, &b->fec.u.ipv6.prefix,
-		    sizeof(struct in6_addr)) < 0)
-			return (-1);
-		if (memcmp(&a->fec.u.ipv6.prefix, &b->fec.u.ipv6.prefix,
-		    sizeof(struct in6_addr)) > 0)
-			return (1);
-		if (a->fec.u.ipv6.prefixlen < b->fec.u.ipv6.prefixlen)
-			return (-1);
-		if (a->fec.u.ipv6.prefixlen > b->fec.u.ipv6.prefixlen)
-			return (1);
-		if(a->peerid > b->peerid)
-			return(1);
-		if(a->peerid < b->peerid)
-			return(-1);
-		return (0);
-	case FEC_TYPE_PWID:
-		if (a->fec.u.pwid.type < b->fec.u.pwid.type)
-			return (-1);
-		if (a->fec.u.pwid.type > b->fec.u.pwid.type)
-			return (1);
-		if (a->fec.u.pwid.pwid < b->fec.u.pwid.pwid)
-			return (-1);
-		if (a->fec.u.pwid.pwid > b->fec.u.pwid.pwid)
-			return (1);
-		if (ntohl(a->fec.u.pwid.lsr_id.s_addr) <
-		    ntohl(b->fec.u.pwid.lsr_id.s_addr))
-			return (-1);
-		if (ntohl(a->fec.u.pwid.lsr_id.s_addr) >
-		    ntohl(b->fec.u.pwid.lsr_id.s_addr))
-			return (1);
-		return (0);
+	RB_FOREACH(f, fec_tree, &ft) {
+		if (f->type != FEC_TYPE_PWID ||
+		    f->u.pwid.lsr_id.s_addr != ln->id.s_addr)
+			continue;
+		fn = (struct fec_node *)f;
+
+		LIST_FOREACH(fnh, &fn->nexthops, entry) {
+			pw = (struct l2vpn_pw *) fn->data;
+			if (pw)
+				l2vpn_pw_reset(pw);
+			lde_send_delete_klabel(fn, fnh);
+			fnh->remote_label = NO_LABEL;
+		}
 	}
+	RB_FOREACH_SAFE(f, fec_tree, &ln->recv_map, safe)
+		if (f->type != FEC_TYPE_IPV4 && f->type != FEC_TYPE_IPV6)
+			lde_map_del(ln, (struct lde_map *)f, 0);
+
+	if (adv_nbr_registered)
+		lde_adv_filter_register(IMSG_ADV_FILTER_DEL, ADV_FILTER_NBR,
+		    ln->id);
+	fec_snap_cancel(ln);
+	mldp_nbr_del(ln);
 
-	return (-1);
+	fec_clear(&ln->sent_map, lde_map_free);
+	fec_clear(&ln->recv_req, free);
+	fec_clear(&ln->sent_req, free);
+	fec_clear(&ln->sent_wdraw, lde_wdraw_free);
+
+	/* the next session registers its addresses again */
+	TAILQ_FOREACH(lde_addr, &ln->addr_list, entry)
+		RB_REMOVE(lde_addr_tree, &lde_addrs, lde_addr);
+
+	RB_REMOVE(nbr_tree, &lde_nbrs, ln);
+	RB_REMOVE(lde_nbr_id_tree, &lde_nbrs_id, ln);
+	LIST_INSERT_HEAD(&lde_nbrs_stale, ln, gr_entry);
+
+	log_info("graceful restart: keeping %s bindings for %u seconds",
+	    inet_ntoa(ln->id), MIN(ln->gr_reconnect, MAX_GR_NBR_LIVENESS));
+	ln->gr_timer = thread_add_timer(master, lde_nbr_gr_timer, ln,
+	    MIN(ln->gr_reconnect, MAX_GR_NBR_LIVENESS));
 }
 
-void
-label_nbr_add(uint32_t label,uint32_t local_label,uint32_t peerid,struct fec *fec,enum stream_type type)
+/*
+ * A session came up: if we kept the bindings of its previous one, give the
+ * neighbor its recovery time to re-advertise them. A zero recovery time
+ * means it did not preserve its forwarding state.
+ */
+static void
+lde_nbr_gr_up(struct lde_nbr *ln)
 {
-	struct label_nbr	*lbn;
+	struct lde_nbr		*stale;
 
-	lbn = calloc(1, sizeof(*lbn));
-	if (lbn == NULL)
-		fatal(__func__);
+	LIST_FOREACH(stale, &lde_nbrs_stale, gr_entry)
+		if (stale->id.s_addr == ln->id.s_addr)
+			break;
+	if (stale == NULL)
+		return;
 
-	lbn->fec = *fec;
-	lbn->label = label;
-	lbn->local_label = local_label;
-	lbn->peerid = peerid;
-	lbn->type = type;
+	THREAD_TIMER_OFF(stale->gr_timer);
+	if (ln->gr_recovery == 0) {
+		lde_nbr_gr_flush(stale);
+		return;
+	}
 
-	if (RB_INSERT(label_nbr_tree, &label_nbrs, lbn) != NULL)
-			fatalx("lde_nbr_new: RB_INSERT failed");
-	
+	ln->gr_stale = stale;
+	stale->gr_timer = thread_add_timer(master, lde_nbr_gr_timer, stale,
+	    MIN(ln->gr_recovery, MAX_GR_RECOVERY));
 }
 
-static struct label_nbr *
-label_nbr_find(uint32_t label,uint32_t peerid,struct fec *f){
-	struct label_nbr ln;
-	ln.local_label = label;
-	ln.peerid = peerid;
-	ln.fec = *f;
-	return(RB_FIND(label_nbr_tree, &label_nbrs, &ln));
+static int
+lde_nbr_gr_timer(struct thread *thread)
+{
+	struct lde_nbr		*stale = THREAD_ARG(thread);
+
+	stale->gr_timer = NULL;
+	log_info("graceful restart: %s bindings expired",
+	    inet_ntoa(stale->id));
+	lde_nbr_gr_flush(stale);
+
+	return (0);
 }
 
-static void label_nbr_del(struct label_nbr  *ln)
+/* the stale lde_nbr no longer indexes its addresses, search them here */
+static int
+lde_nbr_gr_nexthop(struct lde_nbr *stale, struct fec_nh *fnh)
 {
-	if(ln==NULL)
-		return;
-	RB_REMOVE(label_nbr_tree, &label_nbrs, ln);
-	free(ln);
+	struct lde_addr		*lde_addr;
+
+	TAILQ_FOREACH(lde_addr, &stale->addr_list, entry)
+		if (lde_addr->af == fnh->af &&
+		    ldp_addrcmp(fnh->af, &lde_addr->addr, &fnh->nexthop) == 0)
+			return (1);
 
+	return (0);
 }
 
+/* uninstall whatever was not re-advertised and forget the old session */
 static void
-label_nbr_clear(void)
+lde_nbr_gr_flush(struct lde_nbr *stale)
 {
-	struct label_nbr	*ln;
+	struct fec		*f;
+	struct fec_node		*fn;
+	struct fec_nh		*fnh;
+	struct lde_map		*me;
+	struct lde_addr		*lde_addr;
+	struct lde_nbr		*ln;
 
-	 while ((ln = RB_ROOT(&label_nbrs)) != NULL)
-		label_nbr_del(ln);
-}
+	while ((f = RB_ROOT(&stale->recv_map)) != NULL) {
+		me = (struct lde_map *)f;
+		fn = me->fn;
 
-static void
-tree_up(struct in_addr root,uint8_t ov)
-{
-	//struct Information info2;
-	struct fec *fec3,*fec4;
-	struct lde_nbr *ln2;
-	struct fec_node *fn1,*fn2;
-	struct label_nbr *lnr1;
-	struct fec_nh *fnh1;
-	//info2=init_info();
-	
-	//if(info2.leaf==1){
-	leaf = 1;
-		RB_FOREACH(fec3, fec_tree, &ft){
-			 
-			if(fec3->u.ipv4.prefix.s_addr==root.s_addr){//root路由信息已记录
-				
-				fn2 = (struct fec_node*)fec_find(&ft, fec3);
-				
-				LIST_FOREACH(fnh1, &fn2->nexthops, entry) { 
-					printf("next:%s\n",inet_ntoa(fnh1->nexthop.v4));
-				   ln2=lde_nbr_find_by_addr(fnh1->af,&fnh1->nexthop);
-				
-				}
-					fec4 = calloc(1, sizeof(*fec4));
-					if (fec4 == NULL)
-						fatal(__func__);
-					fec4->type=fec3->type;
-					fec4->u.ipv4.prefix=root;
-					fec4->u.ipv4.prefixlen=ov;
-					//if(!fec_find(&(ln2->sent_map), fec4)){//未向上游发过labelmapping
-					
-						fn1 = calloc(1, sizeof(*fn1));
-						if (fn1 == NULL)
-							fatal(__func__);
-						fn1->fec = *fec4;
-						fn1->local_label =lde_assign_label();
-						LIST_INIT(&fn1->upstream);
-						LIST_INIT(&fn1->downstream);
-						LIST_INIT(&fn1->nexthops);
-						label_nbr_add(NO_LABEL, fn1->local_label,ln2->peerid, fec4, STREAM_TYPE_UP);
-						lde_send_labelmapping(ln2, fn1, 1);
-						free(fn1);	
-						
-				
-					//}
-				
-					free(fec4);
-					break;
-				
-			}
+		LIST_FOREACH(fnh, &fn->nexthops, entry) {
+			if (!lde_nbr_gr_nexthop(stale, fnh))
+				continue;
+			lde_send_delete_klabel(fn, fnh);
+			fnh->remote_label = NO_LABEL;
 		}
-	
-	
+		lde_map_del(stale, me, 0);
+	}
 
-}
-static void
-tree_down(struct in_addr root,uint8_t ov)
-{
-	//struct Information info;
-	struct label_nbr *lnr;
-	struct lde_nbr *ln;
-	
-	if(leaf = 1){
-		RB_FOREACH(lnr,label_nbr_tree,&label_nbrs){
-			if(lnr->fec.u.ipv4.prefix.s_addr==root.s_addr&&lnr->fec.u.ipv4.prefixlen==ov&&lnr->type==STREAM_TYPE_UP)				
-				ln=lde_nbr_find(lnr->peerid);
-				lde_send_labelwithdraw(ln,NULL, lnr->label, NULL);
-				lde_send_labelrelease(ln, NULL, lnr->label);
-				label_nbr_del(lnr);
-			
-		}
-	
+	while ((lde_addr = TAILQ_FIRST(&stale->addr_list)) != NULL) {
+		TAILQ_REMOVE(&stale->addr_list, lde_addr, entry);
+		free(lde_addr);
 	}
+
+	THREAD_TIMER_OFF(stale->gr_timer);
+	LIST_REMOVE(stale, gr_entry);
+	ln = lde_nbr_find_by_lsrid(stale->id);
+	if (ln && ln->gr_stale == stale)
+		ln->gr_stale = NULL;
+
+	free(stale);
 }
 
-//////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////
+/* a new session re-advertised or withdrew a binding kept from the old one */
+void
+lde_nbr_gr_refresh(struct lde_nbr *ln, struct fec *fec)
+{
+	struct lde_map		*me;
+
+	if (ln->gr_stale == NULL)
+		return;
 
+	me = (struct lde_map *)fec_find(&ln->gr_stale->recv_map, fec);
+	if (me)
+		lde_map_del(ln->gr_stale, me, 0);
+}
 
 struct lde_map *
 lde_map_add(struct lde_nbr *ln, struct fec_node *fn, int sent)
@@ -1662,6 +1825,7 @@ lde_map_add(struct lde_nbr *ln, struct fec_node *fn, int sent)
 
 	me->fec = fn->fec;
 	me->nexthop = ln;
+	me->fn = fn;
 
 	if (sent) {
 		LIST_INSERT_HEAD(&fn->upstream, me, entry);
@@ -1694,9 +1858,11 @@ static void
 lde_map_free(void *ptr)
 {
 	struct lde_map	*map = ptr;
+	struct fec_node	*fn = map->fn;
 
 	LIST_REMOVE(map, entry);
 	free(map);
+	fec_gc_check(fn);
 }
 
 struct lde_req *
@@ -1743,6 +1909,8 @@ lde_wdraw_add(struct lde_nbr *ln, struct fec_node *fn)
 		fatal(__func__);
 
 	lw->fec = fn->fec;
+	/* may outlive the mLDP LSP it was sent for */
+	mldp_fec_ref(&lw->fec);
 
 	if (fec_insert(&ln->sent_wdraw, &lw->fec))
 		log_warnx("failed to add %s to sent wdraw",
@@ -1755,6 +1923,15 @@ void
 lde_wdraw_del(struct lde_nbr *ln, struct lde_wdraw *lw)
 {
 	fec_remove(&ln->sent_wdraw, &lw->fec);
+	lde_wdraw_free(lw);
+}
+
+static void
+lde_wdraw_free(void *ptr)
+{
+	struct lde_wdraw	*lw = ptr;
+
+	mldp_fec_unref(&lw->fec);
 	free(lw);
 }
 
@@ -1807,6 +1984,24 @@ lde_change_egress_label(int af, int was_implicit)
 	}
 }
 
+static __inline int
+lde_addr_compare(struct lde_addr *a, struct lde_addr *b)
+{
+	int	 ret;
+
+	if (a->af < b->af)
+		return (-1);
+	if (a->af > b->af)
+		return (1);
+	if ((ret = ldp_addrcmp(a->af, &a->addr, &b->addr)) != 0)
+		return (ret);
+	if (a->peerid < b->peerid)
+		return (-1);
+	if (a->peerid > b->peerid)
+		return (1);
+	return (0);
+}
+
 static int
 lde_address_add(struct lde_nbr *ln, struct lde_addr *lde_addr)
 {
@@ -1820,7 +2015,10 @@ lde_address_add(struct lde_nbr *ln, struct lde_addr *lde_addr)
 
 	new->af = lde_addr->af;
 	new->addr = lde_addr->addr;
+	new->peerid = ln->peerid;
+	new->nbr = ln;
 	TAILQ_INSERT_TAIL(&ln->addr_list, new, entry);
+	RB_INSERT(lde_addr_tree, &lde_addrs, new);
 
 	return (0);
 }
@@ -1833,6 +2031,7 @@ lde_address_del(struct lde_nbr *ln, struct lde_addr *lde_addr)
 		return (-1);
 
 	TAILQ_REMOVE(&ln->addr_list, lde_addr, entry);
+	RB_REMOVE(lde_addr_tree, &lde_addrs, lde_addr);
 	free(lde_addr);
 
 	return (0);
@@ -1841,19 +2040,12 @@ lde_address_del(struct lde_nbr *ln, struct lde_addr *lde_addr)
 struct lde_addr *
 lde_address_find(struct lde_nbr *ln, int af, union ldpd_addr *addr)
 {
-	struct lde_addr		*lde_addr;
-	printf("addrs list in\n");
-	TAILQ_FOREACH(lde_addr, &ln->addr_list, entry){
-		printf("real in\n");
-		printf("ln addr:%s =?  addr:%s\n",inet_ntoa(lde_addr->addr.v4),inet_ntoa(addr->v4));
-		if (lde_addr->af == af &&
-		    ldp_addrcmp(af, &lde_addr->addr, addr) == 0)
-			{
-			//printf("return ")
-			return (lde_addr);
-		    	}
-			}
-	return (NULL);
+	struct lde_addr		 key;
+
+	key.af = af;
+	key.addr = *addr;
+	key.peerid = ln->peerid;
+	return (RB_FIND(lde_addr_tree, &lde_addrs, &key));
 }
 
 static void
@@ -1863,6 +2055,135 @@ lde_address_list_free(struct lde_nbr *ln)
 
 	while ((lde_addr = TAILQ_FIRST(&ln->addr_list)) != NULL) {
 		TAILQ_REMOVE(&ln->addr_list, lde_addr, entry);
+		RB_REMOVE(lde_addr_tree, &lde_addrs, lde_addr);
 		free(lde_addr);
 	}
 }
+
+
+/* label advertisement filters */
+
+void
+lde_adv_filter_register(int type, int ftype, struct in_addr addr)
+{
+	struct adv_filter_addr	 fa;
+
+	memset(&fa, 0, sizeof(fa));
+	fa.type = ftype;
+	fa.addr = addr;
+	lde_imsg_compose_parent(type, 0, &fa, sizeof(fa));
+}
+
+/* the "for" or "to" prefix-list was set or removed */
+void
+lde_adv_filter_config(void)
+{
+	struct lde_nbr		*ln;
+	int			 registered;
+
+	registered = (ldeconf->adv_to_plist[0] != '\0');
+	if (registered != adv_nbr_registered) {
+		adv_nbr_registered = registered;
+		RB_FOREACH(ln, nbr_tree, &lde_nbrs) {
+			lde_adv_filter_register(registered ?
+			    IMSG_ADV_FILTER_ADD : IMSG_ADV_FILTER_DEL,
+			    ADV_FILTER_NBR, ln->id);
+			/* keep advertising until the parent says otherwise */
+			if (!registered && !ln->adv_permit) {
+				ln->adv_permit = 1;
+				lde_adv_nbr_update(ln);
+			}
+		}
+	}
+
+	mldp_adv_filter_config(ldeconf->adv_for_plist[0] != '\0');
+}
+
+static void
+lde_adv_filter_result(struct adv_filter_addr *fa)
+{
+	struct lde_nbr		*ln;
+
+	switch (fa->type) {
+	case ADV_FILTER_ROOT:
+		mldp_adv_filter_result(fa->addr, fa->permit);
+		break;
+	case ADV_FILTER_NBR:
+		if (!adv_nbr_registered)
+			break;
+		ln = lde_nbr_find_by_lsrid(fa->addr);
+		if (ln == NULL || ln->adv_permit == fa->permit)
+			break;
+		ln->adv_permit = fa->permit;
+		lde_adv_nbr_update(ln);
+		break;
+	default:
+		log_warnx("%s: unknown filter type %d", __func__, fa->type);
+		break;
+	}
+}
+
+int
+lde_adv_permitted(struct lde_nbr *ln, struct fec_node *fn)
+{
+	if (!ln->adv_permit)
+		return (0);
+
+	switch (fn->fec.type) {
+	case FEC_TYPE_IPV4:
+	case FEC_TYPE_IPV6:
+		return (!(fn->flags & F_FEC_NO_ADVERTISE));
+	case FEC_TYPE_MLDP:
+		return (mldp_adv_permitted(fn));
+	default:
+		/* pseudowires are signaled to a configured peer only */
+		return (1);
+	}
+}
+
+/* send or withdraw the mapping of a FEC as the filters now say */
+static void
+lde_adv_reconcile(struct lde_nbr *ln, struct fec_node *fn, int single)
+{
+	struct lde_map		*me;
+	struct lde_wdraw	*lw;
+
+	me = (struct lde_map *)fec_find(&ln->sent_map, &fn->fec);
+	lw = (struct lde_wdraw *)fec_find(&ln->sent_wdraw, &fn->fec);
+	if (lde_adv_permitted(ln, fn)) {
+		if (me == NULL || lw)
+			lde_send_labelmapping(ln, fn, single);
+	} else if (me && lw == NULL)
+		lde_send_labelwithdraw(ln, fn, NO_LABEL, NULL);
+}
+
+/* a prefix FEC changed sides of the "for" list */
+static void
+lde_adv_fec_update(struct fec_node *fn)
+{
+	struct lde_nbr		*ln;
+
+	if (fn->local_label == NO_LABEL)
+		return;
+
+	RB_FOREACH(ln, nbr_tree, &lde_nbrs)
+		lde_adv_reconcile(ln, fn, 1);
+}
+
+/* a neighbor changed sides of the "to" list */
+static void
+lde_adv_nbr_update(struct lde_nbr *ln)
+{
+	struct fec		*f;
+	struct fec_node		*fn;
+
+	RB_FOREACH(f, fec_tree, &ft) {
+		fn = (struct fec_node *)f;
+		if (fn->local_label == NO_LABEL || f->type == FEC_TYPE_PWID)
+			continue;
+		lde_adv_reconcile(ln, fn, 0);
+	}
+	lde_imsg_compose_ldpe(IMSG_MAPPING_ADD_END, ln->peerid, 0, NULL, 0);
+
+	mldp_adv_nbr_update(ln);
+}
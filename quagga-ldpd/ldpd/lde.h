@@ -27,7 +27,8 @@
 enum fec_type {
 	FEC_TYPE_IPV4,
 	FEC_TYPE_IPV6,
-	FEC_TYPE_PWID
+	FEC_TYPE_PWID,
+	FEC_TYPE_MLDP
 };
 
 enum stream_type{
@@ -40,10 +41,9 @@ struct fec {
 	enum fec_type		type;
 	union {
 		struct {
-			uint8_t		prefixlen;//OV
-			struct in_addr	prefix;//ROOT
-			
-		} ipv4;//mp2mp
+			struct in_addr	prefix;
+			uint8_t		prefixlen;
+		} ipv4;
 		struct {
 			struct in6_addr	prefix;
 			uint8_t		prefixlen;
@@ -53,6 +53,11 @@ struct fec {
 			uint32_t	pwid;
 			struct in_addr	lsr_id;
 		} pwid;
+		struct {
+			uint8_t		type;		/* enum mldp_type */
+			struct in_addr	root;
+			uint32_t	opaque;		/* mldp_opaque_get() */
+		} mldp;
 	} u;
 };
 RB_HEAD(fec_tree, fec);
@@ -69,6 +74,7 @@ struct lde_map {
 	struct fec		 fec;
 	LIST_ENTRY(lde_map)	 entry;
 	struct lde_nbr		*nexthop;
+	struct fec_node		*fn;		/* owning LIB entry */
 	struct map		 map;
 };
 
@@ -81,13 +87,19 @@ struct lde_wdraw {
 /* Addresses belonging to neighbor */
 struct lde_addr {
 	TAILQ_ENTRY(lde_addr)	 entry;
+	RB_ENTRY(lde_addr)	 index_entry;	/* lde_addrs */
 	int			 af;
 	union ldpd_addr		 addr;
+	uint32_t		 peerid;
+	struct lde_nbr		*nbr;
 };
+RB_HEAD(lde_addr_tree, lde_addr);
+RB_PROTOTYPE(lde_addr_tree, lde_addr, index_entry, lde_addr_compare)
 
 /* just the info LDE needs */
 struct lde_nbr {
 	RB_ENTRY(lde_nbr)	 entry;
+	RB_ENTRY(lde_nbr)	 id_entry;	/* lde_nbrs_id */
 	uint32_t		 peerid;
 	struct in_addr		 id;
 	int			 v4_enabled;	/* announce/process v4 msgs */
@@ -98,9 +110,21 @@ struct lde_nbr {
 	struct fec_tree		 sent_map;
 	struct fec_tree		 sent_wdraw;
 	TAILQ_HEAD(, lde_addr)	 addr_list;
+	LIST_HEAD(, label_nbr)	 label_nbrs;	/* mLDP branches */
+	LIST_ENTRY(lde_nbr)	 mldp_flush_entry;
+	int			 mldp_flush;	/* mLDP mappings queued */
+	struct fec_snap		*snap;		/* initial advertisement */
+	int			 adv_permit;	/* "to" list result */
+	uint16_t		 gr_reconnect;	/* peer FT timers, 0 if no GR */
+	uint16_t		 gr_recovery;
+	struct thread		*gr_timer;	/* stale bindings lifetime */
+	struct lde_nbr		*gr_stale;	/* previous session's bindings */
+	LIST_ENTRY(lde_nbr)	 gr_entry;	/* lde_nbrs_stale */
 };
 RB_HEAD(nbr_tree, lde_nbr);
 RB_PROTOTYPE(nbr_tree, lde_nbr, entry, lde_nbr_compare)
+RB_HEAD(lde_nbr_id_tree, lde_nbr);
+RB_PROTOTYPE(lde_nbr_id_tree, lde_nbr, id_entry, lde_nbr_id_compare)
 
 struct fec_nh {
 	LIST_ENTRY(fec_nh)	 entry;
@@ -110,17 +134,22 @@ struct fec_nh {
 	uint8_t			 priority;
 };
 
+/* lookup path first: key and label share the leading cache line */
 struct fec_node {
 	struct fec		 fec;
+	uint32_t		 local_label;
+	int			 gc;
+	int			 flags;
+#define F_FEC_NO_ADVERTISE	 0x01		/* denied by the "for" list */
 
 	LIST_HEAD(, fec_nh)	 nexthops;	/* fib nexthops */
 	LIST_HEAD(, lde_map)	 downstream;	/* recv mappings */
 	LIST_HEAD(, lde_map)	 upstream;	/* sent mappings */
-
-	uint32_t		 local_label;
 	void			*data;		/* fec specific data */
+
+	LIST_ENTRY(fec_node)	 gc_entry;	/* on fec_gc_list */
 };
-/////////////////////////////////////////////////////////////////////////
+
 enum mldp_type {
 	MLDP_TYPE_P2MP,
 	MLDP_TYPE_MP2MP,
@@ -131,56 +160,83 @@ enum op_type {
 	OP_TYPE_DEL,
 };
 
-struct mldp_lsp_info
-{
-    uint8_t        op;
-    uint8_t        protocol_type;
-    struct in_addr root_ip;
-    uint8_t        lsp_id;
+/* "mldp lsp" control request, vty to lde */
+struct mldp_lsp_info {
+	uint8_t			 op;
+	uint8_t			 protocol_type;
+	struct in_addr		 root_ip;
+	uint32_t		 lsp_id;
 };
 
-
-/////////////////////////////////////////////////////////////////////////
-struct label_nbr{
-	RB_ENTRY(label_nbr)	entry;
-	uint32_t	label;//remote_label
-	uint32_t	local_label;//
-	uint32_t	peerid;
-	struct fec	fec;//root+ov,唯一标识LSP
-	enum stream_type type;
+/* mLDP branch, one per neighbor and direction we exchanged labels with */
+struct label_nbr {
+	RB_ENTRY(label_nbr)	 entry;
+	LIST_ENTRY(label_nbr)	 nbr_entry;
+	struct mldp_lsp		*lsp;
+	uint32_t		 peerid;
+	enum stream_type	 type;
+	uint32_t		 label;		/* remote label */
+	union ldpd_addr		 nexthop;	/* installed NHLFE */
+	int			 installed;
 };
 RB_HEAD(label_nbr_tree, label_nbr);
+RB_PROTOTYPE(label_nbr_tree, label_nbr, entry, label_nbr_compare)
 
-RB_PROTOTYPE(label_nbr_tree, label_nbr, entry,label_nbr_compare );
+enum mldp_role {
+	MLDP_ROLE_TRANSIT,
+	MLDP_ROLE_LEAF,
+	MLDP_ROLE_ROOT
+};
 
-struct Information{
-	int leaf;
-	int root;
-	struct in_addr root_addr;
-	uint8_t	ov;
+/* mLDP LSP, identified by root and opaque value */
+struct mldp_lsp {
+	RB_ENTRY(mldp_lsp)	 entry;
+	struct fec_node		 fn;		/* fec, local label, sent maps */
+	enum mldp_role		 role;
+	uint8_t			 flags;
+#define F_MLDP_JOINED		 0x01		/* local receiver */
+	struct mldp_root	*root;
+	LIST_ENTRY(mldp_lsp)	 root_entry;
+	struct label_nbr	*upstream;
+	struct label_nbr	*mbb_upstream;	/* old upstream, switching */
+	struct thread		*mbb_timer;
+	struct label_nbr_tree	 downstream;	/* by peerid */
+	time_t			 uptime;
 };
+RB_HEAD(mldp_lsp_tree, mldp_lsp);
+RB_PROTOTYPE(mldp_lsp_tree, mldp_lsp, entry, mldp_lsp_compare)
+
+/* cached resolution of an mLDP root to the upstream LSR */
+struct mldp_root {
+	RB_ENTRY(mldp_root)	 entry;
+	struct in_addr		 addr;
+	int			 local;		/* we are the root */
+	struct lde_nbr		*upstream;
+	LIST_HEAD(, mldp_lsp)	 lsps;
+	int			 adv_permit;	/* "for" list result */
+};
+RB_HEAD(mldp_root_tree, mldp_root);
+RB_PROTOTYPE(mldp_root_tree, mldp_root, entry, mldp_root_compare)
 
-//////////////////////////////////////////////////////////////////////////
 #define LDE_GC_INTERVAL 300
+#define MLDP_MBB_TIMEOUT 5
 
 extern struct ldpd_conf	*ldeconf;
 extern struct fec_tree	 ft;
 extern struct nbr_tree	 lde_nbrs;
-//extern struct Information info;
-//////////////////////////////////////////////////////
-extern struct label_nbr_tree label_nbrs;
-extern int leaf;
-//////////////////////////////////////////////////
+extern struct mldp_lsp_tree mldp_lsps;
 extern struct thread	*gc_timer;
 
 /* lde.c */
-struct Information init_info(void);
-void label_nbr_add(uint32_t,uint32_t ,uint32_t,struct fec *fec,enum stream_type);
 struct lde_nbr *lde_nbr_find(uint32_t);
 pid_t		 lde(const char *, const char *);
 int		 lde_imsg_compose_parent(int, pid_t, void *, uint16_t);
 int		 lde_imsg_compose_ldpe(int, uint32_t, pid_t, void *, uint16_t);
-uint32_t	 lde_assign_label(void);
+void		 lde_label_init(void);
+void		 lde_label_clear(void);
+uint32_t	 lde_assign_label(enum label_app);
+void		 lde_free_label(uint32_t);
+void		 lde_label_ctl(pid_t);
 void		 lde_send_change_klabel(struct fec_node *, struct fec_nh *);
 void		 lde_send_delete_klabel(struct fec_node *, struct fec_nh *);
 void		 lde_fec2map(struct fec *, struct map *);
@@ -194,6 +250,7 @@ void		 lde_send_labelrelease(struct lde_nbr *, struct fec_node *,
 		    uint32_t);
 void		 lde_send_notification(uint32_t, uint32_t, uint32_t, uint16_t);
 struct lde_nbr	*lde_nbr_find_by_lsrid(struct in_addr);
+void		 lde_nbr_gr_refresh(struct lde_nbr *, struct fec *);
 struct lde_nbr	*lde_nbr_find_by_addr(int, union ldpd_addr *);
 struct lde_map	*lde_map_add(struct lde_nbr *, struct fec_node *, int);
 void		 lde_map_del(struct lde_nbr *, struct lde_map *, int);
@@ -213,7 +270,9 @@ int		 fec_remove(struct fec_tree *, struct fec *);
 void		 fec_clear(struct fec_tree *, void (*)(void *));
 void		 rt_dump(pid_t);
 void		 fec_snap(struct lde_nbr *);
+void		 fec_snap_cancel(struct lde_nbr *);
 void		 fec_tree_clear(void);
+struct fec_node	*fec_node_find(struct fec *);
 struct fec_nh	*fec_nh_find(struct fec_node *, int, union ldpd_addr *,
 		    uint8_t);
 uint32_t	 egress_label(enum fec_type);
@@ -227,9 +286,35 @@ void		 lde_check_release(struct map *, struct lde_nbr *);
 void		 lde_check_release_wcard(struct map *, struct lde_nbr *);
 void		 lde_check_withdraw(struct map *, struct lde_nbr *);
 void		 lde_check_withdraw_wcard(struct map *, struct lde_nbr *);
+void		 fec_gc_check(struct fec_node *);
 int		 lde_gc_timer(struct thread *);
 void		 lde_gc_start_timer(void);
 void		 lde_gc_stop_timer(void);
+void		 lde_adv_filter_register(int, int, struct in_addr);
+void		 lde_adv_filter_config(void);
+int		 lde_adv_permitted(struct lde_nbr *, struct fec_node *);
+
+/* mldp.c */
+struct mldp_lsp	*mldp_lsp_find(struct fec *);
+void		 mldp_lsp_clear(void);
+void		 mldp_fec(struct fec *, uint8_t, struct in_addr, uint32_t);
+uint32_t	 mldp_opaque_get(const uint8_t *, uint16_t);
+const uint8_t	*mldp_opaque_data(uint32_t, uint16_t *);
+void		 mldp_fec_ref(struct fec *);
+void		 mldp_fec_unref(struct fec *);
+uint8_t		 mldp_map_type(struct fec_node *, struct lde_nbr *, int);
+void		 mldp_recv_labelmessage(int, struct map *, struct lde_nbr *);
+void		 mldp_nbr_del(struct lde_nbr *);
+void		 mldp_root_update(struct in_addr);
+void		 mldp_root_update_all(void);
+void		 mldp_adv_filter_config(int);
+void		 mldp_adv_filter_result(struct in_addr, int);
+int		 mldp_adv_permitted(struct fec_node *);
+void		 mldp_adv_nbr_update(struct lde_nbr *);
+void		 mldp_tree_up(struct fec *);
+void		 mldp_tree_down(struct fec *);
+void		 mldp_rt_dump(pid_t);
+void		 mldp_ctl(pid_t, struct ctl_mldp_req *);
 
 /* l2vpn.c */
 struct l2vpn	*l2vpn_new(const char *);
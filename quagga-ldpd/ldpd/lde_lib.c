@@ -25,20 +25,53 @@
 
 
 #include "mpls.h"
+#include "jhash.h"
+#include "workqueue.h"
+
+/* initial number of LIB hash slots, doubled when half of them are used */
+#define LIB_HASH_MIN		 2048
+
+/* FECs visited per neighbor on each fec_snap work queue run */
+#define FEC_SNAP_CHUNK		 256
+
+/* initial label advertisement to a new session */
+struct fec_snap {
+	struct lde_nbr		*ln;		/* NULL if the nbr went away */
+	struct fec		 next;		/* where to resume in ft */
+};
 
 static __inline int	 fec_compare(struct fec *, struct fec *);
-static int		 lde_nbr_is_nexthop(struct fec_node *,
-			    struct lde_nbr *);
+static wq_item_status	 fec_snap_run(struct work_queue *, void *);
+static void		 fec_snap_free(struct work_queue *, void *);
 static void		 fec_free(void *);
 static struct fec_node	*fec_add(struct fec *fec);
 static struct fec_nh	*fec_nh_add(struct fec_node *, int, union ldpd_addr *,
 			    uint8_t priority);
 static void		 fec_nh_del(struct fec_nh *);
+static uint32_t		 fec_hash(struct fec *);
+static void		 lib_hash_insert(struct fec_node *);
+static void		 lib_hash_remove(struct fec_node *);
 
 RB_GENERATE(fec_tree, fec, entry, fec_compare)
 
 struct fec_tree		 ft = RB_INITIALIZER(&ft);
 struct thread		*gc_timer;
+static LIST_HEAD(, fec_node) fec_gc_list = LIST_HEAD_INITIALIZER(fec_gc_list);
+static struct work_queue *fec_snap_wq;
+
+/*
+ * Exact-match index over ft. The RB tree is kept for ordered walks (show
+ * commands, snapshots, mLDP root scans); lookups go through the hash.
+ * The table is open addressed with linear probing, and each slot keeps
+ * the full hash value, so a probe only touches the fec_node it returns.
+ */
+struct lib_slot {
+	uint32_t		 hash;
+	struct fec_node		*fn;		/* NULL if the slot is free */
+};
+static struct lib_slot	*lib_hash;
+static uint32_t		 lib_hash_size;
+static uint32_t		 lib_hash_count;
 
 /* FEC tree functions */
 void
@@ -96,6 +129,23 @@ fec_compare(struct fec *a, struct fec *b)
 		    ntohl(b->u.pwid.lsr_id.s_addr))
 			return (1);
 		return (0);
+	case FEC_TYPE_MLDP:
+		if (a->u.mldp.type < b->u.mldp.type)
+			return (-1);
+		if (a->u.mldp.type > b->u.mldp.type)
+			return (1);
+		if (ntohl(a->u.mldp.root.s_addr) <
+		    ntohl(b->u.mldp.root.s_addr))
+			return (-1);
+		if (ntohl(a->u.mldp.root.s_addr) >
+		    ntohl(b->u.mldp.root.s_addr))
+			return (1);
+		/* equal opaque values share an id */
+		if (a->u.mldp.opaque < b->u.mldp.opaque)
+			return (-1);
+		if (a->u.mldp.opaque > b->u.mldp.opaque)
+			return (1);
+		return (0);
 	}
 
 	return (-1);
@@ -137,119 +187,110 @@ fec_clear(struct fec_tree *fh, void (*free_cb)(void *))
 }
 
 /* routing table functions */
-static int
-lde_nbr_is_nexthop(struct fec_node *fn, struct lde_nbr *ln)
+void
+rt_dump(pid_t pid)
 {
-	struct fec_nh		*fnh;
-
-	LIST_FOREACH(fnh, &fn->nexthops, entry)
-		if (lde_address_find(ln, fnh->af, &fnh->nexthop))
-			return (1);
-
-	return (0);
+	mldp_rt_dump(pid);
 }
 
+/*
+ * Advertise the whole LIB to a new session.  This is done from a work
+ * queue in chunks of FEC_SNAP_CHUNK FECs, so a large LIB doesn't block
+ * the event loop and sessions coming up together take turns.
+ */
 void
-rt_dump(pid_t pid)
+fec_snap(struct lde_nbr *ln)
 {
-/*
-	struct fec		*f;
-	struct fec_node		*fn;
-	struct lde_map		*me;
-	static struct ctl_rt	 rtctl;
-
-	RB_FOREACH(f, fec_tree, &ft) {//遍历路由信息
-		fn = (struct fec_node *)f;
-		if (fn->local_label == NO_LABEL &&
-		    LIST_EMPTY(&fn->downstream))//没有交互的lsr
-			continue;
-
-		rtctl.first = 1;
-		switch (fn->fec.type) {
-		case FEC_TYPE_IPV4:
-			rtctl.af = AF_INET;
-			rtctl.prefix.v4 = fn->fec.u.ipv4.prefix;
-			rtctl.prefixlen = fn->fec.u.ipv4.prefixlen;
-			break;
-		case FEC_TYPE_IPV6:
-			rtctl.af = AF_INET6;
-			rtctl.prefix.v6 = fn->fec.u.ipv6.prefix;
-			rtctl.prefixlen = fn->fec.u.ipv6.prefixlen;
-			break;
-		default:
-			continue;
-		}
-
-		rtctl.local_label = fn->local_label;
-		LIST_FOREACH(me, &fn->downstream, entry) {//遍历收到的map
-			rtctl.in_use = lde_nbr_is_nexthop(fn, me->nexthop);
-			rtctl.nexthop = me->nexthop->id;
-			rtctl.remote_label = me->map.label;
-
-			lde_imsg_compose_ldpe(IMSG_CTL_SHOW_LIB, 0, pid,
-			    &rtctl, sizeof(rtctl));
-			rtctl.first = 0;
-		}
-		if (LIST_EMPTY(&fn->downstream)) {
-			rtctl.in_use = 0;
-			rtctl.nexthop.s_addr = INADDR_ANY;
-			rtctl.remote_label = NO_LABEL;
+	struct fec_snap	*snap;
+	struct fec	*f;
 
-			lde_imsg_compose_ldpe(IMSG_CTL_SHOW_LIB, 0, pid,
-			    &rtctl, sizeof(rtctl));
-		}
+	if ((f = RB_MIN(fec_tree, &ft)) == NULL) {
+		lde_imsg_compose_ldpe(IMSG_MAPPING_FULL_END, ln->peerid, 0,
+		    NULL, 0);
+		return;
 	}
 
-*/
+	if (fec_snap_wq == NULL) {
+		fec_snap_wq = work_queue_new(master, "LDP FEC snapshot");
+		if (fec_snap_wq == NULL)
+			fatalx("fec_snap: work_queue_new failed");
+		fec_snap_wq->spec.workfunc = fec_snap_run;
+		fec_snap_wq->spec.del_item_data = fec_snap_free;
+		fec_snap_wq->spec.hold = 0;
+	}
 
-	struct label_nbr *lnb;
-	//struct fec_node 	*fn;
-	struct lde_nbr	*ln;
-	static struct ctl_rt rtctl;
-	RB_FOREACH(lnb, label_nbr_tree, &label_nbrs){
-		rtctl.first = 1;
-		switch (lnb->fec.type){
-			case FEC_TYPE_IPV4:
-			rtctl.af = AF_INET;
-			rtctl.prefix.v4 = lnb->fec.u.ipv4.prefix;
-			rtctl.prefixlen = lnb->fec.u.ipv4.prefixlen;
-			break;
-		case FEC_TYPE_IPV6:
-			rtctl.af = AF_INET6;
-			rtctl.prefix.v6 = lnb->fec.u.ipv6.prefix;
-			rtctl.prefixlen = lnb->fec.u.ipv6.prefixlen;
-			break;
-		default:
-			continue;
-		}
-		rtctl.local_label=lnb->local_label;
-		rtctl.remote_label=lnb->label;
-		ln=lde_nbr_find(lnb->peerid);
-		rtctl.nexthop=ln->id;
-		if(lnb->type==STREAM_TYPE_UP)rtctl.in_use=1;
-		else rtctl.in_use=0;		
-		lde_imsg_compose_ldpe(IMSG_CTL_SHOW_LIB, 0, pid,
-			    &rtctl, sizeof(rtctl));
-		rtctl.first = 0;
+	/* a snapshot in progress starts over */
+	if (ln->snap == NULL) {
+		if ((snap = calloc(1, sizeof(*snap))) == NULL)
+			fatal(__func__);
+		snap->ln = ln;
+		ln->snap = snap;
+		work_queue_add(fec_snap_wq, snap);
 	}
-	
+	ln->snap->next = *f;
 }
 
 void
-fec_snap(struct lde_nbr *ln)
+fec_snap_cancel(struct lde_nbr *ln)
+{
+	if (ln->snap == NULL)
+		return;
+
+	/* the work queue frees it on its next run */
+	ln->snap->ln = NULL;
+	ln->snap = NULL;
+}
+
+static wq_item_status
+fec_snap_run(struct work_queue *wq, void *arg)
 {
+	struct fec_snap	*snap = arg;
+	struct lde_nbr	*ln = snap->ln;
 	struct fec	*f;
 	struct fec_node	*fn;
+	struct lde_map	*me;
+	int		 n = 0, sent = 0;
+
+	if (ln == NULL)
+		return (WQ_SUCCESS);
+
+	for (f = RB_NFIND(fec_tree, &ft, &snap->next); f != NULL;
+	    f = RB_NEXT(fec_tree, &ft, f)) {
+		if (n++ == FEC_SNAP_CHUNK) {
+			snap->next = *f;
+			if (sent)
+				lde_imsg_compose_ldpe(IMSG_MAPPING_ADD_END,
+				    ln->peerid, 0, NULL, 0);
+			return (WQ_REQUEUE);
+		}
 
-	RB_FOREACH(f, fec_tree, &ft) {
 		fn = (struct fec_node *)f;
 		if (fn->local_label == NO_LABEL)
 			continue;
 
+		/* already advertised since the snapshot started */
+		me = (struct lde_map *)fec_find(&ln->sent_map, f);
+		if (me && me->map.label == fn->local_label)
+			continue;
+
 		lde_send_labelmapping(ln, fn, 0);
+		sent = 1;
 	}
 
-	lde_imsg_compose_ldpe(IMSG_MAPPING_ADD_END, ln->peerid, 0, NULL, 0);
+	/* tells ldpe the initial label exchange is complete */
+	lde_imsg_compose_ldpe(IMSG_MAPPING_FULL_END, ln->peerid, 0, NULL, 0);
+
+	return (WQ_SUCCESS);
+}
+
+static void
+fec_snap_free(struct work_queue *wq, void *arg)
+{
+	struct fec_snap	*snap = arg;
+
+	if (snap->ln)
+		snap->ln->snap = NULL;
+	free(snap);
 }
 
 static void
@@ -266,6 +307,8 @@ fec_free(void *arg)
 	if (!LIST_EMPTY(&fn->upstream))
 		log_warnx("%s: fec %s upstream list not empty", __func__,
 		    log_fec(&fn->fec));
+	if (fn->gc)
+		LIST_REMOVE(fn, gc_entry);
 
 	free(fn);
 }
@@ -274,6 +317,108 @@ void
 fec_tree_clear(void)
 {
 	fec_clear(&ft, fec_free);
+
+	free(lib_hash);
+	lib_hash = NULL;
+	lib_hash_size = lib_hash_count = 0;
+}
+
+static uint32_t
+fec_hash(struct fec *f)
+{
+	switch (f->type) {
+	case FEC_TYPE_IPV4:
+		return (jhash_2words(f->u.ipv4.prefix.s_addr,
+		    f->u.ipv4.prefixlen, FEC_TYPE_IPV4));
+	case FEC_TYPE_IPV6:
+		return (jhash(&f->u.ipv6.prefix, sizeof(struct in6_addr),
+		    f->u.ipv6.prefixlen));
+	case FEC_TYPE_PWID:
+		return (jhash_3words(f->u.pwid.type, f->u.pwid.pwid,
+		    f->u.pwid.lsr_id.s_addr, FEC_TYPE_PWID));
+	case FEC_TYPE_MLDP:
+		return (jhash_3words(f->u.mldp.root.s_addr, f->u.mldp.opaque,
+		    f->u.mldp.type, FEC_TYPE_MLDP));
+	}
+
+	return (0);
+}
+
+static void
+lib_hash_insert(struct fec_node *fn)
+{
+	struct lib_slot	*nhash;
+	uint32_t	 nsize, mask, i, j, h;
+
+	if (2 * (lib_hash_count + 1) > lib_hash_size) {
+		nsize = lib_hash_size ? lib_hash_size * 2 : LIB_HASH_MIN;
+		if ((nhash = calloc(nsize, sizeof(*nhash))) == NULL)
+			fatal(__func__);
+		mask = nsize - 1;
+		for (i = 0; i < lib_hash_size; i++) {
+			if (lib_hash[i].fn == NULL)
+				continue;
+			for (j = lib_hash[i].hash & mask; nhash[j].fn;
+			    j = (j + 1) & mask)
+				;
+			nhash[j] = lib_hash[i];
+		}
+		free(lib_hash);
+		lib_hash = nhash;
+		lib_hash_size = nsize;
+	}
+
+	mask = lib_hash_size - 1;
+	h = fec_hash(&fn->fec);
+	for (i = h & mask; lib_hash[i].fn; i = (i + 1) & mask)
+		;
+	lib_hash[i].hash = h;
+	lib_hash[i].fn = fn;
+	lib_hash_count++;
+}
+
+static void
+lib_hash_remove(struct fec_node *fn)
+{
+	uint32_t	 mask, i, j, k;
+
+	if (lib_hash == NULL)
+		return;
+
+	mask = lib_hash_size - 1;
+	for (i = fec_hash(&fn->fec) & mask; lib_hash[i].fn != fn;
+	    i = (i + 1) & mask)
+		if (lib_hash[i].fn == NULL)
+			return;
+
+	/* shift back the entries of the run that probed past the hole */
+	for (j = (i + 1) & mask; lib_hash[j].fn; j = (j + 1) & mask) {
+		k = lib_hash[j].hash & mask;
+		if (((j - k) & mask) >= ((j - i) & mask)) {
+			lib_hash[i] = lib_hash[j];
+			i = j;
+		}
+	}
+	lib_hash[i].fn = NULL;
+	lib_hash_count--;
+}
+
+struct fec_node *
+fec_node_find(struct fec *fec)
+{
+	uint32_t	 mask, i, h;
+
+	if (lib_hash == NULL)
+		return (NULL);
+
+	mask = lib_hash_size - 1;
+	h = fec_hash(fec);
+	for (i = h & mask; lib_hash[i].fn; i = (i + 1) & mask)
+		if (lib_hash[i].hash == h &&
+		    fec_compare(&lib_hash[i].fn->fec, fec) == 0)
+			return (lib_hash[i].fn);
+
+	return (NULL);
 }
 
 static struct fec_node *
@@ -294,6 +439,8 @@ fec_add(struct fec *fec)
 	if (fec_insert(&ft, &fn->fec))
 		log_warnx("failed to add %s to ft tree",
 		    log_fec(&fn->fec));
+	else
+		lib_hash_insert(fn);
 
 	return (fn);
 }
@@ -358,7 +505,6 @@ egress_label(enum fec_type fec_type)
 	return (MPLS_LABEL_IMPLNULL);
 }
 
-//建立fec_node信息
 void
 lde_kernel_insert(struct fec *fec, int af, union ldpd_addr *nexthop,
     uint8_t priority, int connected, void *data)
@@ -367,93 +513,30 @@ lde_kernel_insert(struct fec *fec, int af, union ldpd_addr *nexthop,
 	struct fec_nh		*fnh;
 	struct lde_map		*me;
 	struct lde_nbr		*ln;
-	////////////////////////////////////////////
-	struct fec_node		*fn1;
-	struct fec          *fec1;
-	struct lde_nbr		*ln1;
-	struct Information	info;
-	///////////////////////////////////////////////
-    printf("kernel_insert start\n");
-//	leaf = 0;
-	fn = (struct fec_node *)fec_find(&ft, fec);//查找本地fec_tree（fec_node_tree），fn=NULL说明是新加入的路由信息，新增一个fec_node
+
+	fn = fec_node_find(fec);
 	if (fn == NULL)
-		fn = fec_add(fec);//初始建立fec_node，local_label=NO_LABEL
+		fn = fec_add(fec);
 	if (fec_nh_find(fn, af, nexthop, priority) != NULL)
 		return;
 
-   //fec_node中下一跳信息不匹配
 	if (fn->fec.type == FEC_TYPE_PWID)
 		fn->data = data;
 
-/*	if (fn->local_label == NO_LABEL) {//分配local_label
-		if (connected)
-			fn->local_label = egress_label(fn->fec.type);
-		else
-			fn->local_label = lde_assign_label();
-*/
-		/* FEC.1: perform lsr label distribution procedure */
-		//向邻居通报新增的fec_node信息
-	/*	if(fn->fec.u.ipv4.type){//当其为叶子节点时，向上发送labelmapping
-		RB_FOREACH(ln, nbr_tree, &lde_nbrs) 
-			
-			lde_send_labelmapping(ln, fn, 1);
-			}
-		}*/
-	//nexthop信息加入，remote_label初始为NO_LABEL,通报变化信息
-	fnh = fec_nh_add(fn, af, nexthop, priority);//该fec与谁（nexthop）直连
-	printf("%s\n",inet_ntoa(fec->u.ipv4.prefix));
-	printf("nexthop:%s\n",inet_ntoa(fnh->nexthop.v4));
+	/*
+	 * Only mLDP FECs get a local label (see mldp.c), prefix and pw FECs
+	 * are installed with the remote label alone.
+	 */
+	fnh = fec_nh_add(fn, af, nexthop, priority);
 	lde_send_change_klabel(fn, fnh);
-	
-///////////////////////////////////////////////////////////////////////////////////
-	/*info=init_info();
-	printf("%s\n",inet_ntoa(fec->u.ipv4.prefix));
-	if(info.leaf&&info.root_addr.s_addr==fec->u.ipv4.prefix.s_addr){//root 路由加入，本节点为叶子节点，判断与下一跳的会话是否建立
-		switch (fn->fec.type) {
-			case FEC_TYPE_IPV4:
-			case FEC_TYPE_IPV6:
-				ln1 = lde_nbr_find_by_addr(af, &fnh->nexthop);//寻址
-			case FEC_TYPE_PWID:
-				ln1 = lde_nbr_find_by_lsrid(fn->fec.u.pwid.lsr_id);
-				break;
-			default:
-				ln1 = NULL;
-				break;
-		}	
-		if(ln1!=NULL){//与下一跳会话建立，构造fec_node，发送labelmapping
-			fec1 = calloc(1, sizeof(*fec1));
-			if (fec1 == NULL)
-				fatal(__func__);
-			fec1->type=fn->fec.type;
-			if(fec1->type==FEC_TYPE_IPV4){
-				fec1->u.ipv4.prefix=info.root_addr;
-				fec1->u.ipv4.prefixlen=info.ov;
-			}
-			else{
-				free(fec1);
-				return;
-				} 
-			if(fec_find(&ln1->sent_map, fec1)==NULL){
-				fn1 = calloc(1, sizeof(*fn1));
-				if (fn1 == NULL)
-					fatal(__func__);
-				fn1->fec = *fec1;
-				fn1->local_label =lde_assign_label();
-				LIST_INIT(&fn1->upstream);
-				LIST_INIT(&fn1->downstream);
-				LIST_INIT(&fn1->nexthops);
-				label_nbr_add(NO_LABEL,fn1->local_label, ln1->peerid, fec1, STREAM_TYPE_UP);
-				lde_send_labelmapping(ln1, fn1, 1);	
-				free(fn1);
-			}
-			free(fec1);
-		}
-	}*/
-///////////////////////////////////////////////////////////////////////////////////
+	if (fn->fec.type == FEC_TYPE_IPV4)
+		mldp_root_update(fn->fec.u.ipv4.prefix);
+
 	switch (fn->fec.type) {
 	case FEC_TYPE_IPV4:
 	case FEC_TYPE_IPV6:
-		ln = lde_nbr_find_by_addr(af, &fnh->nexthop);//寻址
+		ln = lde_nbr_find_by_addr(af, &fnh->nexthop);
+		break;
 	case FEC_TYPE_PWID:
 		ln = lde_nbr_find_by_lsrid(fn->fec.u.pwid.lsr_id);
 		break;
@@ -464,9 +547,8 @@ lde_kernel_insert(struct fec *fec, int af, union ldpd_addr *nexthop,
 
 	if (ln) {
 		/* FEC.2  */
-	
 		me = (struct lde_map *)fec_find(&ln->recv_map, &fn->fec);
-		if (me)//收到过，处理信息
+		if (me)
 			/* FEC.5 */
 			lde_check_mapping(&me->map, ln);
 	}
@@ -479,7 +561,7 @@ lde_kernel_remove(struct fec *fec, int af, union ldpd_addr *nexthop,
 	struct fec_node		*fn;
 	struct fec_nh		*fnh;
 
-	fn = (struct fec_node *)fec_find(&ft, fec);
+	fn = fec_node_find(fec);
 	if (fn == NULL)
 		/* route lost */
 		return;
@@ -492,10 +574,14 @@ lde_kernel_remove(struct fec *fec, int af, union ldpd_addr *nexthop,
 	fec_nh_del(fnh);
 	if (LIST_EMPTY(&fn->nexthops)) {
 		lde_send_labelwithdraw_all(fn, NO_LABEL);
+		lde_free_label(fn->local_label);
 		fn->local_label = NO_LABEL;
 		if (fn->fec.type == FEC_TYPE_PWID)
 			fn->data = NULL;
 	}
+	if (fn->fec.type == FEC_TYPE_IPV4)
+		mldp_root_update(fn->fec.u.ipv4.prefix);
+	fec_gc_check(fn);
 }
 
 void
@@ -507,27 +593,27 @@ lde_check_mapping(struct map *map, struct lde_nbr *ln)
 	struct lde_req		*lre;
 	struct lde_map		*me;
 	struct l2vpn_pw		*pw;
-	struct ldpd_global   lg;//读取本机ip
 	int			 msgsource = 0;
 
-	//提取收到的map信息中的fec信息，找到相应的fec_node。如果fec_node不存在则新建一个fec_node
-
 	lde_map2fec(map, ln->id, &fec);
-//	if(!lde_nbr_find_by_addr(fec.type,fec.u.ipv4.prefix))//新添的路由信息不是本机的邻居节点，只为邻居建立fec_node_tree
-	//	return;
-	fn = (struct fec_node *)fec_find(&ft, &fec);
+	fn = fec_node_find(&fec);
 	if (fn == NULL)
 		fn = fec_add(&fec);
 
+	/* graceful restart: the binding kept from the last session is back */
+	lde_nbr_gr_refresh(ln, &fn->fec);
+
 	/* LMp.1: first check if we have a pending request running */
 	lre = (struct lde_req *)fec_find(&ln->sent_req, &fn->fec);
-	if (lre)//lre！=NULL说明发送的请求得到了回应，把相应请求记录删除
+	if (lre)
 		/* LMp.2: delete record of outstanding label request */
 		lde_req_del(ln, lre, 1);
 
 	/* RFC 4447 control word and status tlv negotiation */
-	if (map->type == MAP_TYPE_PWID && l2vpn_pw_negotiate(ln, fn, map))
+	if (map->type == MAP_TYPE_PWID && l2vpn_pw_negotiate(ln, fn, map)) {
+		fec_gc_check(fn);
 		return;
+	}
 
 	/*
 	 * LMp.3 - LMp.8: loop detection - unnecessary for frame-mode
@@ -540,7 +626,7 @@ lde_check_mapping(struct map *map, struct lde_nbr *ln)
 		/* LMp.10 */
 		if (me->map.label != map->label && lre == NULL) {
 			/* LMp.10a */
-			lde_send_labelrelease(ln, fn, me->map.label);//新收到的label与以前的label对比，如果不一样更新label
+			lde_send_labelrelease(ln, fn, me->map.label);
 
 			/*
 			 * Can not use lde_nbr_find_by_addr() because there's
@@ -561,7 +647,6 @@ lde_check_mapping(struct map *map, struct lde_nbr *ln)
 	 * LMp.11 - 12: consider multiple nexthops in order to
 	 * support multipath
 	 */
-	 //分发remote_label
 	LIST_FOREACH(fnh, &fn->nexthops, entry) {
 		/* LMp.15: install FEC in FIB */
 		switch (fec.type) {
@@ -620,7 +705,7 @@ lde_check_request(struct map *map, struct lde_nbr *ln)
 
 	/* LRq.2: is there a next hop for fec? */
 	lde_map2fec(map, ln->id, &fec);
-	fn = (struct fec_node *)fec_find(&ft, &fec);
+	fn = fec_node_find(&fec);
 	if (fn == NULL || LIST_EMPTY(&fn->nexthops)) {
 		/* LRq.5: send No Route notification */
 		lde_send_notification(ln->peerid, S_NO_ROUTE, map->msg_id,
@@ -679,7 +764,7 @@ lde_check_release(struct map *map, struct lde_nbr *ln)
 		return;
 
 	lde_map2fec(map, ln->id, &fec);
-	fn = (struct fec_node *)fec_find(&ft, &fec);
+	fn = fec_node_find(&fec);
 	/* LRl.1: does FEC match a known FEC? */
 	if (fn == NULL)
 		return;
@@ -749,10 +834,12 @@ lde_check_withdraw(struct map *map, struct lde_nbr *ln)
 		return;
 
 	lde_map2fec(map, ln->id, &fec);
-	fn = (struct fec_node *)fec_find(&ft, &fec);
+	fn = fec_node_find(&fec);
 	if (fn == NULL)
 		fn = fec_add(&fec);
 
+	lde_nbr_gr_refresh(ln, &fn->fec);
+
 	/* LWd.1: remove label from forwarding/switching use */
 	LIST_FOREACH(fnh, &fn->nexthops, entry) {
 		switch (fec.type) {
@@ -781,6 +868,9 @@ lde_check_withdraw(struct map *map, struct lde_nbr *ln)
 	if (me && (map->label == NO_LABEL || map->label == me->map.label))
 		/* LWd.4: remove record of previously received lbl mapping */
 		lde_map_del(ln, me, 0);
+	else
+		/* the lookup above may have created an empty entry */
+		fec_gc_check(fn);
 }
 
 void
@@ -790,23 +880,13 @@ lde_check_withdraw_wcard(struct map *map, struct lde_nbr *ln)
 	struct fec_node	*fn;
 	struct fec_nh	*fnh;
 	struct lde_map	*me;
-	struct in_addr local;
-	local.s_addr=inet_addr("0.0.0.0");
 	/* LWd.2: send label release */
-	printf("a\n");
 	lde_send_labelrelease(ln, NULL, map->label);
-	printf("b\n");
 
 	RB_FOREACH(f, fec_tree, &ft) {
 		fn = (struct fec_node *)f;
-		printf("c addr:%s\n ",inet_ntoa(f->u.ipv4.prefix));
-	//	LIST_FOREACH(fnh, &fn->nexthops, entry)
-		//	if(fnh->nexthop.v4==local)
-			//	break;
-		//if(f->u.ipv4.prefix.s_addr==local.s_addr)
-			//continue;
 		/* LWd.1: remove label from forwarding/switching use */
-	/*	LIST_FOREACH(fnh, &fn->nexthops, entry) {
+		LIST_FOREACH(fnh, &fn->nexthops, entry) {
 			switch (f->type) {
 			case FEC_TYPE_IPV4:
 			case FEC_TYPE_IPV6:
@@ -821,9 +901,9 @@ lde_check_withdraw_wcard(struct map *map, struct lde_nbr *ln)
 				break;
 			}
 			lde_send_delete_klabel(fn, fnh);
-			printf("d\n");
 			fnh->remote_label = NO_LABEL;
-		}*/
+		}
+		lde_nbr_gr_refresh(ln, &fn->fec);
 
 		/* LWd.3: check previously received label mapping */
 		me = (struct lde_map *)fec_find(&ln->recv_map, &fn->fec);
@@ -833,28 +913,49 @@ lde_check_withdraw_wcard(struct map *map, struct lde_nbr *ln)
 			 * label mapping
 			 */
 			lde_map_del(ln, me, 0);
-		printf("e\n");
 	}
 }
 
-/* gabage collector timer: timer to remove dead entries from the LIB */
+/*
+ * LIB garbage collection: a node is queued on fec_gc_list when its last
+ * nexthop or mapping goes away, and the gc timer only runs while that list
+ * is non-empty.  mLDP nodes are embedded in their LSP and never live in ft.
+ */
+void
+fec_gc_check(struct fec_node *fn)
+{
+	if (fn->gc || fn->fec.type == FEC_TYPE_MLDP)
+		return;
+	if (!LIST_EMPTY(&fn->nexthops) ||
+	    !LIST_EMPTY(&fn->downstream) ||
+	    !LIST_EMPTY(&fn->upstream))
+		return;
+
+	LIST_INSERT_HEAD(&fec_gc_list, fn, gc_entry);
+	fn->gc = 1;
+	if (gc_timer == NULL)
+		lde_gc_start_timer();
+}
 
 /* ARGSUSED */
 int
 lde_gc_timer(struct thread *thread)
 {
-	struct fec	*fec, *safe;
 	struct fec_node	*fn;
 	int		 count = 0;
 
-	RB_FOREACH_SAFE(fec, fec_tree, &ft, safe) {
-		fn = (struct fec_node *) fec;
+	gc_timer = NULL;
+	while ((fn = LIST_FIRST(&fec_gc_list)) != NULL) {
+		LIST_REMOVE(fn, gc_entry);
+		fn->gc = 0;
 
+		/* revived since it was queued */
 		if (!LIST_EMPTY(&fn->nexthops) ||
 		    !LIST_EMPTY(&fn->downstream) ||
 		    !LIST_EMPTY(&fn->upstream))
 			continue;
 
+		lib_hash_remove(fn);
 		fec_remove(&ft, &fn->fec);
 		free(fn);
 		count++;
@@ -863,8 +964,6 @@ lde_gc_timer(struct thread *thread)
 	if (count > 0)
 		log_debug("%s: %u entries removed", __func__, count);
 
-	lde_gc_start_timer();
-
 	return (0);
 }
 
@@ -51,6 +51,11 @@
 #define	INIT_DELAY_TMR		15
 #define	MAX_DELAY_TMR		120
 
+#define	DEFAULT_GR_RECONNECT	120
+#define	DEFAULT_GR_RECOVERY	120
+#define	MAX_GR_NBR_LIVENESS	120
+#define	MAX_GR_RECOVERY		120
+
 #define	MIN_PWID_ID		1
 #define	MAX_PWID_ID		0xffffffff
 
@@ -90,6 +95,8 @@
 #define TLV_TYPE_COMMONSESSION	0x0500
 #define TLV_TYPE_ATMSESSIONPAR	0x0501
 #define TLV_TYPE_FRSESSION	0x0502
+/* RFC 3478 */
+#define TLV_TYPE_FTSESSION	0x0503
 #define TLV_TYPE_LABELREQUEST	0x0600
 /* RFC 4447 */
 #define TLV_TYPE_PW_STATUS	0x096A
@@ -215,6 +222,19 @@ struct sess_prms_tlv {
 #define SESS_PRMS_SIZE		18
 #define SESS_PRMS_LEN		14
 
+struct ft_sess_tlv {
+	uint16_t	type;
+	uint16_t	length;
+	uint16_t	flags;
+	uint16_t	reserved;
+	uint32_t	reconnect_time;		/* msec */
+	uint32_t	recovery_time;		/* msec */
+} __attribute__ ((packed));
+
+#define FT_SESS_SIZE		16
+#define FT_SESS_LEN		12
+#define F_FT_LEARN		0x0001	/* L: learn labels from the network */
+
 struct status_tlv {
 	uint16_t	type;
 	uint16_t	length;
@@ -240,12 +260,20 @@ struct address_list_tlv {
 #define FEC_ELM_WCARD_LEN	1
 #define FEC_ELM_PREFIX_MIN_LEN	4
 #define FEC_PWID_ELM_MIN_LEN	8
+#define FEC_ELM_MLDP_MIN_LEN	6
 
 #define	MAP_TYPE_WILDCARD	0x01
 #define	MAP_TYPE_PREFIX		0x02
+#define	MAP_TYPE_P2MP		0x06
+#define	MAP_TYPE_MP2MP_UP	0x07
+#define	MAP_TYPE_MP2MP_DOWN	0x08
 #define	MAP_TYPE_PWID		0x80
 #define	MAP_TYPE_GENPWID	0x81
 
+/* RFC 6388 LSP opaque value types */
+#define MLDP_OPAQUE_GENERIC_LSPID	0x01
+#define MLDP_OPAQUE_GENERIC_LSPID_LEN	4
+
 #define CONTROL_WORD_FLAG	0x8000
 #define PW_TYPE_ETHERNET_TAGGED	0x0004
 #define PW_TYPE_ETHERNET	0x0005
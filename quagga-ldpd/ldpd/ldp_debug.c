@@ -99,6 +99,11 @@ ldp_vty_debug(struct vty *vty, struct vty_arg *args[])
 					DEBUG_ON(msg, MSG_SEND_ALL);
 			}
 		}
+	} else 	if (strcmp(type_str, "mldp") == 0) {
+		if (disable)
+			DEBUG_OFF(mldp, MLDP);
+		else
+			DEBUG_ON(mldp, MLDP);
 	} else 	if (strcmp(type_str, "zebra") == 0) {
 		if (disable)
 			DEBUG_OFF(zebra, ZEBRA);
@@ -139,6 +144,8 @@ ldp_vty_show_debugging(struct vty *vty, struct vty_arg *args[])
 	else if (LDP_DEBUG(msg, MSG_SEND))
 		vty_out(vty, "  LDP messages debugging is on (outbound)%s",
 		    VTY_NEWLINE);
+	if (LDP_DEBUG(mldp, MLDP))
+		vty_out(vty, "  LDP mLDP debugging is on%s", VTY_NEWLINE);
 	if (LDP_DEBUG(zebra, ZEBRA))
 		vty_out(vty, "  LDP zebra debugging is on%s", VTY_NEWLINE);
 	vty_out (vty, "%s", VTY_NEWLINE);
@@ -189,6 +196,11 @@ ldp_debug_config_write(struct vty *vty)
 		write = 1;
 	}
 
+	if (CONF_LDP_DEBUG(mldp, MLDP)) {
+		vty_out(vty, "debug mpls ldp mldp%s", VTY_NEWLINE);
+		write = 1;
+	}
+
 	if (CONF_LDP_DEBUG(zebra, ZEBRA)) {
 		vty_out(vty, "debug mpls ldp zebra%s", VTY_NEWLINE);
 		write = 1;
@@ -41,6 +41,9 @@ struct ldp_debug {
 
 	int	 zebra;
 #define LDP_DEBUG_ZEBRA		0x01
+
+	int	 mldp;
+#define LDP_DEBUG_MLDP		0x01
 };
 extern struct ldp_debug	 conf_ldp_debug;
 extern struct ldp_debug	 ldp_debug;
@@ -128,4 +131,10 @@ do {									\
 		log_debug("zebra[out]: " emsg, __VA_ARGS__);		\
 } while (0)
 
+#define		 debug_mldp(emsg, ...)					\
+do {									\
+	if (LDP_DEBUG(mldp, MLDP))					\
+		log_debug("mldp: " emsg, __VA_ARGS__);			\
+} while (0)
+
 #endif /* _LDP_DEBUG_H_ */
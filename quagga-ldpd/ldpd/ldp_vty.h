@@ -52,8 +52,15 @@ int	 ldp_vty_ttl_security(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_router_id(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_ds_cisco_interop(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_trans_pref_ipv4(struct vty *, struct vty_arg *[]);
+int	 ldp_vty_graceful_restart(struct vty *, struct vty_arg *[]);
+int	 ldp_vty_mldp_mbb(struct vty *, struct vty_arg *[]);
+int	 ldp_vty_label_block(struct vty *, struct vty_arg *[]);
+int	 ldp_vty_label_alloc(struct vty *, struct vty_arg *[]);
+int	 ldp_vty_label_adv(struct vty *, struct vty_arg *[]);
+int	 ldp_vty_route_delay(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_neighbor_password(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_neighbor_ttl_security(struct vty *, struct vty_arg *[]);
+int	 ldp_vty_neighbor_alias(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_l2vpn(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_l2vpn_bridge(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_l2vpn_mtu(struct vty *, struct vty_arg *[]);
@@ -69,14 +76,14 @@ int	 ldp_vty_show_binding(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_show_discovery(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_show_interface(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_show_neighbor(struct vty *, struct vty_arg *[]);
+int	 ldp_vty_show_label_space(struct vty *, struct vty_arg *[]);
+int	 ldp_vty_show_mldp_database(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_show_atom_binding(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_show_atom_vc(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_clear_nbr(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_debug(struct vty *, struct vty_arg *[]);
 int	 ldp_vty_show_debugging(struct vty *, struct vty_arg *[]);
-/////////////////////////////////////////////////////////////////////
-int  mldp_vty_lsp(struct vty *vty, struct vty_arg *args[]);
-////////////////////////////////////////////////////////////////////////
+int	 mldp_vty_lsp(struct vty *, struct vty_arg *[]);
 void	 ldp_vty_init(void);
 void	 ldp_vty_if_init(void);
 
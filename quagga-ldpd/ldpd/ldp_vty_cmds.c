@@ -20,7 +20,7 @@ DEFUN (ldp_mpls_ldp,
 
 DEFUN (ldp_mpls_mldp_lsp, 
        ldp_mpls_mldp_lsp_cmd,
-       "mpls mldp (p2mp-lsp|mp2mp-lsp) (add|del) root-ip (A.B.C.D|X:X::X:X) lsp-id <0-255>",  
+       "mpls mldp (p2mp-lsp|mp2mp-lsp) (add|del) root-ip (A.B.C.D|X:X::X:X) lsp-id <0-4294967295>",  
        " add p2mp lsp\n"
        " add mp2mp lsp\n")
 {
@@ -203,6 +203,125 @@ DEFUN (ldp_dual_stack_cisco_interop,
   return ldp_vty_ds_cisco_interop (vty, args);
 }
 
+DEFUN (ldp_graceful_restart,
+       ldp_graceful_restart_cmd,
+       "graceful-restart",
+       "Preserve LDP forwarding state across restarts (RFC 3478)\n")
+{
+  struct vty_arg *args[] = { NULL };
+  return ldp_vty_graceful_restart (vty, args);
+}
+
+DEFUN (ldp_label_local_allocate_for_host_routes,
+       ldp_label_local_allocate_for_host_routes_cmd,
+       "label local allocate for host-routes",
+       "Configure label allocation\n"
+       "Local labels\n"
+       "Restrict the prefixes that get a local label\n"
+       "Prefixes to allocate labels for\n"
+       "Host routes only\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "host-routes", .value = "host-routes" },
+      NULL
+    };
+  return ldp_vty_label_alloc (vty, args);
+}
+
+DEFUN (ldp_label_local_allocate_for_prefix_list_word,
+       ldp_label_local_allocate_for_prefix_list_word_cmd,
+       "label local allocate for prefix-list WORD",
+       "Configure label allocation\n"
+       "Local labels\n"
+       "Restrict the prefixes that get a local label\n"
+       "Prefixes to allocate labels for\n"
+       "Prefixes permitted by a prefix-list\n"
+       "Name of the prefix-list\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "prefix-list", .value = argv[0] },
+      NULL
+    };
+  return ldp_vty_label_alloc (vty, args);
+}
+
+DEFUN (ldp_label_local_advertise_for_prefix_list_word,
+       ldp_label_local_advertise_for_prefix_list_word_cmd,
+       "label local advertise for prefix-list WORD",
+       "Configure label allocation\n"
+       "Local labels\n"
+       "Restrict the label mappings sent to neighbors\n"
+       "FECs to advertise labels for, by prefix or mLDP root\n"
+       "FECs permitted by a prefix-list\n"
+       "Name of the prefix-list\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "for", .value = argv[0] },
+      NULL
+    };
+  return ldp_vty_label_adv (vty, args);
+}
+
+DEFUN (ldp_label_local_advertise_to_prefix_list_word,
+       ldp_label_local_advertise_to_prefix_list_word_cmd,
+       "label local advertise to prefix-list WORD",
+       "Configure label allocation\n"
+       "Local labels\n"
+       "Restrict the label mappings sent to neighbors\n"
+       "Neighbors to advertise labels to, by LSR-ID\n"
+       "Neighbors permitted by a prefix-list\n"
+       "Name of the prefix-list\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "to", .value = argv[0] },
+      NULL
+    };
+  return ldp_vty_label_adv (vty, args);
+}
+
+DEFUN (ldp_label_local_block_mldp,
+       ldp_label_local_block_mldp_cmd,
+       "label local-block mldp",
+       "Configure label allocation\n"
+       "Reserve a local label block for an application\n"
+       "mLDP FECs\n")
+{
+  struct vty_arg *args[] = { NULL };
+  return ldp_vty_label_block (vty, args);
+}
+
+DEFUN (ldp_label_local_block_mldp_label_label,
+       ldp_label_local_block_mldp_label_label_cmd,
+       "label local-block mldp <16-1048575> <16-1048575>",
+       "Configure label allocation\n"
+       "Reserve a local label block for an application\n"
+       "mLDP FECs\n"
+       "First label of the block\n"
+       "Last label of the block\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "min", .value = argv[0] },
+      &(struct vty_arg) { .name = "max", .value = argv[1] },
+      NULL
+    };
+  return ldp_vty_label_block (vty, args);
+}
+
+DEFUN (ldp_mldp_make_before_break,
+       ldp_mldp_make_before_break_cmd,
+       "mldp make-before-break",
+       "Configure mLDP parameters\n"
+       "Signal the new upstream path before releasing the old one\n")
+{
+  struct vty_arg *args[] = { NULL };
+  return ldp_vty_mldp_mbb (vty, args);
+}
+
 DEFUN (ldp_neighbor_ipv4_password_word,
        ldp_neighbor_ipv4_password_word_cmd,
        "neighbor A.B.C.D password WORD",
@@ -272,6 +391,37 @@ DEFUN (ldp_neighbor_ipv4_ttl_security_hops_hops,
   return ldp_vty_neighbor_ttl_security (vty, args);
 }
 
+DEFUN (ldp_neighbor_ipv4_alias_ipv4,
+       ldp_neighbor_ipv4_alias_ipv4_cmd,
+       "neighbor A.B.C.D alias A.B.C.D",
+       "Configure neighbor parameters\n"
+       "LDP Id of neighbor\n"
+       "Address of the neighbor that it does not advertise\n"
+       "Alias address\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "lsr_id", .value = argv[0] },
+      &(struct vty_arg) { .name = "addr", .value = argv[1] },
+      NULL
+    };
+  return ldp_vty_neighbor_alias (vty, args);
+}
+
+DEFUN (ldp_route_delay_route_delay,
+       ldp_route_delay_route_delay_cmd,
+       "route-delay <0-1000>",
+       "Delay before passing route changes from zebra to the label decision engine\n"
+       "Time (milliseconds)\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "delay", .value = argv[0] },
+      NULL
+    };
+  return ldp_vty_route_delay (vty, args);
+}
+
 DEFUN (ldp_router_id_ipv4,
        ldp_router_id_ipv4_cmd,
        "router-id A.B.C.D",
@@ -426,6 +576,150 @@ DEFUN (ldp_no_dual_stack_cisco_interop,
   return ldp_vty_ds_cisco_interop (vty, args);
 }
 
+DEFUN (ldp_no_graceful_restart,
+       ldp_no_graceful_restart_cmd,
+       "no graceful-restart",
+       "Negate a command or set its defaults\n"
+       "Preserve LDP forwarding state across restarts (RFC 3478)\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "no", .value = "no" },
+      NULL
+    };
+  return ldp_vty_graceful_restart (vty, args);
+}
+
+DEFUN (ldp_no_label_local_allocate_for_host_routes,
+       ldp_no_label_local_allocate_for_host_routes_cmd,
+       "no label local allocate for host-routes",
+       "Negate a command or set its defaults\n"
+       "Configure label allocation\n"
+       "Local labels\n"
+       "Restrict the prefixes that get a local label\n"
+       "Prefixes to allocate labels for\n"
+       "Host routes only\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "no", .value = "no" },
+      &(struct vty_arg) { .name = "host-routes", .value = "host-routes" },
+      NULL
+    };
+  return ldp_vty_label_alloc (vty, args);
+}
+
+DEFUN (ldp_no_label_local_allocate_for_prefix_list_word,
+       ldp_no_label_local_allocate_for_prefix_list_word_cmd,
+       "no label local allocate for prefix-list WORD",
+       "Negate a command or set its defaults\n"
+       "Configure label allocation\n"
+       "Local labels\n"
+       "Restrict the prefixes that get a local label\n"
+       "Prefixes to allocate labels for\n"
+       "Prefixes permitted by a prefix-list\n"
+       "Name of the prefix-list\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "no", .value = "no" },
+      &(struct vty_arg) { .name = "prefix-list", .value = argv[0] },
+      NULL
+    };
+  return ldp_vty_label_alloc (vty, args);
+}
+
+DEFUN (ldp_no_label_local_advertise_for_prefix_list_word,
+       ldp_no_label_local_advertise_for_prefix_list_word_cmd,
+       "no label local advertise for prefix-list WORD",
+       "Negate a command or set its defaults\n"
+       "Configure label allocation\n"
+       "Local labels\n"
+       "Restrict the label mappings sent to neighbors\n"
+       "FECs to advertise labels for, by prefix or mLDP root\n"
+       "FECs permitted by a prefix-list\n"
+       "Name of the prefix-list\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "no", .value = "no" },
+      &(struct vty_arg) { .name = "for", .value = argv[0] },
+      NULL
+    };
+  return ldp_vty_label_adv (vty, args);
+}
+
+DEFUN (ldp_no_label_local_advertise_to_prefix_list_word,
+       ldp_no_label_local_advertise_to_prefix_list_word_cmd,
+       "no label local advertise to prefix-list WORD",
+       "Negate a command or set its defaults\n"
+       "Configure label allocation\n"
+       "Local labels\n"
+       "Restrict the label mappings sent to neighbors\n"
+       "Neighbors to advertise labels to, by LSR-ID\n"
+       "Neighbors permitted by a prefix-list\n"
+       "Name of the prefix-list\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "no", .value = "no" },
+      &(struct vty_arg) { .name = "to", .value = argv[0] },
+      NULL
+    };
+  return ldp_vty_label_adv (vty, args);
+}
+
+DEFUN (ldp_no_label_local_block_mldp,
+       ldp_no_label_local_block_mldp_cmd,
+       "no label local-block mldp",
+       "Negate a command or set its defaults\n"
+       "Configure label allocation\n"
+       "Reserve a local label block for an application\n"
+       "mLDP FECs\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "no", .value = "no" },
+      NULL
+    };
+  return ldp_vty_label_block (vty, args);
+}
+
+DEFUN (ldp_no_label_local_block_mldp_label_label,
+       ldp_no_label_local_block_mldp_label_label_cmd,
+       "no label local-block mldp <16-1048575> <16-1048575>",
+       "Negate a command or set its defaults\n"
+       "Configure label allocation\n"
+       "Reserve a local label block for an application\n"
+       "mLDP FECs\n"
+       "First label of the block\n"
+       "Last label of the block\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "no", .value = "no" },
+      &(struct vty_arg) { .name = "min", .value = argv[0] },
+      &(struct vty_arg) { .name = "max", .value = argv[1] },
+      NULL
+    };
+  return ldp_vty_label_block (vty, args);
+}
+
+DEFUN (ldp_no_mldp_make_before_break,
+       ldp_no_mldp_make_before_break_cmd,
+       "no mldp make-before-break",
+       "Negate a command or set its defaults\n"
+       "Configure mLDP parameters\n"
+       "Signal the new upstream path before releasing the old one\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "no", .value = "no" },
+      NULL
+    };
+  return ldp_vty_mldp_mbb (vty, args);
+}
+
 DEFUN (ldp_no_neighbor_ipv4_password_word,
        ldp_no_neighbor_ipv4_password_word_cmd,
        "no neighbor A.B.C.D password WORD",
@@ -503,6 +797,41 @@ DEFUN (ldp_no_neighbor_ipv4_ttl_security_hops_hops,
   return ldp_vty_neighbor_ttl_security (vty, args);
 }
 
+DEFUN (ldp_no_neighbor_ipv4_alias_ipv4,
+       ldp_no_neighbor_ipv4_alias_ipv4_cmd,
+       "no neighbor A.B.C.D alias A.B.C.D",
+       "Negate a command or set its defaults\n"
+       "Configure neighbor parameters\n"
+       "LDP Id of neighbor\n"
+       "Address of the neighbor that it does not advertise\n"
+       "Alias address\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "no", .value = "no" },
+      &(struct vty_arg) { .name = "lsr_id", .value = argv[0] },
+      &(struct vty_arg) { .name = "addr", .value = argv[1] },
+      NULL
+    };
+  return ldp_vty_neighbor_alias (vty, args);
+}
+
+DEFUN (ldp_no_route_delay_route_delay,
+       ldp_no_route_delay_route_delay_cmd,
+       "no route-delay <0-1000>",
+       "Negate a command or set its defaults\n"
+       "Delay before passing route changes from zebra to the label decision engine\n"
+       "Time (milliseconds)\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "no", .value = "no" },
+      &(struct vty_arg) { .name = "delay", .value = argv[0] },
+      NULL
+    };
+  return ldp_vty_route_delay (vty, args);
+}
+
 DEFUN (ldp_no_router_id_ipv4,
        ldp_no_router_id_ipv4_cmd,
        "no router-id A.B.C.D",
@@ -1118,6 +1447,18 @@ DEFUN (ldp_show_mpls_ldp_neighbor,
   return ldp_vty_show_neighbor (vty, args);
 }
 
+DEFUN (ldp_show_mpls_ldp_label_space,
+       ldp_show_mpls_ldp_label_space_cmd,
+       "show mpls ldp label-space",
+       "Show running system information\n"
+       "MPLS information\n"
+       "Label Distribution Protocol\n"
+       "Local label space usage\n")
+{
+  struct vty_arg *args[] = { NULL };
+  return ldp_vty_show_label_space (vty, args);
+}
+
 
 
 DEFUN (ldp_show_mpls_ldp_binding,
@@ -1210,6 +1551,73 @@ DEFUN (ldp_show_mpls_ldp_address_family_interface,
   return ldp_vty_show_interface (vty, args);
 }
 
+DEFUN (ldp_show_mpls_mldp_database,
+       ldp_show_mpls_mldp_database_cmd,
+       "show mpls mldp database",
+       "Show running system information\n"
+       "MPLS information\n"
+       "Multipoint LDP\n"
+       "mLDP LSP database\n")
+{
+  struct vty_arg *args[] = { NULL };
+  return ldp_vty_show_mldp_database (vty, args);
+}
+
+DEFUN (ldp_show_mpls_mldp_database_json,
+       ldp_show_mpls_mldp_database_json_cmd,
+       "show mpls mldp database json",
+       "Show running system information\n"
+       "MPLS information\n"
+       "Multipoint LDP\n"
+       "mLDP LSP database\n"
+       "JavaScript Object Notation\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "json", .value = "json" },
+      NULL
+    };
+  return ldp_vty_show_mldp_database (vty, args);
+}
+
+DEFUN (ldp_show_mpls_mldp_database_root_root_ip,
+       ldp_show_mpls_mldp_database_root_root_ip_cmd,
+       "show mpls mldp database root A.B.C.D",
+       "Show running system information\n"
+       "MPLS information\n"
+       "Multipoint LDP\n"
+       "mLDP LSP database\n"
+       "Filter by root\n"
+       "Root address\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "root-ip", .value = argv[0] },
+      NULL
+    };
+  return ldp_vty_show_mldp_database (vty, args);
+}
+
+DEFUN (ldp_show_mpls_mldp_database_root_root_ip_json,
+       ldp_show_mpls_mldp_database_root_root_ip_json_cmd,
+       "show mpls mldp database root A.B.C.D json",
+       "Show running system information\n"
+       "MPLS information\n"
+       "Multipoint LDP\n"
+       "mLDP LSP database\n"
+       "Filter by root\n"
+       "Root address\n"
+       "JavaScript Object Notation\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "root-ip", .value = argv[0] },
+      &(struct vty_arg) { .name = "json", .value = "json" },
+      NULL
+    };
+  return ldp_vty_show_mldp_database (vty, args);
+}
+
 DEFUN (ldp_show_l2vpn_atom_binding,
        ldp_show_l2vpn_atom_binding_cmd,
        "show l2vpn atom binding",
@@ -1404,6 +1812,22 @@ DEFUN (ldp_debug_mpls_ldp_messages_sent_all,
   return ldp_vty_debug (vty, args);
 }
 
+DEFUN (ldp_debug_mpls_ldp_mldp,
+       ldp_debug_mpls_ldp_mldp_cmd,
+       "debug mpls ldp mldp",
+       "Debugging functions\n"
+       "MPLS information\n"
+       "Label Distribution Protocol\n"
+       "mLDP information\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "type", .value = "mldp" },
+      NULL
+    };
+  return ldp_vty_debug (vty, args);
+}
+
 DEFUN (ldp_debug_mpls_ldp_zebra,
        ldp_debug_mpls_ldp_zebra_cmd,
        "debug mpls ldp zebra",
@@ -1562,6 +1986,24 @@ DEFUN (ldp_no_debug_mpls_ldp_messages_sent_all,
   return ldp_vty_debug (vty, args);
 }
 
+DEFUN (ldp_no_debug_mpls_ldp_mldp,
+       ldp_no_debug_mpls_ldp_mldp_cmd,
+       "no debug mpls ldp mldp",
+       "Negate a command or set its defaults\n"
+       "Debugging functions\n"
+       "MPLS information\n"
+       "Label Distribution Protocol\n"
+       "mLDP information\n")
+{
+  struct vty_arg *args[] =
+    {
+      &(struct vty_arg) { .name = "no", .value = "no" },
+      &(struct vty_arg) { .name = "type", .value = "mldp" },
+      NULL
+    };
+  return ldp_vty_debug (vty, args);
+}
+
 DEFUN (ldp_no_debug_mpls_ldp_zebra,
        ldp_no_debug_mpls_ldp_zebra_cmd,
        "no debug mpls ldp zebra",
@@ -1594,6 +2036,7 @@ ldp_vty_init (void)
   install_element (CONFIG_NODE, &ldp_debug_mpls_ldp_messages_recv_all_cmd);
   install_element (CONFIG_NODE, &ldp_debug_mpls_ldp_messages_sent_cmd);
   install_element (CONFIG_NODE, &ldp_debug_mpls_ldp_messages_sent_all_cmd);
+  install_element (CONFIG_NODE, &ldp_debug_mpls_ldp_mldp_cmd);
   install_element (CONFIG_NODE, &ldp_debug_mpls_ldp_zebra_cmd);
   install_element (CONFIG_NODE, &ldp_no_debug_mpls_ldp_discovery_hello_dir_cmd);
   install_element (CONFIG_NODE, &ldp_no_debug_mpls_ldp_errors_cmd);
@@ -1602,6 +2045,7 @@ ldp_vty_init (void)
   install_element (CONFIG_NODE, &ldp_no_debug_mpls_ldp_messages_recv_all_cmd);
   install_element (CONFIG_NODE, &ldp_no_debug_mpls_ldp_messages_sent_cmd);
   install_element (CONFIG_NODE, &ldp_no_debug_mpls_ldp_messages_sent_all_cmd);
+  install_element (CONFIG_NODE, &ldp_no_debug_mpls_ldp_mldp_cmd);
   install_element (CONFIG_NODE, &ldp_no_debug_mpls_ldp_zebra_cmd);
   install_node (&ldp_node, ldp_config_write);
   install_default (LDP_NODE);
@@ -1613,10 +2057,20 @@ ldp_vty_init (void)
   install_element (LDP_NODE, &ldp_discovery_targeted_hello_interval_disc_time_cmd);
   install_element (LDP_NODE, &ldp_dual_stack_transport_connection_prefer_ipv4_cmd);
   install_element (LDP_NODE, &ldp_dual_stack_cisco_interop_cmd);
+  install_element (LDP_NODE, &ldp_graceful_restart_cmd);
+  install_element (LDP_NODE, &ldp_label_local_allocate_for_host_routes_cmd);
+  install_element (LDP_NODE, &ldp_label_local_allocate_for_prefix_list_word_cmd);
+  install_element (LDP_NODE, &ldp_label_local_advertise_for_prefix_list_word_cmd);
+  install_element (LDP_NODE, &ldp_label_local_advertise_to_prefix_list_word_cmd);
+  install_element (LDP_NODE, &ldp_label_local_block_mldp_cmd);
+  install_element (LDP_NODE, &ldp_label_local_block_mldp_label_label_cmd);
+  install_element (LDP_NODE, &ldp_mldp_make_before_break_cmd);
   install_element (LDP_NODE, &ldp_neighbor_ipv4_password_word_cmd);
   install_element (LDP_NODE, &ldp_neighbor_ipv4_session_holdtime_session_time_cmd);
   install_element (LDP_NODE, &ldp_neighbor_ipv4_ttl_security_disable_cmd);
   install_element (LDP_NODE, &ldp_neighbor_ipv4_ttl_security_hops_hops_cmd);
+  install_element (LDP_NODE, &ldp_neighbor_ipv4_alias_ipv4_cmd);
+  install_element (LDP_NODE, &ldp_route_delay_route_delay_cmd);
   install_element (LDP_NODE, &ldp_router_id_ipv4_cmd);
   install_element (LDP_NODE, &ldp_no_address_family_ipv4_cmd);
   install_element (LDP_NODE, &ldp_no_address_family_ipv6_cmd);
@@ -1626,10 +2080,20 @@ ldp_vty_init (void)
   install_element (LDP_NODE, &ldp_no_discovery_targeted_hello_interval_disc_time_cmd);
   install_element (LDP_NODE, &ldp_no_dual_stack_transport_connection_prefer_ipv4_cmd);
   install_element (LDP_NODE, &ldp_no_dual_stack_cisco_interop_cmd);
+  install_element (LDP_NODE, &ldp_no_graceful_restart_cmd);
+  install_element (LDP_NODE, &ldp_no_label_local_allocate_for_host_routes_cmd);
+  install_element (LDP_NODE, &ldp_no_label_local_allocate_for_prefix_list_word_cmd);
+  install_element (LDP_NODE, &ldp_no_label_local_advertise_for_prefix_list_word_cmd);
+  install_element (LDP_NODE, &ldp_no_label_local_advertise_to_prefix_list_word_cmd);
+  install_element (LDP_NODE, &ldp_no_label_local_block_mldp_cmd);
+  install_element (LDP_NODE, &ldp_no_label_local_block_mldp_label_label_cmd);
+  install_element (LDP_NODE, &ldp_no_mldp_make_before_break_cmd);
   install_element (LDP_NODE, &ldp_no_neighbor_ipv4_password_word_cmd);
   install_element (LDP_NODE, &ldp_no_neighbor_ipv4_session_holdtime_session_time_cmd);
   install_element (LDP_NODE, &ldp_no_neighbor_ipv4_ttl_security_disable_cmd);
   install_element (LDP_NODE, &ldp_no_neighbor_ipv4_ttl_security_hops_hops_cmd);
+  install_element (LDP_NODE, &ldp_no_neighbor_ipv4_alias_ipv4_cmd);
+  install_element (LDP_NODE, &ldp_no_route_delay_route_delay_cmd);
   install_element (LDP_NODE, &ldp_no_router_id_ipv4_cmd);
   install_node (&ldp_ipv4_node, NULL);
   install_default (LDP_IPV4_NODE);
@@ -1717,11 +2181,16 @@ ldp_vty_init (void)
   install_element (LDP_PSEUDOWIRE_NODE, &ldp_no_pw_status_disable_cmd);
   install_node (&ldp_debug_node, ldp_debug_config_write);
   install_element (ENABLE_NODE, &ldp_show_mpls_ldp_neighbor_cmd);
+  install_element (ENABLE_NODE, &ldp_show_mpls_ldp_label_space_cmd);
   install_element (ENABLE_NODE, &ldp_show_mpls_ldp_binding_cmd);
   install_element (ENABLE_NODE, &ldp_mpls_mldp_lsp_cmd);
   install_element (ENABLE_NODE, &ldp_show_mpls_ldp_discovery_cmd);
   install_element (ENABLE_NODE, &ldp_show_mpls_ldp_interface_cmd);
   install_element (ENABLE_NODE, &ldp_show_mpls_ldp_address_family_binding_cmd);
+  install_element (ENABLE_NODE, &ldp_show_mpls_mldp_database_cmd);
+  install_element (ENABLE_NODE, &ldp_show_mpls_mldp_database_json_cmd);
+  install_element (ENABLE_NODE, &ldp_show_mpls_mldp_database_root_root_ip_cmd);
+  install_element (ENABLE_NODE, &ldp_show_mpls_mldp_database_root_root_ip_json_cmd);
   install_element (ENABLE_NODE, &ldp_show_mpls_ldp_address_family_discovery_cmd);
   install_element (ENABLE_NODE, &ldp_show_mpls_ldp_address_family_interface_cmd);
   install_element (ENABLE_NODE, &ldp_show_l2vpn_atom_binding_cmd);
@@ -1736,6 +2205,7 @@ ldp_vty_init (void)
   install_element (ENABLE_NODE, &ldp_debug_mpls_ldp_messages_recv_all_cmd);
   install_element (ENABLE_NODE, &ldp_debug_mpls_ldp_messages_sent_cmd);
   install_element (ENABLE_NODE, &ldp_debug_mpls_ldp_messages_sent_all_cmd);
+  install_element (ENABLE_NODE, &ldp_debug_mpls_ldp_mldp_cmd);
   install_element (ENABLE_NODE, &ldp_debug_mpls_ldp_zebra_cmd);
   install_element (ENABLE_NODE, &ldp_no_debug_mpls_ldp_discovery_hello_dir_cmd);
   install_element (ENABLE_NODE, &ldp_no_debug_mpls_ldp_errors_cmd);
@@ -1744,13 +2214,19 @@ ldp_vty_init (void)
   install_element (ENABLE_NODE, &ldp_no_debug_mpls_ldp_messages_recv_all_cmd);
   install_element (ENABLE_NODE, &ldp_no_debug_mpls_ldp_messages_sent_cmd);
   install_element (ENABLE_NODE, &ldp_no_debug_mpls_ldp_messages_sent_all_cmd);
+  install_element (ENABLE_NODE, &ldp_no_debug_mpls_ldp_mldp_cmd);
   install_element (ENABLE_NODE, &ldp_no_debug_mpls_ldp_zebra_cmd);
   install_element (VIEW_NODE, &ldp_show_mpls_ldp_neighbor_cmd);
+  install_element (VIEW_NODE, &ldp_show_mpls_ldp_label_space_cmd);
   install_element (VIEW_NODE, &ldp_show_mpls_ldp_binding_cmd);
   install_element (VIEW_NODE, &ldp_mpls_mldp_lsp_cmd);
   install_element (VIEW_NODE, &ldp_show_mpls_ldp_discovery_cmd);
   install_element (VIEW_NODE, &ldp_show_mpls_ldp_interface_cmd);
   install_element (VIEW_NODE, &ldp_show_mpls_ldp_address_family_binding_cmd);
+  install_element (VIEW_NODE, &ldp_show_mpls_mldp_database_cmd);
+  install_element (VIEW_NODE, &ldp_show_mpls_mldp_database_json_cmd);
+  install_element (VIEW_NODE, &ldp_show_mpls_mldp_database_root_root_ip_cmd);
+  install_element (VIEW_NODE, &ldp_show_mpls_mldp_database_root_root_ip_json_cmd);
   install_element (VIEW_NODE, &ldp_show_mpls_ldp_address_family_discovery_cmd);
   install_element (VIEW_NODE, &ldp_show_mpls_ldp_address_family_interface_cmd);
   install_element (VIEW_NODE, &ldp_show_l2vpn_atom_binding_cmd);
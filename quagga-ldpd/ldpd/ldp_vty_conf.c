@@ -29,6 +29,7 @@
 #include "command.h"
 #include "if.h"
 #include "vty.h"
+#include "mpls.h"
 #include "ldp_vty.h"
 
 static int	 interface_config_write(struct vty *);
@@ -233,6 +234,9 @@ int
 ldp_config_write(struct vty *vty)
 {
 	struct nbr_params	*nbrp;
+	struct lsrid_alias	*alias;
+	char			 lsr_id[INET_ADDRSTRLEN];
+	int			 app;
 
 	if (!(ldpd_conf->flags & F_LDPD_ENABLED))
 		return (0);
@@ -268,6 +272,37 @@ ldp_config_write(struct vty *vty)
 	if (ldpd_conf->flags & F_LDPD_DS_CISCO_INTEROP)
 		vty_out(vty, " dual-stack cisco-interop%s", VTY_NEWLINE);
 
+	if (ldpd_conf->flags & F_LDPD_GR)
+		vty_out(vty, " graceful-restart%s", VTY_NEWLINE);
+
+	if (ldpd_conf->route_delay != DEFAULT_ROUTE_DELAY)
+		vty_out(vty, " route-delay %u%s", ldpd_conf->route_delay,
+		    VTY_NEWLINE);
+
+	if (ldpd_conf->flags & F_LDPD_ALLOC_HOST_ROUTES)
+		vty_out(vty, " label local allocate for host-routes%s",
+		    VTY_NEWLINE);
+	else if (ldpd_conf->flags & F_LDPD_ALLOC_PLIST)
+		vty_out(vty, " label local allocate for prefix-list %s%s",
+		    ldpd_conf->alloc_plist, VTY_NEWLINE);
+	if (ldpd_conf->adv_for_plist[0] != '\0')
+		vty_out(vty, " label local advertise for prefix-list %s%s",
+		    ldpd_conf->adv_for_plist, VTY_NEWLINE);
+	if (ldpd_conf->adv_to_plist[0] != '\0')
+		vty_out(vty, " label local advertise to prefix-list %s%s",
+		    ldpd_conf->adv_to_plist, VTY_NEWLINE);
+
+	for (app = 0; app < LABEL_APP_MAX; app++) {
+		if (ldpd_conf->label_blocks[app].min == 0)
+			continue;
+		vty_out(vty, " label local-block %s %u %u%s",
+		    label_app_name(app), ldpd_conf->label_blocks[app].min,
+		    ldpd_conf->label_blocks[app].max, VTY_NEWLINE);
+	}
+
+	if (ldpd_conf->flags & F_LDPD_MLDP_MBB)
+		vty_out(vty, " mldp make-before-break%s", VTY_NEWLINE);
+
 	LIST_FOREACH(nbrp, &ldpd_conf->nbrp_list, entry) {
 		if (nbrp->flags & F_NBRP_KEEPALIVE)
 			vty_out(vty, " neighbor %s session holdtime %u%s",
@@ -291,6 +326,12 @@ ldp_config_write(struct vty *vty)
 			    VTY_NEWLINE);
 	}
 
+	RB_FOREACH(alias, lsrid_alias_head, &ldpd_conf->alias_tree) {
+		strlcpy(lsr_id, inet_ntoa(alias->lsr_id), sizeof(lsr_id));
+		vty_out(vty, " neighbor %s alias %s%s", lsr_id,
+		    inet_ntoa(alias->addr), VTY_NEWLINE);
+	}
+
 	ldp_af_config_write(vty, AF_INET, ldpd_conf, &ldpd_conf->ipv4);
 	ldp_af_config_write(vty, AF_INET6, ldpd_conf, &ldpd_conf->ipv6);
 	vty_out(vty, " !%s", VTY_NEWLINE);
@@ -1093,6 +1134,193 @@ ldp_vty_trans_pref_ipv4(struct vty *vty, struct vty_arg *args[])
 	return (CMD_SUCCESS);
 }
 
+int
+ldp_vty_graceful_restart(struct vty *vty, struct vty_arg *args[])
+{
+	struct ldpd_conf	*vty_conf;
+	int			 disable;
+
+	disable = (vty_get_arg_value(args, "no")) ? 1 : 0;
+
+	vty_conf = ldp_dup_config(ldpd_conf);
+
+	if (disable)
+		vty_conf->flags &= ~F_LDPD_GR;
+	else
+		vty_conf->flags |= F_LDPD_GR;
+
+	ldp_reload(vty_conf);
+
+	return (CMD_SUCCESS);
+}
+
+int
+ldp_vty_route_delay(struct vty *vty, struct vty_arg *args[])
+{
+	struct ldpd_conf	*vty_conf;
+	long int		 delay;
+	char			*ep;
+	const char		*delay_str;
+	int			 disable;
+
+	disable = (vty_get_arg_value(args, "no")) ? 1 : 0;
+	delay_str = vty_get_arg_value(args, "delay");
+
+	delay = strtol(delay_str, &ep, 10);
+	if (*ep != '\0' || delay < 0 || delay > MAX_ROUTE_DELAY) {
+		vty_out(vty, "%% Invalid delay%s", VTY_NEWLINE);
+		return (CMD_WARNING);
+	}
+
+	vty_conf = ldp_dup_config(ldpd_conf);
+	if (disable)
+		vty_conf->route_delay = DEFAULT_ROUTE_DELAY;
+	else
+		vty_conf->route_delay = delay;
+
+	ldp_reload(vty_conf);
+
+	return (CMD_SUCCESS);
+}
+
+int
+ldp_vty_label_alloc(struct vty *vty, struct vty_arg *args[])
+{
+	struct ldpd_conf	*vty_conf;
+	const char		*plist_str;
+	int			 disable;
+
+	disable = (vty_get_arg_value(args, "no")) ? 1 : 0;
+	plist_str = vty_get_arg_value(args, "prefix-list");
+
+	if (plist_str && strlen(plist_str) >= PLIST_NAME_LEN) {
+		vty_out(vty, "%% Prefix-list name too long%s", VTY_NEWLINE);
+		return (CMD_WARNING);
+	}
+
+	vty_conf = ldp_dup_config(ldpd_conf);
+	vty_conf->flags &= ~F_LDPD_ALLOC_MASK;
+	memset(vty_conf->alloc_plist, 0, sizeof(vty_conf->alloc_plist));
+	if (!disable) {
+		if (plist_str) {
+			vty_conf->flags |= F_LDPD_ALLOC_PLIST;
+			strlcpy(vty_conf->alloc_plist, plist_str,
+			    sizeof(vty_conf->alloc_plist));
+		} else
+			vty_conf->flags |= F_LDPD_ALLOC_HOST_ROUTES;
+	}
+
+	ldp_reload(vty_conf);
+
+	return (CMD_SUCCESS);
+}
+
+int
+ldp_vty_label_adv(struct vty *vty, struct vty_arg *args[])
+{
+	struct ldpd_conf	*vty_conf;
+	const char		*for_str, *to_str, *plist_str;
+	char			*plist;
+	int			 disable;
+
+	disable = (vty_get_arg_value(args, "no")) ? 1 : 0;
+	for_str = vty_get_arg_value(args, "for");
+	to_str = vty_get_arg_value(args, "to");
+	plist_str = (for_str) ? for_str : to_str;
+
+	if (plist_str && strlen(plist_str) >= PLIST_NAME_LEN) {
+		vty_out(vty, "%% Prefix-list name too long%s", VTY_NEWLINE);
+		return (CMD_WARNING);
+	}
+
+	vty_conf = ldp_dup_config(ldpd_conf);
+	plist = (for_str) ? vty_conf->adv_for_plist : vty_conf->adv_to_plist;
+	memset(plist, 0, PLIST_NAME_LEN);
+	if (!disable && plist_str)
+		strlcpy(plist, plist_str, PLIST_NAME_LEN);
+
+	ldp_reload(vty_conf);
+
+	return (CMD_SUCCESS);
+}
+
+int
+ldp_vty_label_block(struct vty *vty, struct vty_arg *args[])
+{
+	struct ldpd_conf	*vty_conf;
+	struct label_block	*lb;
+	long int		 min = 0, max = 0;
+	char			*ep;
+	const char		*min_str;
+	const char		*max_str;
+	int			 app, i;
+	int			 disable;
+
+	disable = (vty_get_arg_value(args, "no")) ? 1 : 0;
+	min_str = vty_get_arg_value(args, "min");
+	max_str = vty_get_arg_value(args, "max");
+
+	/* only mLDP allocates local labels, prefix and pw FECs don't */
+	app = LABEL_APP_MLDP;
+
+	if (!disable) {
+		if (min_str == NULL || max_str == NULL) {
+			vty_out(vty, "%% Missing label range%s", VTY_NEWLINE);
+			return (CMD_WARNING);
+		}
+		min = strtol(min_str, &ep, 10);
+		if (*ep != '\0' || min <= MPLS_LABEL_RESERVED_MAX ||
+		    min > MPLS_LABEL_MAX) {
+			vty_out(vty, "%% Invalid label%s", VTY_NEWLINE);
+			return (CMD_WARNING);
+		}
+		max = strtol(max_str, &ep, 10);
+		if (*ep != '\0' || max < min || max > MPLS_LABEL_MAX) {
+			vty_out(vty, "%% Invalid label range%s", VTY_NEWLINE);
+			return (CMD_WARNING);
+		}
+		for (i = 0; i < LABEL_APP_MAX; i++) {
+			lb = &ldpd_conf->label_blocks[i];
+			if (i == app || lb->min == 0)
+				continue;
+			if (min <= lb->max && max >= lb->min) {
+				vty_out(vty, "%% Label range overlaps the %s "
+				    "block%s", label_app_name(i), VTY_NEWLINE);
+				return (CMD_WARNING);
+			}
+		}
+	}
+
+	vty_conf = ldp_dup_config(ldpd_conf);
+	lb = &vty_conf->label_blocks[app];
+	lb->min = min;
+	lb->max = max;
+
+	ldp_reload(vty_conf);
+
+	return (CMD_SUCCESS);
+}
+
+int
+ldp_vty_mldp_mbb(struct vty *vty, struct vty_arg *args[])
+{
+	struct ldpd_conf	*vty_conf;
+	int			 disable;
+
+	disable = (vty_get_arg_value(args, "no")) ? 1 : 0;
+
+	vty_conf = ldp_dup_config(ldpd_conf);
+
+	if (disable)
+		vty_conf->flags &= ~F_LDPD_MLDP_MBB;
+	else
+		vty_conf->flags |= F_LDPD_MLDP_MBB;
+
+	ldp_reload(vty_conf);
+
+	return (CMD_SUCCESS);
+}
+
 int
 ldp_vty_neighbor_password(struct vty *vty, struct vty_arg *args[])
 {
@@ -1214,6 +1442,59 @@ cancel:
 	return (CMD_SUCCESS);
 }
 
+int
+ldp_vty_neighbor_alias(struct vty *vty, struct vty_arg *args[])
+{
+	struct ldpd_conf	*vty_conf;
+	struct in_addr		 lsr_id, addr;
+	struct lsrid_alias	*alias;
+	const char		*lsr_id_str;
+	const char		*addr_str;
+	int			 disable;
+
+	disable = (vty_get_arg_value(args, "no")) ? 1 : 0;
+	lsr_id_str = vty_get_arg_value(args, "lsr_id");
+	addr_str = vty_get_arg_value(args, "addr");
+
+	if (inet_pton(AF_INET, lsr_id_str, &lsr_id) != 1 ||
+	    bad_addr_v4(lsr_id) ||
+	    inet_pton(AF_INET, addr_str, &addr) != 1 ||
+	    bad_addr_v4(addr)) {
+		vty_out(vty, "%% Malformed address%s", VTY_NEWLINE);
+		return (CMD_WARNING);
+	}
+
+	vty_conf = ldp_dup_config(ldpd_conf);
+	alias = lsrid_alias_find(vty_conf, addr);
+
+	if (disable) {
+		if (alias == NULL || alias->lsr_id.s_addr != lsr_id.s_addr)
+			goto cancel;
+
+		RB_REMOVE(lsrid_alias_head, &vty_conf->alias_tree, alias);
+		free(alias);
+	} else {
+		if (alias == NULL) {
+			if ((alias = calloc(1, sizeof(*alias))) == NULL)
+				fatal(__func__);
+			alias->addr = addr;
+			RB_INSERT(lsrid_alias_head, &vty_conf->alias_tree,
+			    alias);
+		} else if (alias->lsr_id.s_addr == lsr_id.s_addr)
+			goto cancel;
+
+		alias->lsr_id = lsr_id;
+	}
+
+	ldp_reload(vty_conf);
+
+	return (CMD_SUCCESS);
+
+cancel:
+	ldp_clear_config(vty_conf);
+	return (CMD_SUCCESS);
+}
+
 int
 ldp_vty_l2vpn(struct vty *vty, struct vty_arg *args[])
 {
@@ -39,7 +39,9 @@ enum show_command {
 	SHOW_LIB,
 	SHOW_L2VPN_PW,
 	SHOW_L2VPN_BINDING,
+	SHOW_LABELS,
 	SHOW_CTL_MLDP_LSP,
+	SHOW_MLDP,
 	
 };
 
@@ -47,6 +49,14 @@ struct show_filter {
 	int		family;
 	union ldpd_addr	addr;
 	uint8_t		prefixlen;
+	/* mldp database */
+	struct in_addr	root;
+	int		json;
+	int		nlsps;		/* LSPs received in this page */
+	int		nbranches;	/* branches left for the last LSP */
+	int		first;
+	int		first_branch;
+	struct ctl_mldp_key last;
 };
 
 
@@ -65,6 +75,15 @@ static int		 show_lib_msg(struct vty *, struct imsg *,
 			    struct show_filter *);
 static int		 show_l2vpn_binding_msg(struct vty *, struct imsg *);
 static int		 show_l2vpn_pw_msg(struct vty *, struct imsg *);
+static int		 show_labels_msg(struct vty *, struct imsg *);
+static const char	*show_mldp_role(int);
+static const char	*show_mldp_branch(uint8_t);
+static void		 show_mldp_lsp(struct vty *, struct ctl_mldp_lsp *,
+			    struct show_filter *);
+static void		 show_mldp_lsp_end(struct vty *, struct show_filter *);
+static int		 show_mldp_msg(struct vty *, struct imsgbuf *,
+			    struct imsg *, struct show_filter *);
+static int		 ldp_vty_flush(struct imsgbuf *);
 static int		 ldp_vty_connect(struct imsgbuf *);
 static int		 ldp_vty_dispatch(struct vty *, struct imsgbuf *,
 			    enum show_command, struct show_filter *);
@@ -239,6 +258,10 @@ show_nbr_msg(struct vty *vty, struct imsg *imsg, struct show_filter *filter)
 		    nbr_state_name(nbr->nbr_state), VTY_NEWLINE);
 		vty_out(vty, "  Up time: %s%s", log_time(nbr->uptime),
 		    VTY_NEWLINE);
+		if (nbr->flags & F_CTL_NBR_GR)
+			vty_out(vty, "  Graceful Restart: reconnect time %u sec, "
+			    "recovery time %u sec%s", nbr->gr_reconnect,
+			    nbr->gr_recovery, VTY_NEWLINE);
 		break;
 	case IMSG_CTL_SHOW_NBR_DISC:
 		adj = imsg->data;
@@ -299,19 +322,19 @@ show_lib_msg(struct vty *vty, struct imsg *imsg, struct show_filter *filter)
 			if (rt->remote_label != NO_LABEL) {
 				//vty_out(vty, "%-8sRemote bindings:%s", "",
 				  //  VTY_NEWLINE);
-				vty_out(vty, "%sNode            R-Label   L-Label   Root            OV        Relation%s",
+				vty_out(vty, "%sNode            R-Label   L-Label   Root            LSP-ID    Relation%s",
 				    VTY_NEWLINE, VTY_NEWLINE);
 				
 				vty_out(vty, "-------------   "
 				    "-------   -------   -------------   -------   ----------%s", VTY_NEWLINE);
 				if(rt->in_use==1)
-					vty_out(vty, "%-20s%s        %s        %s        %d        UP_STREAM", inet_ntoa(rt->nexthop),
+					vty_out(vty, "%-20s%s        %s        %s        %u        UP_STREAM%s", inet_ntoa(rt->nexthop),
 			    		log_label(rt->remote_label), log_label(rt->local_label),log_addr(rt->af, &rt->prefix),
-			    		 rt->prefixlen,VTY_NEWLINE);
+			    		 rt->lsp_id,VTY_NEWLINE);
 				else
-					vty_out(vty, "%-20s%s        %s        %s        %d        DOWN_STREAM",  inet_ntoa(rt->nexthop),
+					vty_out(vty, "%-20s%s        %s        %s        %u        DOWN_STREAM%s",  inet_ntoa(rt->nexthop),
 			    		log_label(rt->remote_label), log_label(rt->local_label),log_addr(rt->af, &rt->prefix),
-			    		 rt->prefixlen,VTY_NEWLINE);
+			    		 rt->lsp_id,VTY_NEWLINE);
 			} else
 				vty_out(vty, "%-8sNo remote bindings%s", "",
 				    VTY_NEWLINE);
@@ -404,6 +427,191 @@ show_l2vpn_pw_msg(struct vty *vty, struct imsg *imsg)
 	return (0);
 }
 
+static int
+show_labels_msg(struct vty *vty, struct imsg *imsg)
+{
+	struct ctl_label_space	*lctl;
+
+	switch (imsg->hdr.type) {
+	case IMSG_CTL_SHOW_LABELS:
+		lctl = imsg->data;
+
+		vty_out(vty, "%-11s %-8u %-8u %-8u %-8u%s",
+		    label_app_name(lctl->app), lctl->min, lctl->max,
+		    lctl->used, lctl->avail, VTY_NEWLINE);
+		break;
+	case IMSG_CTL_END:
+		vty_out(vty, "%s", VTY_NEWLINE);
+		return (1);
+	default:
+		break;
+	}
+
+	return (0);
+}
+
+static const char *
+show_mldp_role(int role)
+{
+	switch (role) {
+	case MLDP_ROLE_ROOT:
+		return ("root");
+	case MLDP_ROLE_LEAF:
+		return ("leaf");
+	case MLDP_ROLE_TRANSIT:
+		return ("transit");
+	default:
+		return ("unknown");
+	}
+}
+
+static const char *
+show_mldp_branch(uint8_t type)
+{
+	switch (type) {
+	case CTL_MLDP_BRANCH_UP:
+		return ("upstream");
+	case CTL_MLDP_BRANCH_MBB:
+		return ("upstream-mbb");
+	case CTL_MLDP_BRANCH_DOWN:
+		return ("downstream");
+	default:
+		return ("unknown");
+	}
+}
+
+static void
+show_mldp_lsp(struct vty *vty, struct ctl_mldp_lsp *lsp,
+    struct show_filter *filter)
+{
+	const char	*type;
+	char		 opaque[32];
+
+	type = (lsp->key.type == MLDP_TYPE_MP2MP) ? "mp2mp" : "p2mp";
+	if (lsp->lsp_id_valid)
+		snprintf(opaque, sizeof(opaque), "lsp-id %u", lsp->lsp_id);
+	else
+		snprintf(opaque, sizeof(opaque), "opaque %u bytes",
+		    lsp->key.opaque_len);
+
+	if (filter->json) {
+		vty_out(vty, "%s{\"root\":\"%s\",\"type\":\"%s\",",
+		    filter->first ? "" : ",", inet_ntoa(lsp->key.root), type);
+		if (lsp->lsp_id_valid)
+			vty_out(vty, "\"lspId\":%u,", lsp->lsp_id);
+		else
+			vty_out(vty, "\"opaqueLength\":%u,",
+			    lsp->key.opaque_len);
+		vty_out(vty, "\"role\":\"%s\",\"joined\":%s,"
+		    "\"localLabel\":%u,\"uptime\":%lld,\"branches\":[",
+		    show_mldp_role(lsp->role), lsp->joined ? "true" : "false",
+		    lsp->local_label, (long long)lsp->uptime);
+	} else {
+		vty_out(vty, "%s %s %s, %s%s%s", type,
+		    inet_ntoa(lsp->key.root), opaque,
+		    show_mldp_role(lsp->role), lsp->joined ? " (joined)" : "",
+		    VTY_NEWLINE);
+		vty_out(vty, "%-2sLocal label: %s, uptime: %s%s", "",
+		    log_label(lsp->local_label), log_time(lsp->uptime),
+		    VTY_NEWLINE);
+	}
+	filter->first = 0;
+}
+
+static void
+show_mldp_lsp_end(struct vty *vty, struct show_filter *filter)
+{
+	if (filter->json)
+		vty_out(vty, "]}");
+}
+
+static int
+show_mldp_msg(struct vty *vty, struct imsgbuf *ibuf, struct imsg *imsg,
+    struct show_filter *filter)
+{
+	struct ctl_mldp_lsp	*lsp;
+	struct ctl_mldp_branch	*br;
+	struct ctl_mldp_req	 req;
+
+	switch (imsg->hdr.type) {
+	case IMSG_CTL_SHOW_MLDP:
+		lsp = imsg->data;
+
+		if (filter->nbranches > 0)
+			show_mldp_lsp_end(vty, filter);
+		show_mldp_lsp(vty, lsp, filter);
+		filter->last = lsp->key;
+		filter->nlsps++;
+		filter->nbranches = lsp->nbranches;
+		filter->first_branch = 1;
+		if (filter->nbranches == 0)
+			show_mldp_lsp_end(vty, filter);
+		break;
+	case IMSG_CTL_SHOW_MLDP_BRANCH:
+		br = imsg->data;
+
+		if (filter->nbranches == 0)
+			break;
+		if (filter->json)
+			vty_out(vty, "%s{\"lsrId\":\"%s\",\"relation\":\"%s\","
+			    "\"label\":%u,\"installed\":%s}",
+			    filter->first_branch ? "" : ",",
+			    inet_ntoa(br->lsr_id), show_mldp_branch(br->type),
+			    br->label, br->installed ? "true" : "false");
+		else
+			vty_out(vty, "%-2s%-14s %-15s label %s%s%s", "",
+			    show_mldp_branch(br->type), inet_ntoa(br->lsr_id),
+			    log_label(br->label),
+			    br->installed ? " (installed)" : "", VTY_NEWLINE);
+		filter->first_branch = 0;
+		if (--filter->nbranches == 0)
+			show_mldp_lsp_end(vty, filter);
+		break;
+	case IMSG_CTL_END:
+		/* fewer branches than announced */
+		if (filter->nbranches > 0) {
+			filter->nbranches = 0;
+			show_mldp_lsp_end(vty, filter);
+		}
+
+		/* full page, ask for the next one */
+		if (filter->nlsps == CTL_MLDP_PAGE) {
+			filter->nlsps = 0;
+			memset(&req, 0, sizeof(req));
+			req.root = filter->root;
+			req.cont = 1;
+			req.last = filter->last;
+			imsg_compose(ibuf, IMSG_CTL_SHOW_MLDP, 0, 0, -1, &req,
+			    sizeof(req));
+			if (ldp_vty_flush(ibuf) < 0)
+				return (1);
+			break;
+		}
+
+		if (filter->json)
+			vty_out(vty, "]}%s", VTY_NEWLINE);
+		else
+			vty_out(vty, "%s", VTY_NEWLINE);
+		return (1);
+	default:
+		break;
+	}
+
+	return (0);
+}
+
+static int
+ldp_vty_flush(struct imsgbuf *ibuf)
+{
+	while (ibuf->w.queued)
+		if (msgbuf_write(&ibuf->w) <= 0 && errno != EAGAIN) {
+			log_warn("write error");
+			return (-1);
+		}
+
+	return (0);
+}
+
 static int
 ldp_vty_connect(struct imsgbuf *ibuf)
 {
@@ -437,12 +645,10 @@ ldp_vty_dispatch(struct vty *vty, struct imsgbuf *ibuf, enum show_command cmd,
 	struct imsg		 imsg;
 	int			 n, done = 0;
 
-	while (ibuf->w.queued)
-		if (msgbuf_write(&ibuf->w) <= 0 && errno != EAGAIN) {
-			log_warn("write error");
-			close(ibuf->fd);
-			return (CMD_WARNING);
-		}
+	if (ldp_vty_flush(ibuf) < 0) {
+		close(ibuf->fd);
+		return (CMD_WARNING);
+	}
 
 	while (!done) {
 		if ((n = imsg_read(ibuf)) == -1 && errno != EAGAIN) {
@@ -483,9 +689,15 @@ ldp_vty_dispatch(struct vty *vty, struct imsgbuf *ibuf, enum show_command cmd,
 			case SHOW_L2VPN_BINDING:
 				done = show_l2vpn_binding_msg(vty, &imsg);
 				break;
+			case SHOW_LABELS:
+				done = show_labels_msg(vty, &imsg);
+				break;
             case SHOW_CTL_MLDP_LSP:
 				done = 1;
 				break;
+			case SHOW_MLDP:
+				done = show_mldp_msg(vty, ibuf, &imsg, filter);
+				break;
 			default:
 				break;
 			}
@@ -538,6 +750,37 @@ ldp_vty_show_binding(struct vty *vty, struct vty_arg *args[])
 	return (ldp_vty_dispatch(vty, &ibuf, SHOW_LIB, &filter));
 }
 
+int
+ldp_vty_show_mldp_database(struct vty *vty, struct vty_arg *args[])
+{
+	struct imsgbuf		 ibuf;
+	struct show_filter	 filter;
+	struct ctl_mldp_req	 req;
+	const char		*root_str;
+
+	memset(&filter, 0, sizeof(filter));
+	root_str = vty_get_arg_value(args, "root-ip");
+	if (root_str && (inet_pton(AF_INET, root_str, &filter.root) != 1 ||
+	    bad_addr_v4(filter.root))) {
+		vty_out(vty, "%% Malformed address%s", VTY_NEWLINE);
+		return (CMD_WARNING);
+	}
+	filter.json = (vty_get_arg_value(args, "json") != NULL);
+	filter.first = 1;
+
+	if (ldp_vty_connect(&ibuf) < 0)
+		return (CMD_WARNING);
+
+	memset(&req, 0, sizeof(req));
+	req.root = filter.root;
+	imsg_compose(&ibuf, IMSG_CTL_SHOW_MLDP, 0, 0, -1, &req, sizeof(req));
+
+	if (filter.json)
+		vty_out(vty, "{\"lsps\":[");
+
+	return (ldp_vty_dispatch(vty, &ibuf, SHOW_MLDP, &filter));
+}
+
 int
 ldp_vty_show_discovery(struct vty *vty, struct vty_arg *args[])
 {
@@ -607,6 +850,30 @@ ldp_vty_show_neighbor(struct vty *vty, struct vty_arg *args[])
 	return (ldp_vty_dispatch(vty, &ibuf, SHOW_NBR, &filter));
 }
 
+int
+ldp_vty_show_label_space(struct vty *vty, struct vty_arg *args[])
+{
+	struct imsgbuf		 ibuf;
+	struct show_filter	 filter;
+
+	if (ldp_vty_connect(&ibuf) < 0)
+		return (CMD_WARNING);
+
+	imsg_compose(&ibuf, IMSG_CTL_SHOW_LABELS, 0, 0, -1, NULL, 0);
+
+	/* not used */
+	memset(&filter, 0, sizeof(filter));
+
+	/* header */
+	vty_out(vty, "%-11s %-8s %-8s %-8s %-8s%s",
+	    "Space", "Min", "Max", "Used", "Free", VTY_NEWLINE);
+	vty_out(vty, "%-11s %-8s %-8s %-8s %-8s%s",
+	    "-----------", "--------", "--------", "--------", "--------",
+	    VTY_NEWLINE);
+
+	return (ldp_vty_dispatch(vty, &ibuf, SHOW_LABELS, &filter));
+}
+
 int
 ldp_vty_show_atom_binding(struct vty *vty, struct vty_arg *args[])
 {
@@ -689,7 +956,7 @@ mldp_vty_lsp(struct vty *vty, struct vty_arg *args[])
     const char              *protocol;
     const char              *op;
 	const char              *addr_str;
-	int			            lsp_id;
+	uint32_t		 lsp_id;
     struct in_addr          root_ip;
     struct imsgbuf		    ibuf;
 	struct mldp_lsp_info	lsp;
@@ -697,7 +964,7 @@ mldp_vty_lsp(struct vty *vty, struct vty_arg *args[])
     protocol = vty_get_arg_value(args, "protocol");
     op       = vty_get_arg_value(args, "op");
 	addr_str = vty_get_arg_value(args, "root-ip");
-	lsp_id   = atoi(vty_get_arg_value(args, "lsp-id"));
+	lsp_id   = strtoul(vty_get_arg_value(args, "lsp-id"), NULL, 10);
 
     /* vty_out(vty, "pro : %s%s", protocol, VTY_NEWLINE); */
     /* vty_out(vty, "op  : %s%s", op, VTY_NEWLINE); */
@@ -29,6 +29,7 @@
 #include "network.h"
 #include "linklist.h"
 #include "mpls.h"
+#include "plist.h"
 
 #include "ldpd.h"
 #include "ldpe.h"
@@ -53,10 +54,104 @@ static int	 ldp_interface_address_delete(int, struct zclient *,
 		    zebra_size_t, vrf_id_t);
 static int	 ldp_zebra_read_route(int, struct zclient *, zebra_size_t,
 		    vrf_id_t);
+static int	 ldp_zebra_read_gr_stale(int, struct zclient *, zebra_size_t,
+		    vrf_id_t);
 static void	 ldp_zebra_connected(struct zclient *);
+static void	 ldp_zebra_route_update(int, struct kroute *);
+static void	 ldp_zebra_route_queue(int, struct kroute *);
+static void	 ldp_zebra_route_send(int);
+static int	 ldp_zebra_route_flush(struct thread *);
+static int	 ldp_zebra_route_allowed(struct kroute *);
+static int	 ldp_zebra_plist_permit(const char *, int, union ldpd_addr *,
+		    uint8_t);
+static void	 ldp_zebra_redistribute(int);
+static void	 ldp_zebra_filter_schedule(int);
+static int	 ldp_zebra_filter_timer(struct thread *);
+static void	 ldp_zebra_alloc_filter_apply(void);
+static int	 ldp_zebra_adv_filter_permit(struct adv_filter_addr *);
+static void	 ldp_zebra_plist_update(struct prefix_list *);
 
 struct zclient		*zclient = NULL;
 
+/*
+ * Route updates from zebra are held for a short window and handed to lde
+ * in batches, keeping only the latest update per (prefix, nexthop). lde
+ * ignores an add for a nexthop it already has and a delete for one it
+ * does not, so the intermediate states of a reconverging IGP can be
+ * dropped without changing the outcome.
+ */
+struct zroute {
+	RB_ENTRY(zroute)	 entry;
+	int			 type;	/* IMSG_NETWORK_ADD or _DEL */
+	struct kroute		 kr;
+};
+RB_HEAD(zroute_tree, zroute);
+static __inline int zroute_compare(struct zroute *, struct zroute *);
+RB_PROTOTYPE_STATIC(zroute_tree, zroute, entry, zroute_compare)
+RB_GENERATE_STATIC(zroute_tree, zroute, entry, zroute_compare)
+
+#define ROUTE_BATCH_MAX	\
+	((MAX_IMSGSIZE - IMSG_HEADER_SIZE) / sizeof(struct kroute))
+static struct zroute_tree routes_pending =
+    RB_INITIALIZER(&routes_pending);
+static struct thread	*routes_flush_timer;
+
+/* routes that passed the label allocation filter and were given to lde */
+static struct zroute_tree routes_sent = RB_INITIALIZER(&routes_sent);
+
+/* mLDP roots and neighbor lsr-ids lde wants advertisement filter results for */
+struct adv_addr {
+	RB_ENTRY(adv_addr)	 entry;
+	struct adv_filter_addr	 fa;
+	int			 refcnt;
+};
+RB_HEAD(adv_addr_tree, adv_addr);
+static __inline int adv_addr_compare(struct adv_addr *, struct adv_addr *);
+RB_PROTOTYPE_STATIC(adv_addr_tree, adv_addr, entry, adv_addr_compare)
+RB_GENERATE_STATIC(adv_addr_tree, adv_addr, entry, adv_addr_compare)
+
+static struct adv_addr_tree adv_addrs = RB_INITIALIZER(&adv_addrs);
+
+/*
+ * Filter changes are applied once a burst of them is over: editing a
+ * prefix-list fires a hook per entry, and every re-evaluation has zebra
+ * replay its whole table.
+ */
+#define FILTER_UPDATE_DELAY	1000	/* msec */
+#define FILTER_ALLOC		0x01
+#define FILTER_ADV		0x02
+static struct thread	*filter_update_timer;
+static int		 filter_pending;
+
+static __inline int
+zroute_compare(struct zroute *a, struct zroute *b)
+{
+	int	 ret;
+
+	if (a->kr.af != b->kr.af)
+		return (a->kr.af - b->kr.af);
+	if ((ret = ldp_addrcmp(a->kr.af, &a->kr.prefix, &b->kr.prefix)) != 0)
+		return (ret);
+	if (a->kr.prefixlen != b->kr.prefixlen)
+		return (a->kr.prefixlen - b->kr.prefixlen);
+	if ((ret = ldp_addrcmp(a->kr.af, &a->kr.nexthop,
+	    &b->kr.nexthop)) != 0)
+		return (ret);
+	return (a->kr.priority - b->kr.priority);
+}
+
+static __inline int
+adv_addr_compare(struct adv_addr *a, struct adv_addr *b)
+{
+	if (a->fa.type != b->fa.type)
+		return (a->fa.type - b->fa.type);
+	if (ntohl(a->fa.addr.s_addr) < ntohl(b->fa.addr.s_addr))
+		return (-1);
+	if (ntohl(a->fa.addr.s_addr) > ntohl(b->fa.addr.s_addr))
+		return (1);
+	return (0);
+}
+
 static void
 ifp2kif(struct interface *ifp, struct kif *kif)
 {
@@ -91,7 +186,7 @@ ifc2kaddr(struct interface *ifp, struct connected *ifc, struct kaddr *ka)
 }
 
 static int
-zebra_send_mpls_lsp(u_char cmd, struct zclient *zclient, int af,
+zebra_send_mpls_lsp(u_char cmd, struct zclient *zclient, u_char type, int af,
     union ldpd_addr *nexthop, mpls_label_t in_label, mpls_label_t out_label)
 {
 	struct stream		*s;
@@ -105,7 +200,7 @@ zebra_send_mpls_lsp(u_char cmd, struct zclient *zclient, int af,
 	stream_reset(s);
 
 	zclient_create_header(s, cmd, VRF_DEFAULT);
-	stream_putc(s, ZEBRA_LSP_LDP);
+	stream_putc(s, type);
 	stream_putl(s, af);
 	switch (af) {
 	case AF_INET:
@@ -202,14 +297,21 @@ kr_change(struct kroute *kr)
 	    kr->remote_label == NO_LABEL)
 		return (0);
 
+	/* mLDP branches only have an ILM, one NHLFE per branch */
+	if (kr->flags & F_MLDP) {
+		zebra_send_mpls_lsp(ZEBRA_MPLS_LSP_ADD, zclient, ZEBRA_LSP_MLDP,
+		    kr->af, &kr->nexthop, kr->local_label, kr->remote_label);
+		return (0);
+	}
+
 	/* FEC -> NHLFE */
 	if (kr->remote_label != MPLS_LABEL_IMPLNULL)
 		zebra_send_mpls_ftn(0, zclient, kr->af, &kr->prefix,
 		    kr->prefixlen, &kr->nexthop, kr->remote_label);
 
 	/* ILM -> NHLFE */
-	zebra_send_mpls_lsp(ZEBRA_MPLS_LSP_ADD, zclient, kr->af, &kr->nexthop,
-	    kr->local_label, kr->remote_label);
+	zebra_send_mpls_lsp(ZEBRA_MPLS_LSP_ADD, zclient, ZEBRA_LSP_LDP, kr->af,
+	    &kr->nexthop, kr->local_label, kr->remote_label);
 
 	return (0);
 }
@@ -221,14 +323,21 @@ kr_delete(struct kroute *kr)
 	    kr->remote_label == NO_LABEL)
 		return (0);
 
+	if (kr->flags & F_MLDP) {
+		zebra_send_mpls_lsp(ZEBRA_MPLS_LSP_DELETE, zclient,
+		    ZEBRA_LSP_MLDP, kr->af, &kr->nexthop, kr->local_label,
+		    kr->remote_label);
+		return (0);
+	}
+
 	/* FEC -> NHLFE */
 	if (kr->remote_label != MPLS_LABEL_IMPLNULL)
 		zebra_send_mpls_ftn(1, zclient, kr->af, &kr->prefix,
 		    kr->prefixlen, &kr->nexthop, kr->remote_label);
 
 	/* ILM -> NHLFE */
-	zebra_send_mpls_lsp(ZEBRA_MPLS_LSP_DELETE, zclient, kr->af,
-	    &kr->nexthop, kr->local_label, kr->remote_label);
+	zebra_send_mpls_lsp(ZEBRA_MPLS_LSP_DELETE, zclient, ZEBRA_LSP_LDP,
+	    kr->af, &kr->nexthop, kr->local_label, kr->remote_label);
 
 	return (0);
 }
@@ -509,14 +618,14 @@ ldp_zebra_read_route(int command, struct zclient *zclient, zebra_size_t length,
 		debug_zebra_in("route add %s/%d nexthop %s (%s)",
 		    log_addr(kr.af, &kr.prefix), kr.prefixlen,
 		    log_addr(kr.af, &kr.nexthop), zebra_route_string(type));
-		main_imsg_compose_lde(IMSG_NETWORK_ADD, 0, &kr, sizeof(kr));
+		ldp_zebra_route_update(IMSG_NETWORK_ADD, &kr);
 		break;
 	case ZEBRA_IPV4_ROUTE_DELETE:
 	case ZEBRA_IPV6_ROUTE_DELETE:
 		debug_zebra_in("route delete %s/%d nexthop %s (%s)",
 		    log_addr(kr.af, &kr.prefix), kr.prefixlen,
 		    log_addr(kr.af, &kr.nexthop), zebra_route_string(type));
-		main_imsg_compose_lde(IMSG_NETWORK_DEL, 0, &kr, sizeof(kr));
+		ldp_zebra_route_update(IMSG_NETWORK_DEL, &kr);
 		break;
 	default:
 		fatalx("ldp_zebra_read_route: unknown command");
@@ -525,12 +634,430 @@ ldp_zebra_read_route(int command, struct zclient *zclient, zebra_size_t length,
 	return (0);
 }
 
+/*
+ * Only routes that pass the label allocation filter ever reach lde, so
+ * the prefixes filtered out get no fec_node, no local label and no
+ * mappings.
+ */
 static void
-ldp_zebra_connected(struct zclient *zclient)
+ldp_zebra_route_update(int type, struct kroute *kr)
 {
-	int	i;
+	struct zroute	*zr, key;
+
+	key.kr = *kr;
+	zr = RB_FIND(zroute_tree, &routes_sent, &key);
+
+	switch (type) {
+	case IMSG_NETWORK_ADD:
+		if (!ldp_zebra_route_allowed(kr))
+			return;
+		if (!ldp_zebra_plist_permit(ldpd_conf->adv_for_plist, kr->af,
+		    &kr->prefix, kr->prefixlen))
+			kr->flags |= F_NO_ADVERTISE;
+		if (zr == NULL) {
+			if ((zr = calloc(1, sizeof(*zr))) == NULL)
+				fatal(__func__);
+			zr->kr = *kr;
+			RB_INSERT(zroute_tree, &routes_sent, zr);
+		}
+		zr->kr = *kr;
+		break;
+	case IMSG_NETWORK_DEL:
+		if (zr == NULL)
+			return;
+		RB_REMOVE(zroute_tree, &routes_sent, zr);
+		free(zr);
+		break;
+	}
 
-	zclient_send_requests(zclient, VRF_DEFAULT);
+	ldp_zebra_route_queue(type, kr);
+}
+
+static int
+ldp_zebra_route_allowed(struct kroute *kr)
+{
+	if (ldpd_conf->flags & F_LDPD_ALLOC_HOST_ROUTES) {
+		switch (kr->af) {
+		case AF_INET:
+			return (kr->prefixlen == IPV4_MAX_PREFIXLEN);
+		case AF_INET6:
+			return (kr->prefixlen == IPV6_MAX_PREFIXLEN);
+		default:
+			return (0);
+		}
+	}
+
+	if (ldpd_conf->flags & F_LDPD_ALLOC_PLIST)
+		return (ldp_zebra_plist_permit(ldpd_conf->alloc_plist, kr->af,
+		    &kr->prefix, kr->prefixlen));
+
+	return (1);
+}
+
+/* an empty name lets everything through */
+static int
+ldp_zebra_plist_permit(const char *name, int af, union ldpd_addr *addr,
+    uint8_t prefixlen)
+{
+	struct prefix_list	*plist;
+	struct prefix		 p;
+
+	if (name[0] == '\0')
+		return (1);
+
+	memset(&p, 0, sizeof(p));
+	p.family = af;
+	p.prefixlen = prefixlen;
+	switch (af) {
+	case AF_INET:
+		p.u.prefix4 = addr->v4;
+		plist = prefix_list_lookup(AFI_IP, name);
+		break;
+	case AF_INET6:
+		p.u.prefix6 = addr->v6;
+		plist = prefix_list_lookup(AFI_IP6, name);
+		break;
+	default:
+		return (0);
+	}
+
+	/* like route-maps, a list that does not exist denies all */
+	return (prefix_list_apply(plist, &p) == PREFIX_PERMIT);
+}
+
+/* re-evaluate the label allocation filter once changes to it settle */
+void
+ldp_zebra_filter_update(void)
+{
+	ldp_zebra_filter_schedule(FILTER_ALLOC);
+}
+
+static void
+ldp_zebra_filter_schedule(int filters)
+{
+	filter_pending |= filters;
+	THREAD_TIMER_OFF(filter_update_timer);
+	filter_update_timer = thread_add_timer_msec(master,
+	    ldp_zebra_filter_timer, NULL, FILTER_UPDATE_DELAY);
+}
+
+/* ARGSUSED */
+static int
+ldp_zebra_filter_timer(struct thread *thread)
+{
+	filter_update_timer = NULL;
+
+	if (filter_pending & FILTER_ALLOC)
+		ldp_zebra_alloc_filter_apply();
+	if (filter_pending & FILTER_ADV)
+		ldp_zebra_adv_filter_update();
+	filter_pending = 0;
+
+	return (0);
+}
+
+static void
+ldp_zebra_alloc_filter_apply(void)
+{
+	struct zroute	*zr, *safe;
+
+	RB_FOREACH_SAFE(zr, zroute_tree, &routes_sent, safe) {
+		if (ldp_zebra_route_allowed(&zr->kr))
+			continue;
+
+		ldp_zebra_route_queue(IMSG_NETWORK_DEL, &zr->kr);
+		RB_REMOVE(zroute_tree, &routes_sent, zr);
+		free(zr);
+	}
+
+	/* have zebra replay its table for the routes now let in */
+	if (zclient != NULL && zclient->sock >= 0) {
+		ldp_zebra_redistribute(ZEBRA_REDISTRIBUTE_DELETE);
+		ldp_zebra_redistribute(ZEBRA_REDISTRIBUTE_ADD);
+	}
+}
+
+/*
+ * Re-apply the label advertisement filters, and tell lde only about the
+ * routes and addresses whose result changed.
+ */
+void
+ldp_zebra_adv_filter_update(void)
+{
+	struct zroute		*zr;
+	struct adv_addr		*aa;
+	int			 flags, permit;
+
+	RB_FOREACH(zr, zroute_tree, &routes_sent) {
+		flags = zr->kr.flags & ~F_NO_ADVERTISE;
+		if (!ldp_zebra_plist_permit(ldpd_conf->adv_for_plist,
+		    zr->kr.af, &zr->kr.prefix, zr->kr.prefixlen))
+			flags |= F_NO_ADVERTISE;
+		if (flags == zr->kr.flags)
+			continue;
+
+		zr->kr.flags = flags;
+		ldp_zebra_route_queue(IMSG_NETWORK_ADD, &zr->kr);
+	}
+
+	RB_FOREACH(aa, adv_addr_tree, &adv_addrs) {
+		permit = ldp_zebra_adv_filter_permit(&aa->fa);
+		if (permit == aa->fa.permit)
+			continue;
+
+		aa->fa.permit = permit;
+		main_imsg_compose_lde(IMSG_ADV_FILTER_RESULT, 0, &aa->fa,
+		    sizeof(aa->fa));
+	}
+}
+
+static int
+ldp_zebra_adv_filter_permit(struct adv_filter_addr *fa)
+{
+	union ldpd_addr		 addr;
+	const char		*name;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.v4 = fa->addr;
+	if (fa->type == ADV_FILTER_ROOT)
+		name = ldpd_conf->adv_for_plist;
+	else
+		name = ldpd_conf->adv_to_plist;
+
+	return (ldp_zebra_plist_permit(name, AF_INET, &addr,
+	    IPV4_MAX_PREFIXLEN));
+}
+
+/* lde needs the result for an mLDP root or a neighbor */
+void
+ldp_zebra_adv_filter_add(struct adv_filter_addr *fa)
+{
+	struct adv_addr		*aa, key;
+
+	key.fa = *fa;
+	if ((aa = RB_FIND(adv_addr_tree, &adv_addrs, &key)) == NULL) {
+		if ((aa = calloc(1, sizeof(*aa))) == NULL)
+			fatal(__func__);
+		aa->fa = *fa;
+		RB_INSERT(adv_addr_tree, &adv_addrs, aa);
+	}
+	aa->refcnt++;
+
+	aa->fa.permit = ldp_zebra_adv_filter_permit(&aa->fa);
+	main_imsg_compose_lde(IMSG_ADV_FILTER_RESULT, 0, &aa->fa,
+	    sizeof(aa->fa));
+}
+
+void
+ldp_zebra_adv_filter_del(struct adv_filter_addr *fa)
+{
+	struct adv_addr		*aa, key;
+
+	key.fa = *fa;
+	if ((aa = RB_FIND(adv_addr_tree, &adv_addrs, &key)) == NULL)
+		return;
+	if (--aa->refcnt > 0)
+		return;
+
+	RB_REMOVE(adv_addr_tree, &adv_addrs, aa);
+	free(aa);
+}
+
+static void
+ldp_zebra_plist_update(struct prefix_list *plist)
+{
+	const char	*name = prefix_list_name(plist);
+	int		 filters = 0;
+
+	if ((ldpd_conf->flags & F_LDPD_ALLOC_PLIST) &&
+	    strcmp(name, ldpd_conf->alloc_plist) == 0)
+		filters |= FILTER_ALLOC;
+	if (strcmp(name, ldpd_conf->adv_for_plist) == 0 ||
+	    strcmp(name, ldpd_conf->adv_to_plist) == 0)
+		filters |= FILTER_ADV;
+
+	if (filters)
+		ldp_zebra_filter_schedule(filters);
+}
+
+static void
+ldp_zebra_route_queue(int type, struct kroute *kr)
+{
+	struct zroute	*rp, key;
+
+	key.kr = *kr;
+	rp = RB_FIND(zroute_tree, &routes_pending, &key);
+	if (rp == NULL) {
+		if ((rp = calloc(1, sizeof(*rp))) == NULL)
+			fatal(__func__);
+		rp->kr = *kr;
+		RB_INSERT(zroute_tree, &routes_pending, rp);
+	}
+
+	/* latest state wins */
+	rp->type = type;
+	rp->kr = *kr;
+
+	/* the window starts with the first update, later ones don't extend it */
+	if (routes_flush_timer == NULL)
+		routes_flush_timer = thread_add_timer_msec(master,
+		    ldp_zebra_route_flush, NULL, ldpd_conf->route_delay);
+}
+
+static void
+ldp_zebra_route_send(int type)
+{
+	static struct kroute	 batch[ROUTE_BATCH_MAX];
+	struct zroute	*rp, *safe;
+	unsigned int		 cnt = 0;
+
+	RB_FOREACH_SAFE(rp, zroute_tree, &routes_pending, safe) {
+		if (rp->type != type)
+			continue;
+
+		batch[cnt++] = rp->kr;
+		RB_REMOVE(zroute_tree, &routes_pending, rp);
+		free(rp);
+
+		if (cnt == ROUTE_BATCH_MAX) {
+			main_imsg_compose_lde(type, 0, batch,
+			    cnt * sizeof(struct kroute));
+			cnt = 0;
+		}
+	}
+	if (cnt > 0)
+		main_imsg_compose_lde(type, 0, batch,
+		    cnt * sizeof(struct kroute));
+}
+
+/* ARGSUSED */
+static int
+ldp_zebra_route_flush(struct thread *thread)
+{
+	routes_flush_timer = NULL;
+
+	/*
+	 * Additions go first so that a prefix whose nexthop was replaced
+	 * never looks unreachable to lde, which would withdraw its label.
+	 */
+	ldp_zebra_route_send(IMSG_NETWORK_ADD);
+	ldp_zebra_route_send(IMSG_NETWORK_DEL);
+
+	return (0);
+}
+
+/*
+ * Tell zebra how long to keep our LSPs if this session drops: the time our
+ * neighbors wait for us to reconnect plus the time they give us to
+ * re-advertise. Zebra sweeps whatever we did not install again by then.
+ */
+void
+ldp_zebra_gr_update(void)
+{
+	struct stream	*s;
+	uint32_t	 gr_time = 0;
+
+	if (zclient == NULL || zclient->sock < 0)
+		return;
+
+	if (ldpd_conf->flags & F_LDPD_GR)
+		gr_time = DEFAULT_GR_RECONNECT + DEFAULT_GR_RECOVERY;
+
+	debug_zebra_out("graceful restart: preserve lsps for %u seconds",
+	    gr_time);
+
+	s = zclient->obuf;
+	stream_reset(s);
+
+	zclient_create_header(s, ZEBRA_MPLS_LDP_GR, VRF_DEFAULT);
+	stream_putl(s, gr_time);
+	stream_putw_at(s, 0, stream_get_endp(s));
+
+	zclient_send_message(zclient);
+}
+
+/*
+ * Zebra's answer to ldp_zebra_gr_update(): the in-labels it still forwards
+ * on from our previous incarnation and how long it keeps them. lde must not
+ * bind them to anything else meanwhile, and ldpe advertises the remaining
+ * time as our recovery time (zero on a cold start).
+ */
+static int
+ldp_zebra_read_gr_stale(int command, struct zclient *zclient,
+    zebra_size_t length, vrf_id_t vrf_id)
+{
+	struct stream	*s = zclient->ibuf;
+	uint32_t	 recovery, count, i;
+	uint32_t	*labels;
+
+	recovery = stream_getl(s);
+	count = stream_getl(s);
+	if (count > STREAM_READABLE(s) / sizeof(uint32_t)) {
+		log_warnx("%s: invalid label count %u", __func__, count);
+		return (-1);
+	}
+
+	debug_zebra_in("graceful restart: %u stale labels, recovery %u "
+	    "seconds", count, recovery);
+
+	if (count > 0) {
+		labels = calloc(count, sizeof(*labels));
+		if (labels == NULL)
+			fatal(__func__);
+		for (i = 0; i < count; i++)
+			labels[i] = stream_getl(s);
+		main_imsg_compose_lde(IMSG_GR_STALE_LABELS, 0, labels,
+		    count * sizeof(*labels));
+		free(labels);
+	}
+	main_imsg_compose_both(IMSG_GR_RECOVERY, &recovery, sizeof(recovery));
+
+	return (0);
+}
+
+/*
+ * Tell the IGPs whether labels have been exchanged on a link yet, so they
+ * can hold it at the maximum metric meanwhile (RFC 5443).
+ */
+void
+ldp_zebra_ldp_sync(unsigned int ifindex, int state)
+{
+	struct stream	*s;
+	u_char		 zstate;
+
+	if (zclient == NULL || zclient->sock < 0)
+		return;
+
+	switch (state) {
+	case LDP_SYNC_NOT_ACHIEVED:
+		zstate = LDP_IGP_SYNC_NOT_ACHIEVED;
+		break;
+	case LDP_SYNC_ACHIEVED:
+		zstate = LDP_IGP_SYNC_ACHIEVED;
+		break;
+	case LDP_SYNC_OFF:
+	default:
+		zstate = LDP_IGP_SYNC_OFF;
+		break;
+	}
+
+	debug_zebra_out("ldp-igp sync: ifindex %u state %u", ifindex, zstate);
+
+	s = zclient->obuf;
+	stream_reset(s);
+
+	zclient_create_header(s, ZEBRA_MPLS_LDP_SYNC, VRF_DEFAULT);
+	stream_putl(s, ifindex);
+	stream_putc(s, zstate);
+	stream_putw_at(s, 0, stream_get_endp(s));
+
+	zclient_send_message(zclient);
+}
+
+static void
+ldp_zebra_redistribute(int command)
+{
+	int	i;
 
 	for (i = 0; i < ZEBRA_ROUTE_MAX; i++) {
 		switch (i) {
@@ -542,8 +1069,8 @@ ldp_zebra_connected(struct zclient *zclient)
 		case ZEBRA_ROUTE_OSPF:
 		case ZEBRA_ROUTE_OSPF6:
 		case ZEBRA_ROUTE_ISIS:
-			zclient_redistribute(ZEBRA_REDISTRIBUTE_ADD, zclient,
-			    i, VRF_DEFAULT);
+			zclient_redistribute(command, zclient, i,
+			    VRF_DEFAULT);
 			break;
 		case ZEBRA_ROUTE_BGP:
 		default:
@@ -553,6 +1080,20 @@ ldp_zebra_connected(struct zclient *zclient)
 	}
 }
 
+static void
+ldp_zebra_connected(struct zclient *zclient)
+{
+	struct iface	*iface;
+
+	zclient_send_requests(zclient, VRF_DEFAULT);
+	ldp_zebra_gr_update();
+	ldp_zebra_redistribute(ZEBRA_REDISTRIBUTE_ADD);
+
+	LIST_FOREACH(iface, &ldpd_conf->iface_list, entry)
+		if (iface->ldp_sync != LDP_SYNC_OFF)
+			ldp_zebra_ldp_sync(iface->ifindex, iface->ldp_sync);
+}
+
 void
 ldp_zebra_init(struct thread_master *master)
 {
@@ -573,4 +1114,8 @@ ldp_zebra_init(struct thread_master *master)
 	zclient->ipv4_route_delete = ldp_zebra_read_route;
 	zclient->ipv6_route_add = ldp_zebra_read_route;
 	zclient->ipv6_route_delete = ldp_zebra_read_route;
+	zclient->ldp_gr_stale = ldp_zebra_read_gr_stale;
+
+	prefix_list_add_hook(ldp_zebra_plist_update);
+	prefix_list_delete_hook(ldp_zebra_plist_update);
 }
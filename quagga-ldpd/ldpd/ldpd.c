@@ -39,6 +39,7 @@
 #include "sigevent.h"
 #include "zclient.h"
 #include "vrf.h"
+#include "plist.h"
 
 static void		 ldpd_shutdown(void);
 static pid_t		 start_child(enum ldpd_process, char *, int,
@@ -61,6 +62,7 @@ static void		 merge_ifaces(struct ldpd_conf *, struct ldpd_conf *);
 static void		 merge_iface_af(struct iface_af *, struct iface_af *);
 static void		 merge_tnbrs(struct ldpd_conf *, struct ldpd_conf *);
 static void		 merge_nbrps(struct ldpd_conf *, struct ldpd_conf *);
+static void		 merge_aliases(struct ldpd_conf *, struct ldpd_conf *);
 static void		 merge_l2vpns(struct ldpd_conf *, struct ldpd_conf *);
 static void		 merge_l2vpn(struct ldpd_conf *, struct l2vpn *,
 			    struct l2vpn *);
@@ -327,6 +329,7 @@ main(int argc, char *argv[])
 	vrf_init();
 	ldp_vty_init();
 	ldp_vty_if_init();
+	prefix_list_init();
 
 	/* Get configuration file. */
 	ldpd_conf = config_new_empty();
@@ -508,6 +511,8 @@ main_dispatch_ldpe(struct thread *thread)
 	struct imsgev		*iev = THREAD_ARG(thread);
 	struct imsgbuf		*ibuf = &iev->ibuf;
 	struct imsg		 imsg;
+	struct ldp_sync		 sync;
+	struct iface		*iface;
 	int			 af;
 	ssize_t			 n;
 	int			 shut = 0;
@@ -534,6 +539,17 @@ main_dispatch_ldpe(struct thread *thread)
 			af = imsg.hdr.pid;
 			main_imsg_send_net_sockets(af);
 			break;
+		case IMSG_LDP_IGP_SYNC:
+			if (imsg.hdr.len - IMSG_HEADER_SIZE != sizeof(sync))
+				fatalx("invalid size of IMSG_LDP_IGP_SYNC");
+			memcpy(&sync, imsg.data, sizeof(sync));
+
+			/* kept to replay on zebra reconnect */
+			iface = if_lookup(ldpd_conf, sync.ifindex);
+			if (iface)
+				iface->ldp_sync = sync.state;
+			ldp_zebra_ldp_sync(sync.ifindex, sync.state);
+			break;
 		default:
 			log_debug("%s: error handling imsg %d", __func__,
 			    imsg.hdr.type);
@@ -615,6 +631,16 @@ main_dispatch_lde(struct thread *thread)
 				log_warnx("%s: error unsetting pseudowire",
 				    __func__);
 			break;
+		case IMSG_ADV_FILTER_ADD:
+		case IMSG_ADV_FILTER_DEL:
+			if (imsg.hdr.len - IMSG_HEADER_SIZE !=
+			    sizeof(struct adv_filter_addr))
+				fatalx("invalid size of IMSG_ADV_FILTER");
+			if (imsg.hdr.type == IMSG_ADV_FILTER_ADD)
+				ldp_zebra_adv_filter_add(imsg.data);
+			else
+				ldp_zebra_adv_filter_del(imsg.data);
+			break;
 		default:
 			log_debug("%s: error handling imsg %d", __func__,
 			    imsg.hdr.type);
@@ -840,6 +866,7 @@ main_imsg_send_config(struct ldpd_conf *xconf)
 	struct iface		*iface;
 	struct tnbr		*tnbr;
 	struct nbr_params	*nbrp;
+	struct lsrid_alias	*alias;
 	struct l2vpn		*l2vpn;
 	struct l2vpn_if		*lif;
 	struct l2vpn_pw		*pw;
@@ -866,6 +893,12 @@ main_imsg_send_config(struct ldpd_conf *xconf)
 			return (-1);
 	}
 
+	RB_FOREACH(alias, lsrid_alias_head, &xconf->alias_tree) {
+		if (main_imsg_compose_both(IMSG_RECONF_ALIAS, alias,
+		    sizeof(*alias)) == -1)
+			return (-1);
+	}
+
 	LIST_FOREACH(l2vpn, &xconf->l2vpn_list, entry) {
 		if (main_imsg_compose_both(IMSG_RECONF_L2VPN, l2vpn,
 		    sizeof(*l2vpn)) == -1)
@@ -945,6 +978,7 @@ ldp_config_reset_main(struct ldpd_conf *conf)
 {
 	struct iface		*iface;
 	struct nbr_params	*nbrp;
+	struct lsrid_alias	*alias;
 
 	while ((iface = LIST_FIRST(&conf->iface_list)) != NULL) {
 		LIST_REMOVE(iface, entry);
@@ -956,6 +990,11 @@ ldp_config_reset_main(struct ldpd_conf *conf)
 		free(nbrp);
 	}
 
+	while ((alias = RB_ROOT(&conf->alias_tree)) != NULL) {
+		RB_REMOVE(lsrid_alias_head, &conf->alias_tree, alias);
+		free(alias);
+	}
+
 	conf->rtr_id.s_addr = INADDR_ANY;
 	ldp_config_reset_af(conf, AF_INET);
 	ldp_config_reset_af(conf, AF_INET6);
@@ -964,6 +1003,7 @@ ldp_config_reset_main(struct ldpd_conf *conf)
 	conf->thello_holdtime = TARGETED_DFLT_HOLDTIME;
 	conf->thello_interval = DEFAULT_HELLO_INTERVAL;
 	conf->trans_pref = DUAL_STACK_LDPOV6;
+	conf->route_delay = DEFAULT_ROUTE_DELAY;
 	conf->flags = 0;
 }
 
@@ -1005,6 +1045,7 @@ ldp_dup_config(struct ldpd_conf *conf)
 	struct iface		*iface, *xi;
 	struct tnbr		*tnbr, *xt;
 	struct nbr_params	*nbrp, *xn;
+	struct lsrid_alias	*alias, *xa;
 	struct l2vpn		*l2vpn, *xl;
 	struct l2vpn_if		*lif, *xf;
 	struct l2vpn_pw		*pw, *xp;
@@ -1014,6 +1055,7 @@ ldp_dup_config(struct ldpd_conf *conf)
 	LIST_INIT(&xconf->iface_list);
 	LIST_INIT(&xconf->tnbr_list);
 	LIST_INIT(&xconf->nbrp_list);
+	RB_INIT(&xconf->alias_tree);
 	LIST_INIT(&xconf->l2vpn_list);
 
 	LIST_FOREACH(iface, &conf->iface_list, entry) {
@@ -1039,6 +1081,13 @@ ldp_dup_config(struct ldpd_conf *conf)
 		*xn = *nbrp;
 		LIST_INSERT_HEAD(&xconf->nbrp_list, xn, entry);
 	}
+	RB_FOREACH(alias, lsrid_alias_head, &conf->alias_tree) {
+		xa = calloc(1, sizeof(*xa));
+		if (xa == NULL)
+			fatal(__func__);
+		*xa = *alias;
+		RB_INSERT(lsrid_alias_head, &xconf->alias_tree, xa);
+	}
 	LIST_FOREACH(l2vpn, &conf->l2vpn_list, entry) {
 		xl = calloc(1, sizeof(*xl));
 		if (xl == NULL)
@@ -1084,6 +1133,7 @@ ldp_clear_config(struct ldpd_conf *xconf)
 	struct iface		*iface;
 	struct tnbr		*tnbr;
 	struct nbr_params	*nbrp;
+	struct lsrid_alias	*alias;
 	struct l2vpn		*l2vpn;
 
 	while ((iface = LIST_FIRST(&xconf->iface_list)) != NULL) {
@@ -1098,6 +1148,10 @@ ldp_clear_config(struct ldpd_conf *xconf)
 		LIST_REMOVE(nbrp, entry);
 		free(nbrp);
 	}
+	while ((alias = RB_ROOT(&xconf->alias_tree)) != NULL) {
+		RB_REMOVE(lsrid_alias_head, &xconf->alias_tree, alias);
+		free(alias);
+	}
 	while ((l2vpn = LIST_FIRST(&xconf->l2vpn_list)) != NULL) {
 		LIST_REMOVE(l2vpn, entry);
 		l2vpn_del(l2vpn);
@@ -1115,6 +1169,7 @@ merge_config(struct ldpd_conf *conf, struct ldpd_conf *xconf)
 	merge_ifaces(conf, xconf);
 	merge_tnbrs(conf, xconf);
 	merge_nbrps(conf, xconf);
+	merge_aliases(conf, xconf);
 	merge_l2vpns(conf, xconf);
 	free(xconf);
 }
@@ -1122,6 +1177,8 @@ merge_config(struct ldpd_conf *conf, struct ldpd_conf *xconf)
 static void
 merge_global(struct ldpd_conf *conf, struct ldpd_conf *xconf)
 {
+	int	gr_changed, filter_changed, adv_changed;
+
 	/* change of router-id requires resetting all neighborships */
 	if (conf->rtr_id.s_addr != xconf->rtr_id.s_addr) {
 		if (ldpd_process == PROC_LDP_ENGINE) {
@@ -1140,6 +1197,7 @@ merge_global(struct ldpd_conf *conf, struct ldpd_conf *xconf)
 	conf->lhello_interval = xconf->lhello_interval;
 	conf->thello_holdtime = xconf->thello_holdtime;
 	conf->thello_interval = xconf->thello_interval;
+	conf->route_delay = xconf->route_delay;
 
 	if (conf->trans_pref != xconf->trans_pref) {
 		if (ldpd_process == PROC_LDP_ENGINE)
@@ -1153,7 +1211,41 @@ merge_global(struct ldpd_conf *conf, struct ldpd_conf *xconf)
 			ldpe_reset_ds_nbrs();
 	}
 
+	/* sessions pick up the FT session TLV when they next come up */
+	gr_changed = (conf->flags & F_LDPD_GR) != (xconf->flags & F_LDPD_GR);
+
+	filter_changed = (conf->flags & F_LDPD_ALLOC_MASK) !=
+	    (xconf->flags & F_LDPD_ALLOC_MASK) ||
+	    strcmp(conf->alloc_plist, xconf->alloc_plist) != 0;
+	strlcpy(conf->alloc_plist, xconf->alloc_plist,
+	    sizeof(conf->alloc_plist));
+
+	adv_changed = strcmp(conf->adv_for_plist, xconf->adv_for_plist) != 0 ||
+	    strcmp(conf->adv_to_plist, xconf->adv_to_plist) != 0;
+	strlcpy(conf->adv_for_plist, xconf->adv_for_plist,
+	    sizeof(conf->adv_for_plist));
+	strlcpy(conf->adv_to_plist, xconf->adv_to_plist,
+	    sizeof(conf->adv_to_plist));
+
 	conf->flags = xconf->flags;
+
+	if (gr_changed && ldpd_process == PROC_MAIN)
+		ldp_zebra_gr_update();
+	if (filter_changed && ldpd_process == PROC_MAIN)
+		ldp_zebra_filter_update();
+	if (adv_changed && ldpd_process == PROC_MAIN)
+		ldp_zebra_adv_filter_update();
+	if (adv_changed && ldpd_process == PROC_LDE_ENGINE)
+		lde_adv_filter_config();
+
+	/* labels already bound keep their value until they are released */
+	if (memcmp(conf->label_blocks, xconf->label_blocks,
+	    sizeof(conf->label_blocks)) != 0) {
+		memcpy(conf->label_blocks, xconf->label_blocks,
+		    sizeof(conf->label_blocks));
+		if (ldpd_process == PROC_LDE_ENGINE)
+			lde_label_init();
+	}
 }
 
 static void
@@ -1400,6 +1492,43 @@ merge_nbrps(struct ldpd_conf *conf, struct ldpd_conf *xconf)
 	}
 }
 
+static void
+merge_aliases(struct ldpd_conf *conf, struct ldpd_conf *xconf)
+{
+	struct lsrid_alias	*alias, *atmp, *xa;
+	int			 changed = 0;
+
+	RB_FOREACH_SAFE(alias, lsrid_alias_head, &conf->alias_tree, atmp) {
+		/* find deleted aliases */
+		if (lsrid_alias_find(xconf, alias->addr) == NULL) {
+			RB_REMOVE(lsrid_alias_head, &conf->alias_tree, alias);
+			free(alias);
+			changed = 1;
+		}
+	}
+	RB_FOREACH_SAFE(xa, lsrid_alias_head, &xconf->alias_tree, atmp) {
+		RB_REMOVE(lsrid_alias_head, &xconf->alias_tree, xa);
+
+		/* find new aliases */
+		if ((alias = lsrid_alias_find(conf, xa->addr)) == NULL) {
+			RB_INSERT(lsrid_alias_head, &conf->alias_tree, xa);
+			changed = 1;
+			continue;
+		}
+
+		/* update existing aliases */
+		if (alias->lsr_id.s_addr != xa->lsr_id.s_addr) {
+			alias->lsr_id = xa->lsr_id;
+			changed = 1;
+		}
+		free(xa);
+	}
+
+	/* mLDP roots may now resolve to another upstream */
+	if (changed && ldpd_process == PROC_LDE_ENGINE)
+		mldp_root_update_all();
+}
+
 static void
 merge_l2vpns(struct ldpd_conf *conf, struct ldpd_conf *xconf)
 {
@@ -1683,6 +1812,7 @@ config_new_empty(void)
 	LIST_INIT(&xconf->iface_list);
 	LIST_INIT(&xconf->tnbr_list);
 	LIST_INIT(&xconf->nbrp_list);
+	RB_INIT(&xconf->alias_tree);
 	LIST_INIT(&xconf->l2vpn_list);
 
 	return (xconf);
@@ -1704,6 +1834,14 @@ config_clear(struct ldpd_conf *conf)
 	xconf->ipv6 = conf->ipv6;
 	xconf->rtr_id = conf->rtr_id;
 	xconf->trans_pref = conf->trans_pref;
+	strlcpy(xconf->alloc_plist, conf->alloc_plist,
+	    sizeof(xconf->alloc_plist));
+	strlcpy(xconf->adv_for_plist, conf->adv_for_plist,
+	    sizeof(xconf->adv_for_plist));
+	strlcpy(xconf->adv_to_plist, conf->adv_to_plist,
+	    sizeof(xconf->adv_to_plist));
+	memcpy(xconf->label_blocks, conf->label_blocks,
+	    sizeof(xconf->label_blocks));
 	xconf->flags = conf->flags;
 	merge_config(conf, xconf);
 	free(conf);
@@ -38,6 +38,7 @@
 
 #define TCP_MD5_KEY_LEN		80
 #define L2VPN_NAME_LEN		32
+#define PLIST_NAME_LEN		32
 
 #define	RT_BUF_SIZE		16384
 #define	MAX_RTSOCK_BUF		128 * 1024
@@ -50,11 +51,8 @@
 #define	F_REJECT		0x0010
 #define	F_BLACKHOLE		0x0020
 #define	F_REDISTRIBUTED		0x0040
-
-//////////////////////////////////////////////////////////////////////////////////////
-
-
-///////////////////////////////////////////////////////////////////////////////////////
+#define	F_MLDP			0x0080
+#define	F_NO_ADVERTISE		0x0100	/* denied by the "for" list */
 
 struct evbuf {
 	struct msgbuf		 wbuf;
@@ -83,11 +81,12 @@ enum imsg_type {
 	IMSG_CTL_SHOW_NBR_DISC,
 	IMSG_CTL_SHOW_NBR_END,
 	IMSG_CTL_SHOW_LIB,
-	//////////////////////////////////
 	IMSG_CTL_MLDP_LSP,
-	///////////////////////////////////
+	IMSG_CTL_SHOW_MLDP,
+	IMSG_CTL_SHOW_MLDP_BRANCH,
 	IMSG_CTL_SHOW_L2VPN_PW,
 	IMSG_CTL_SHOW_L2VPN_BINDING,
+	IMSG_CTL_SHOW_LABELS,
 	IMSG_CTL_CLEAR_NBR,
 	IMSG_CTL_FIB_COUPLE,
 	IMSG_CTL_FIB_DECOUPLE,
@@ -104,6 +103,9 @@ enum imsg_type {
 	IMSG_NEWADDR,
 	IMSG_DELADDR,
 	IMSG_RTRID_UPDATE,
+	IMSG_LDP_IGP_SYNC,
+	IMSG_GR_STALE_LABELS,
+	IMSG_GR_RECOVERY,
 	IMSG_LABEL_MAPPING,
 	IMSG_LABEL_MAPPING_FULL,
 	IMSG_LABEL_REQUEST,
@@ -114,6 +116,7 @@ enum imsg_type {
 	IMSG_REQUEST_ADD_END,
 	IMSG_MAPPING_ADD,
 	IMSG_MAPPING_ADD_END,
+	IMSG_MAPPING_FULL_END,
 	IMSG_RELEASE_ADD,
 	IMSG_RELEASE_ADD_END,
 	IMSG_WITHDRAW_ADD,
@@ -126,6 +129,9 @@ enum imsg_type {
 	IMSG_NEIGHBOR_DOWN,
 	IMSG_NETWORK_ADD,
 	IMSG_NETWORK_DEL,
+	IMSG_ADV_FILTER_ADD,
+	IMSG_ADV_FILTER_DEL,
+	IMSG_ADV_FILTER_RESULT,
 	IMSG_SOCKET_IPC,
 	IMSG_SOCKET_NET,
 	IMSG_CLOSE_SOCKETS,
@@ -135,6 +141,7 @@ enum imsg_type {
 	IMSG_RECONF_IFACE,
 	IMSG_RECONF_TNBR,
 	IMSG_RECONF_NBRP,
+	IMSG_RECONF_ALIAS,
 	IMSG_RECONF_L2VPN,
 	IMSG_RECONF_L2VPN_IF,
 	IMSG_RECONF_L2VPN_PW,
@@ -204,14 +211,16 @@ enum nbr_action {
 
 TAILQ_HEAD(mapping_head, mapping_entry);
 
+#define MLDP_OPAQUE_MAX_LEN	32
+
 struct map {
 	uint8_t		type;
 	uint32_t	msg_id;
 	union {
 		struct {
-			uint16_t	af;	
-			uint8_t		prefixlen;//ov
-			union ldpd_addr	prefix;//根节点地址
+			uint16_t	af;
+			uint8_t		prefixlen;
+			union ldpd_addr	prefix;
 		} prefix;
 		struct {
 			uint16_t	type;
@@ -219,6 +228,11 @@ struct map {
 			uint32_t	group_id;
 			uint16_t	ifmtu;
 		} pwid;
+		struct {
+			struct in_addr	root;
+			uint16_t	opaque_len;
+			uint8_t		opaque[MLDP_OPAQUE_MAX_LEN];
+		} mldp;
 	} fec;
 	struct {
 		uint32_t	status_code;
@@ -279,6 +293,19 @@ struct iface {
 	uint16_t		 flags;
 	struct iface_af		 ipv4;
 	struct iface_af		 ipv6;
+	int			 ldp_sync;
+};
+
+/* LDP-IGP synchronization state of an interface (RFC 5443) */
+enum ldp_sync_state {
+	LDP_SYNC_OFF,
+	LDP_SYNC_NOT_ACHIEVED,
+	LDP_SYNC_ACHIEVED
+};
+
+struct ldp_sync {
+	unsigned int		 ifindex;
+	int			 state;
 };
 
 /* source of targeted hellos */
@@ -318,6 +345,15 @@ struct nbr_params {
 #define F_NBRP_GTSM		 0x02
 #define F_NBRP_GTSM_HOPS	 0x04
 
+/* address of a neighbor that is not in its address list, e.g. a root */
+struct lsrid_alias {
+	RB_ENTRY(lsrid_alias)	 entry;
+	struct in_addr		 addr;
+	struct in_addr		 lsr_id;
+};
+RB_HEAD(lsrid_alias_head, lsrid_alias);
+RB_PROTOTYPE(lsrid_alias_head, lsrid_alias, entry, lsrid_alias_compare)
+
 struct l2vpn_if {
 	LIST_ENTRY(l2vpn_if)	 entry;
 	struct l2vpn		*l2vpn;
@@ -394,6 +430,21 @@ struct ldpd_af_conf {
 #define	F_LDPD_AF_EXPNULL	0x0004
 #define	F_LDPD_AF_NO_GTSM	0x0008
 
+/* label applications that can be given their own local label block */
+enum label_app {
+	LABEL_APP_IPV4,
+	LABEL_APP_IPV6,
+	LABEL_APP_PW,
+	LABEL_APP_MLDP,
+	LABEL_APP_MAX
+};
+
+/* min == 0: the application allocates from the shared dynamic range */
+struct label_block {
+	uint32_t		 min;
+	uint32_t		 max;
+};
+
 struct ldpd_conf {
 	struct in_addr		 rtr_id;
 	struct ldpd_af_conf	 ipv4;
@@ -401,17 +452,31 @@ struct ldpd_conf {
 	LIST_HEAD(, iface)	 iface_list;
 	LIST_HEAD(, tnbr)	 tnbr_list;
 	LIST_HEAD(, nbr_params)	 nbrp_list;
+	struct lsrid_alias_head	 alias_tree;
 	LIST_HEAD(, l2vpn)	 l2vpn_list;
 	uint16_t		 lhello_holdtime;
 	uint16_t		 lhello_interval;
 	uint16_t		 thello_holdtime;
 	uint16_t		 thello_interval;
 	uint16_t		 trans_pref;
+	uint16_t		 route_delay;	/* msec */
+	char			 alloc_plist[PLIST_NAME_LEN];
+	char			 adv_for_plist[PLIST_NAME_LEN];
+	char			 adv_to_plist[PLIST_NAME_LEN];
+	struct label_block	 label_blocks[LABEL_APP_MAX];
 	int			 flags;
 };
 #define	F_LDPD_NO_FIB_UPDATE	0x0001
 #define	F_LDPD_DS_CISCO_INTEROP	0x0002
 #define	F_LDPD_ENABLED		0x0004
+#define	F_LDPD_MLDP_MBB		0x0008
+#define	F_LDPD_GR		0x0010
+#define	F_LDPD_ALLOC_HOST_ROUTES 0x0020
+#define	F_LDPD_ALLOC_PLIST	0x0040
+#define	F_LDPD_ALLOC_MASK	(F_LDPD_ALLOC_HOST_ROUTES|F_LDPD_ALLOC_PLIST)
+
+#define	DEFAULT_ROUTE_DELAY	50
+#define	MAX_ROUTE_DELAY		1000
 
 struct ldpd_af_global {
 	struct thread		*disc_ev;
@@ -421,7 +486,9 @@ struct ldpd_af_global {
 	int			 ldp_session_socket;
 };
 
-struct ldpd_global {//本地接口信息
+RB_HEAD(global_adj_head, adj);
+
+struct ldpd_global {
 	int			 cmd_opts;
 	time_t			 uptime;
 	struct in_addr		 rtr_id;
@@ -430,10 +497,11 @@ struct ldpd_global {//本地接口信息
 	uint32_t		 conf_seqnum;
 	int			 pfkeysock;
 	struct if_addr_head	 addr_list;
-	LIST_HEAD(, adj)	 adj_list;
+	struct global_adj_head	 adj_tree;
 	struct in_addr		 mcast_addr_v4;
 	struct in6_addr		 mcast_addr_v6;
 	TAILQ_HEAD(, pending_conn) pending_conns;
+	time_t			 gr_recovery_end;
 };
 
 /* kroute */
@@ -474,6 +542,22 @@ struct kif {
 	int			 mtu;
 };
 
+/*
+ * Label advertisement filters. Prefix-lists only exist in the parent: it
+ * marks the routes it hands lde, and lde registers the mLDP roots and
+ * neighbor lsr-ids it needs a result for.
+ */
+enum adv_filter_type {
+	ADV_FILTER_ROOT,	/* mLDP roots, "for" list */
+	ADV_FILTER_NBR		/* neighbor lsr-ids, "to" list */
+};
+
+struct adv_filter_addr {
+	int			 type;
+	struct in_addr		 addr;
+	int			 permit;
+};
+
 /* control data structures */
 struct ctl_iface {
 	int			 af;
@@ -521,12 +605,17 @@ struct ctl_nbr {
 	uint16_t		 holdtime;
 	time_t			 uptime;
 	int			 nbr_state;
+	int			 flags;
+	uint16_t		 gr_reconnect;	/* peer FT timers, seconds */
+	uint16_t		 gr_recovery;
 };
+#define F_CTL_NBR_GR		 0x01	/* graceful restart negotiated */
 
 struct ctl_rt {
 	int			 af;
 	union ldpd_addr		 prefix;
 	uint8_t			 prefixlen;
+	uint32_t		 lsp_id;	/* mLDP */
 	struct in_addr		 nexthop;	/* lsr-id */
 	uint32_t		 local_label;
 	uint32_t		 remote_label;
@@ -535,6 +624,43 @@ struct ctl_rt {
 	int			 first;
 };
 
+/* mLDP database, sent in pages of CTL_MLDP_PAGE LSPs */
+#define CTL_MLDP_PAGE		128
+
+struct ctl_mldp_key {
+	uint8_t			 type;
+	struct in_addr		 root;
+	uint16_t		 opaque_len;
+	uint8_t			 opaque[MLDP_OPAQUE_MAX_LEN];
+};
+
+struct ctl_mldp_req {
+	struct in_addr		 root;		/* INADDR_ANY for all roots */
+	int			 cont;		/* resume after last */
+	struct ctl_mldp_key	 last;
+};
+
+struct ctl_mldp_lsp {
+	struct ctl_mldp_key	 key;
+	uint32_t		 lsp_id;
+	int			 lsp_id_valid;
+	int			 role;
+	int			 joined;
+	uint32_t		 local_label;
+	time_t			 uptime;
+	int			 nbranches;
+};
+
+struct ctl_mldp_branch {
+	struct in_addr		 lsr_id;
+	uint8_t			 type;
+#define CTL_MLDP_BRANCH_UP	 0
+#define CTL_MLDP_BRANCH_DOWN	 1
+#define CTL_MLDP_BRANCH_MBB	 2		/* old upstream, switching */
+	uint32_t		 label;
+	int			 installed;
+};
+
 struct ctl_pw {
 	uint16_t		 type;
 	char			 l2vpn_name[L2VPN_NAME_LEN];
@@ -552,6 +678,14 @@ struct ctl_pw {
 	uint32_t		 status;
 };
 
+struct ctl_label_space {
+	int			 app;		/* LABEL_APP_MAX: shared range */
+	uint32_t		 min;
+	uint32_t		 max;
+	uint32_t		 used;
+	uint32_t		 avail;
+};
+
 extern struct ldpd_conf		*ldpd_conf;
 extern struct ldpd_global	 global;
 
@@ -589,6 +723,8 @@ struct sockaddr	*addr2sa(int af, union ldpd_addr *, uint16_t);
 void		 sa2addr(struct sockaddr *, int *, union ldpd_addr *,
 		    in_port_t *);
 socklen_t	 sockaddr_len(struct sockaddr *);
+int		 mldp_opaque_lspid(const uint8_t *, uint16_t, uint32_t *);
+struct lsrid_alias *lsrid_alias_find(struct ldpd_conf *, struct in_addr);
 
 /* ldpd.c */
 int			 ldp_write_handler(struct thread *);
@@ -645,6 +781,12 @@ extern struct thread_master	*master;
 
 /* ldp_zebra.c */
 void		ldp_zebra_init(struct thread_master *);
+void		ldp_zebra_gr_update(void);
+void		ldp_zebra_filter_update(void);
+void		ldp_zebra_adv_filter_update(void);
+void		ldp_zebra_adv_filter_add(struct adv_filter_addr *);
+void		ldp_zebra_adv_filter_del(struct adv_filter_addr *);
+void		ldp_zebra_ldp_sync(unsigned int, int);
 
 /* compatibility */
 #ifndef __OpenBSD__
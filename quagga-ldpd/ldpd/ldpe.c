@@ -47,6 +47,7 @@ struct ldpd_conf	*leconf;
 #ifdef __OpenBSD__
 struct ldpd_sysdep	 sysdep;
 #endif
+struct timer_wheel	*ldpe_timers;
 
 static struct imsgev	*iev_main;
 static struct imsgev	*iev_lde;
@@ -54,6 +55,12 @@ static struct imsgev	*iev_lde;
 static struct thread	*pfkey_ev;
 #endif
 
+#define LDE_BATCH_MAX	((MAX_IMSGSIZE - IMSG_HEADER_SIZE) / sizeof(struct map))
+static struct map	 lde_batch[LDE_BATCH_MAX];
+static unsigned int	 lde_batch_cnt;
+static int		 lde_batch_type;
+static uint32_t		 lde_batch_peerid;
+
 /* Master of threads. */
 struct thread_master *master;
 
@@ -111,7 +118,7 @@ ldpe(const char *user, const char *group)
 	ldpd_process = PROC_LDP_ENGINE;
 
 	LIST_INIT(&global.addr_list);
-	LIST_INIT(&global.adj_list);
+	RB_INIT(&global.adj_tree);
 	TAILQ_INIT(&global.pending_conns);
 	if (inet_pton(AF_INET, AllRouters_v4, &global.mcast_addr_v4) != 1)
 		fatal("inet_pton");
@@ -137,6 +144,8 @@ ldpe(const char *user, const char *group)
 #endif
 
   	master = thread_master_create();
+	ldpe_timers = timer_wheel_new(master, TIMER_WHEEL_SLOTS,
+	    TIMER_WHEEL_PERIOD);
 	accept_init();
 
 	/* setup signal handler */
@@ -204,7 +213,7 @@ ldpe_shutdown(void)
 		LIST_REMOVE(if_addr, entry);
 		free(if_addr);
 	}
-	while ((adj = LIST_FIRST(&global.adj_list)) != NULL)
+	while ((adj = RB_ROOT(&global.adj_tree)) != NULL)
 		adj_del(adj, S_SHUTDOWN);
 
 	log_info("ldp engine exiting");
@@ -217,6 +226,7 @@ ldpe_shutdown(void)
 	msgbuf_clear(&iev_main->ibuf.w);
 	free(iev_main);
 	free(pkt_ptr);
+	timer_wheel_free(ldpe_timers);
 
 	_exit(0);
 }
@@ -232,10 +242,42 @@ int
 ldpe_imsg_compose_lde(int type, uint32_t peerid, pid_t pid, void *data,
     uint16_t datalen)
 {
+	/* keep lde's view of the session in order */
+	ldpe_imsg_flush_lde();
+
 	return (imsg_compose_event(iev_lde, type, peerid, pid, -1,
 	    data, datalen));
 }
 
+/*
+ * Label messages are queued here and sent to lde as a single imsg carrying
+ * a vector of maps. A batch is cut when the message type or neighbor
+ * changes, when it fills an imsg, before any other imsg to lde and at the
+ * end of every session_read().
+ */
+void
+ldpe_imsg_batch_lde(int type, uint32_t peerid, struct map *map)
+{
+	if (lde_batch_cnt > 0 && (lde_batch_type != type ||
+	    lde_batch_peerid != peerid || lde_batch_cnt == LDE_BATCH_MAX))
+		ldpe_imsg_flush_lde();
+
+	lde_batch_type = type;
+	lde_batch_peerid = peerid;
+	lde_batch[lde_batch_cnt++] = *map;
+}
+
+void
+ldpe_imsg_flush_lde(void)
+{
+	if (lde_batch_cnt == 0)
+		return;
+
+	imsg_compose_event(iev_lde, lde_batch_type, lde_batch_peerid, 0, -1,
+	    lde_batch, lde_batch_cnt * sizeof(struct map));
+	lde_batch_cnt = 0;
+}
+
 /* ARGSUSED */
 static int
 ldpe_dispatch_main(struct thread *thread)
@@ -244,6 +286,7 @@ ldpe_dispatch_main(struct thread *thread)
 	struct iface		*niface;
 	struct tnbr		*ntnbr;
 	struct nbr_params	*nnbrp;
+	struct lsrid_alias	*nalias;
 	static struct l2vpn	*nl2vpn;
 	struct l2vpn_if		*nlif;
 	struct l2vpn_pw		*npw;
@@ -262,6 +305,8 @@ ldpe_dispatch_main(struct thread *thread)
 #ifdef __OpenBSD__
 	struct nbr_params	*nbrp;
 #endif
+	struct timeval		 now;
+	uint32_t		 recovery;
 	int			 n, shut = 0;
 
 	iev->ev_read = NULL;
@@ -408,6 +453,16 @@ ldpe_dispatch_main(struct thread *thread)
 			if_update_all(AF_UNSPEC);
 			tnbr_update_all(AF_UNSPEC);
 			break;
+		case IMSG_GR_RECOVERY:
+			if (imsg.hdr.len != IMSG_HEADER_SIZE +
+			    sizeof(uint32_t)) {
+				log_warnx("%s: wrong imsg len", __func__);
+				break;
+			}
+			memcpy(&recovery, imsg.data, sizeof(recovery));
+			gettimeofday(&now, NULL);
+			global.gr_recovery_end = now.tv_sec + recovery;
+			break;
 		case IMSG_RECONF_CONF:
 			if ((nconf = malloc(sizeof(struct ldpd_conf))) ==
 			    NULL)
@@ -417,6 +472,7 @@ ldpe_dispatch_main(struct thread *thread)
 			LIST_INIT(&nconf->iface_list);
 			LIST_INIT(&nconf->tnbr_list);
 			LIST_INIT(&nconf->nbrp_list);
+			RB_INIT(&nconf->alias_tree);
 			LIST_INIT(&nconf->l2vpn_list);
 			break;
 		case IMSG_RECONF_IFACE:
@@ -446,6 +502,14 @@ ldpe_dispatch_main(struct thread *thread)
 
 			LIST_INSERT_HEAD(&nconf->nbrp_list, nnbrp, entry);
 			break;
+		case IMSG_RECONF_ALIAS:
+			if ((nalias = malloc(sizeof(struct lsrid_alias))) ==
+			    NULL)
+				fatal(NULL);
+			memcpy(nalias, imsg.data, sizeof(struct lsrid_alias));
+
+			RB_INSERT(lsrid_alias_head, &nconf->alias_tree, nalias);
+			break;
 		case IMSG_RECONF_L2VPN:
 			if ((nl2vpn = malloc(sizeof(struct l2vpn))) == NULL)
 				fatal(NULL);
@@ -575,6 +639,7 @@ ldpe_dispatch_lde(struct thread *thread)
 			}
 			break;
 		case IMSG_MAPPING_ADD_END:
+		case IMSG_MAPPING_FULL_END:
 		case IMSG_RELEASE_ADD_END:
 		case IMSG_REQUEST_ADD_END:
 		case IMSG_WITHDRAW_ADD_END:
@@ -592,6 +657,12 @@ ldpe_dispatch_lde(struct thread *thread)
 				send_labelmessage(nbr, MSG_TYPE_LABELMAPPING,
 				    &nbr->mapping_list);
 				break;
+			case IMSG_MAPPING_FULL_END:
+				send_labelmessage(nbr, MSG_TYPE_LABELMAPPING,
+				    &nbr->mapping_list);
+				nbr->flags |= F_NBR_LDP_SYNC;
+				nbr_ldp_sync_update(nbr);
+				break;
 			case IMSG_RELEASE_ADD_END:
 				send_labelmessage(nbr, MSG_TYPE_LABELRELEASE,
 				    &nbr->release_list);
@@ -624,11 +695,12 @@ ldpe_dispatch_lde(struct thread *thread)
 			break;
 		case IMSG_CTL_END:
 		case IMSG_CTL_SHOW_LIB:
-		/////////////////////////////////////////////	
 		case IMSG_CTL_MLDP_LSP:	
-		//////////////////////////////////////////	
+		case IMSG_CTL_SHOW_MLDP:
+		case IMSG_CTL_SHOW_MLDP_BRANCH:
 		case IMSG_CTL_SHOW_L2VPN_PW:
 		case IMSG_CTL_SHOW_L2VPN_BINDING:
+		case IMSG_CTL_SHOW_LABELS:
 			control_imsg_relay(&imsg);
 			break;
 		default:
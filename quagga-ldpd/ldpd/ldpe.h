@@ -23,6 +23,7 @@
 
 #include "openbsd-queue.h"
 #include "openbsd-tree.h"
+#include "timerwheel.h"
 #ifdef __OpenBSD__
 #include <net/pfkeyv2.h>
 #endif
@@ -32,6 +33,13 @@
 #define min(x,y) ((x) <= (y) ? (x) : (y))
 #define max(x,y) ((x) > (y) ? (x) : (y))
 
+/* protocol timer wheel: 250ms ticks, one revolution every 256 seconds */
+#define TIMER_WHEEL_SLOTS	1024
+#define TIMER_WHEEL_PERIOD	250
+
+/* bytes written to one session per event loop turn */
+#define SESSION_WRITE_BUDGET	(4 * LDP_MAX_LEN)
+
 struct hello_source {
 	enum hello_type		 type;
 	struct {
@@ -42,23 +50,25 @@ struct hello_source {
 };
 
 struct adj {
-	LIST_ENTRY(adj)		 global_entry;
+	RB_ENTRY(adj)		 global_entry;
 	LIST_ENTRY(adj)		 nbr_entry;
 	LIST_ENTRY(adj)		 ia_entry;
 	struct in_addr		 lsr_id;
 	struct nbr		*nbr;
 	int			 ds_tlv;
 	struct hello_source	 source;
-	struct thread		*inactivity_timer;
+	struct wheel_timer	 inactivity_timer;
 	uint16_t		 holdtime;
 	union ldpd_addr		 trans_addr;
 };
+RB_PROTOTYPE(global_adj_head, adj, global_entry, adj_compare)
 
 struct tcp_conn {
 	struct nbr		*nbr;
 	int			 fd;
 	struct ibuf_read	*rbuf;
 	struct evbuf		 wbuf;
+	struct ibuf		*lbuf;		/* queued label pdu, appendable */
 	struct thread		*rev;
 	in_port_t		 lport;
 	in_port_t		 rport;
@@ -69,10 +79,10 @@ struct nbr {
 	struct tcp_conn		*tcp;
 	LIST_HEAD(, adj)	 adj_list;	/* adjacencies */
 	struct thread		*ev_connect;
-	struct thread		*keepalive_timer;
-	struct thread		*keepalive_timeout;
-	struct thread		*init_timeout;
-	struct thread		*initdelay_timer;
+	struct wheel_timer	 keepalive_timer;
+	struct wheel_timer	 keepalive_timeout;
+	struct wheel_timer	 init_timeout;
+	struct wheel_timer	 initdelay_timer;
 
 	struct mapping_head	 mapping_list;
 	struct mapping_head	 withdraw_list;
@@ -105,8 +115,12 @@ struct nbr {
 		char			md5key[TCP_MD5_KEY_LEN];
 	} auth;
 	int			 flags;
+	uint16_t		 gr_reconnect;	/* peer FT timers, seconds */
+	uint16_t		 gr_recovery;
 };
 #define F_NBR_GTSM_NEGOTIATED	 0x01
+#define F_NBR_GR_NEGOTIATED	 0x02
+#define F_NBR_LDP_SYNC		 0x04
 
 RB_HEAD(nbr_id_head, nbr);
 RB_PROTOTYPE(nbr_id_head, nbr, id_tree, nbr_id_compare)
@@ -139,6 +153,7 @@ extern struct ldpd_sysdep	 sysdep;
 extern struct nbr_id_head	 nbrs_by_id;
 extern struct nbr_addr_head	 nbrs_by_addr;
 extern struct nbr_pid_head	 nbrs_by_pid;
+extern struct timer_wheel	*ldpe_timers;
 
 /* accept.c */
 void	accept_init(void);
@@ -187,6 +202,8 @@ int		 ldpe_imsg_compose_parent(int, pid_t, void *,
 		    uint16_t);
 int		 ldpe_imsg_compose_lde(int, uint32_t, pid_t, void *,
 		    uint16_t);
+void		 ldpe_imsg_batch_lde(int, uint32_t, struct map *);
+void		 ldpe_imsg_flush_lde(void);
 void		 ldpe_reset_nbrs(int);
 void		 ldpe_reset_ds_nbrs(void);
 void		 ldpe_remove_dynamic_tnbrs(int);
@@ -209,6 +226,7 @@ void		 if_addr_add(struct kaddr *);
 void		 if_addr_del(struct kaddr *);
 void		 if_update(struct iface *, int);
 void		 if_update_all(int);
+void		 if_ldp_sync_update(struct iface *);
 uint16_t	 if_get_hello_holdtime(struct iface_af *);
 uint16_t	 if_get_hello_interval(struct iface_af *);
 struct ctl_iface *if_to_ctl(struct iface_af *);
@@ -218,7 +236,7 @@ in_addr_t	 if_get_ipv4_addr(struct iface *);
 struct adj	*adj_new(struct in_addr, struct hello_source *,
 		    union ldpd_addr *);
 void		 adj_del(struct adj *, uint32_t);
-struct adj	*adj_find(struct hello_source *);
+struct adj	*adj_find(struct in_addr, struct hello_source *);
 int		 adj_get_af(struct adj *adj);
 void		 adj_start_itimer(struct adj *);
 void		 adj_stop_itimer(struct adj *);
@@ -240,6 +258,7 @@ struct nbr		*nbr_find_ldpid(uint32_t);
 struct nbr		*nbr_find_addr(int, union ldpd_addr *);
 struct nbr		*nbr_find_peerid(uint32_t);
 int			 nbr_adj_count(struct nbr *, int);
+void			 nbr_ldp_sync_update(struct nbr *);
 int			 nbr_session_active_role(struct nbr *);
 void			 nbr_stop_ktimer(struct nbr *);
 void			 nbr_stop_ktimeout(struct nbr *);
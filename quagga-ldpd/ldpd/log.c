@@ -313,6 +313,22 @@ log_hello_src(const struct hello_source *src)
 	return (buf);
 }
 
+static const char *
+log_mldp(struct in_addr root, const uint8_t *opaque, uint16_t len)
+{
+	static char	buf[48];
+	uint32_t	lsp_id;
+
+	if (mldp_opaque_lspid(opaque, len, &lsp_id) == 0)
+		snprintf(buf, sizeof(buf), "root %s lsp-id %u",
+		    inet_ntoa(root), lsp_id);
+	else
+		snprintf(buf, sizeof(buf), "root %s opaque %u bytes",
+		    inet_ntoa(root), len);
+
+	return (buf);
+}
+
 const char *
 log_map(const struct map *map)
 {
@@ -347,6 +363,16 @@ log_map(const struct map *map)
 		    pw_type_name(map->fec.pwid.type)) == -1)
 			return ("???");
 		break;
+	case MAP_TYPE_P2MP:
+	case MAP_TYPE_MP2MP_UP:
+	case MAP_TYPE_MP2MP_DOWN:
+		if (snprintf(buf, sizeof(buf), "%s %s",
+		    map->type == MAP_TYPE_P2MP ? "p2mp" :
+		    map->type == MAP_TYPE_MP2MP_UP ? "mp2mp-up" : "mp2mp-down",
+		    log_mldp(map->fec.mldp.root, map->fec.mldp.opaque,
+		    map->fec.mldp.opaque_len)) == -1)
+			return ("???");
+		break;
 	default:
 		return ("???");
 	}
@@ -357,8 +383,10 @@ log_map(const struct map *map)
 const char *
 log_fec(const struct fec *fec)
 {
-	static char	buf[64];
-	union ldpd_addr	addr;
+	static char	 buf[64];
+	union ldpd_addr	 addr;
+	const uint8_t	*opaque;
+	uint16_t	 opaque_len;
 
 	switch (fec->type) {
 	case FEC_TYPE_IPV4:
@@ -380,6 +408,13 @@ log_fec(const struct fec *fec)
 		    inet_ntoa(fec->u.pwid.lsr_id)) == -1)
 			return ("???");
 		break;
+	case FEC_TYPE_MLDP:
+		opaque = mldp_opaque_data(fec->u.mldp.opaque, &opaque_len);
+		if (snprintf(buf, sizeof(buf), "%s %s",
+		    fec->u.mldp.type == MLDP_TYPE_P2MP ? "p2mp" : "mp2mp",
+		    log_mldp(fec->u.mldp.root, opaque, opaque_len)) == -1)
+			return ("???");
+		break;
 	default:
 		return ("???");
 	}
@@ -597,3 +632,22 @@ pw_type_name(uint16_t pw_type)
 		return (buf);
 	}
 }
+
+const char *
+label_app_name(int app)
+{
+	switch (app) {
+	case LABEL_APP_IPV4:
+		return ("ipv4");
+	case LABEL_APP_IPV6:
+		return ("ipv6");
+	case LABEL_APP_PW:
+		return ("pseudowire");
+	case LABEL_APP_MLDP:
+		return ("mldp");
+	case LABEL_APP_MAX:
+		return ("shared");
+	default:
+		return ("UNKNOWN");
+	}
+}
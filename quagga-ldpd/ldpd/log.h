@@ -51,5 +51,6 @@ const char	*if_type_name(enum iface_type);
 const char	*msg_name(uint16_t);
 const char	*status_code_name(uint32_t);
 const char	*pw_type_name(uint16_t);
+const char	*label_app_name(int);
 
 #endif /* _LOG_H_ */
@@ -0,0 +1,1320 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <zebra.h>
+
+#include "ldpd.h"
+#include "lde.h"
+#include "log.h"
+#include "ldp_debug.h"
+
+/*
+ * Opaque values are kept once and FECs refer to them by id, so struct fec
+ * doesn't need room for the largest one.  Every stored mLDP FEC holds a
+ * reference, see mldp_fec_ref().
+ */
+struct mldp_opaque {
+	RB_ENTRY(mldp_opaque)	 entry;
+	uint32_t		 id;
+	int			 refcnt;
+	uint16_t		 len;
+	uint8_t			 data[MLDP_OPAQUE_MAX_LEN];
+};
+RB_HEAD(mldp_opaque_tree, mldp_opaque);
+RB_PROTOTYPE(mldp_opaque_tree, mldp_opaque, entry, mldp_opaque_compare)
+
+static __inline int	 mldp_lsp_compare(struct mldp_lsp *,
+			    struct mldp_lsp *);
+static __inline int	 label_nbr_compare(struct label_nbr *,
+			    struct label_nbr *);
+static __inline int	 mldp_root_compare(struct mldp_root *,
+			    struct mldp_root *);
+static __inline int	 mldp_opaque_compare(struct mldp_opaque *,
+			    struct mldp_opaque *);
+static struct mldp_lsp	*mldp_lsp_new(struct fec *);
+static void		 mldp_lsp_del(struct mldp_lsp *);
+static struct label_nbr	*label_nbr_add(struct mldp_lsp *, struct lde_nbr *,
+			    enum stream_type, uint32_t);
+static struct label_nbr	*label_nbr_find(struct mldp_lsp *, uint32_t,
+			    enum stream_type);
+static enum stream_type	 label_nbr_stream(struct map *);
+static void		 label_nbr_del(struct label_nbr *);
+static void		 label_nbr_set(struct label_nbr *, uint32_t);
+static int		 label_nbr_nexthop(struct label_nbr *,
+			    union ldpd_addr *);
+static void		 label_nbr_install(struct label_nbr *);
+static void		 label_nbr_uninstall(struct label_nbr *);
+static struct mldp_root	*mldp_root_get(struct in_addr);
+static void		 mldp_root_put(struct mldp_root *);
+static void		 mldp_root_resolve(struct mldp_root *);
+static void		 mldp_root_resignal(struct mldp_root *);
+static int		 mldp_root_event(struct thread *);
+static struct fec_node	*mldp_root_route(struct in_addr);
+static struct lde_nbr	*mldp_upstream_nbr(struct fec_node *);
+static int		 mldp_is_root(struct fec_node *);
+static void		 mldp_send_mapping(struct lde_nbr *, struct mldp_lsp *);
+static int		 mldp_adv_branch(struct label_nbr *);
+static void		 mldp_adv_lsp_update(struct mldp_lsp *);
+static void		 mldp_adv_branch_update(struct label_nbr *);
+static void		 mldp_flush_nbr(struct lde_nbr *);
+static int		 mldp_flush(struct thread *);
+static void		 mldp_send_upstream(struct mldp_lsp *);
+static void		 mldp_release_upstream(struct mldp_lsp *,
+			    struct label_nbr *);
+static void		 mldp_mbb_start(struct mldp_lsp *);
+static void		 mldp_mbb_finish(struct mldp_lsp *);
+static int		 mldp_mbb_timer(struct thread *);
+static void		 mldp_lsp_role(struct mldp_lsp *);
+static void		 mldp_lsp_prune(struct mldp_lsp *);
+static void		 mldp_recv_mapping(struct map *, struct fec *,
+			    struct lde_nbr *);
+static void		 mldp_recv_withdraw(struct map *, struct fec *,
+			    struct lde_nbr *);
+static void		 mldp_recv_release(struct map *, struct fec *,
+			    struct lde_nbr *);
+static void		 mldp_rt_dump_branch(pid_t, struct ctl_rt *,
+			    struct label_nbr *);
+static void		 mldp_ctl_branch(pid_t, struct label_nbr *, uint8_t);
+
+RB_GENERATE(mldp_lsp_tree, mldp_lsp, entry, mldp_lsp_compare)
+RB_GENERATE(label_nbr_tree, label_nbr, entry, label_nbr_compare)
+RB_GENERATE(mldp_root_tree, mldp_root, entry, mldp_root_compare)
+RB_GENERATE(mldp_opaque_tree, mldp_opaque, entry, mldp_opaque_compare)
+
+struct mldp_lsp_tree	 mldp_lsps = RB_INITIALIZER(&mldp_lsps);
+static struct mldp_root_tree mldp_roots = RB_INITIALIZER(&mldp_roots);
+static struct thread	*mldp_root_ev;
+static LIST_HEAD(, lde_nbr) mldp_flush_list =
+    LIST_HEAD_INITIALIZER(mldp_flush_list);
+static struct thread	*mldp_flush_ev;
+/* whether roots are registered with the parent for the "for" list */
+static int		 adv_root_registered;
+static struct mldp_opaque_tree mldp_opaques = RB_INITIALIZER(&mldp_opaques);
+/* by id, ids of released values are reused from a free stack */
+static struct mldp_opaque **mldp_opaque_ids;
+static uint32_t		*mldp_opaque_free;
+static uint32_t		 mldp_opaque_nids, mldp_opaque_nfree;
+
+/* by value, so the database is listed in a stable order */
+static __inline int
+mldp_lsp_compare(struct mldp_lsp *a, struct mldp_lsp *b)
+{
+	struct fec		*fa = &a->fn.fec, *fb = &b->fn.fec;
+	struct mldp_opaque	*oa, *ob;
+
+	if (ntohl(fa->u.mldp.root.s_addr) < ntohl(fb->u.mldp.root.s_addr))
+		return (-1);
+	if (ntohl(fa->u.mldp.root.s_addr) > ntohl(fb->u.mldp.root.s_addr))
+		return (1);
+	if (fa->u.mldp.type < fb->u.mldp.type)
+		return (-1);
+	if (fa->u.mldp.type > fb->u.mldp.type)
+		return (1);
+	if (fa->u.mldp.opaque == fb->u.mldp.opaque)
+		return (0);
+	/* lookup keys without an opaque value sort first */
+	if (fa->u.mldp.opaque == 0)
+		return (-1);
+	if (fb->u.mldp.opaque == 0)
+		return (1);
+	oa = mldp_opaque_ids[fa->u.mldp.opaque];
+	ob = mldp_opaque_ids[fb->u.mldp.opaque];
+	return (mldp_opaque_compare(oa, ob));
+}
+
+static __inline int
+label_nbr_compare(struct label_nbr *a, struct label_nbr *b)
+{
+	if (a->peerid < b->peerid)
+		return (-1);
+	if (a->peerid > b->peerid)
+		return (1);
+	if (a->type < b->type)
+		return (-1);
+	if (a->type > b->type)
+		return (1);
+	return (0);
+}
+
+static __inline int
+mldp_root_compare(struct mldp_root *a, struct mldp_root *b)
+{
+	if (ntohl(a->addr.s_addr) < ntohl(b->addr.s_addr))
+		return (-1);
+	if (ntohl(a->addr.s_addr) > ntohl(b->addr.s_addr))
+		return (1);
+	return (0);
+}
+
+static __inline int
+mldp_opaque_compare(struct mldp_opaque *a, struct mldp_opaque *b)
+{
+	if (a->len < b->len)
+		return (-1);
+	if (a->len > b->len)
+		return (1);
+	return (memcmp(a->data, b->data, a->len));
+}
+
+/* opaque values */
+
+/* look up or add a value, the caller owns a reference on the id */
+uint32_t
+mldp_opaque_get(const uint8_t *data, uint16_t len)
+{
+	struct mldp_opaque	*o, key;
+
+	if (len > MLDP_OPAQUE_MAX_LEN)
+		fatalx("mldp_opaque_get: opaque value too long");
+
+	key.len = len;
+	memcpy(key.data, data, len);
+	if ((o = RB_FIND(mldp_opaque_tree, &mldp_opaques, &key)) != NULL) {
+		o->refcnt++;
+		return (o->id);
+	}
+
+	if ((o = calloc(1, sizeof(*o))) == NULL)
+		fatal(__func__);
+	o->refcnt = 1;
+	o->len = len;
+	memcpy(o->data, data, len);
+
+	/* id 0 is never handed out */
+	if (mldp_opaque_nfree > 0)
+		o->id = mldp_opaque_free[--mldp_opaque_nfree];
+	else {
+		if (mldp_opaque_nids == 0)
+			mldp_opaque_nids = 1;
+		o->id = mldp_opaque_nids++;
+		mldp_opaque_ids = reallocarray(mldp_opaque_ids,
+		    mldp_opaque_nids, sizeof(*mldp_opaque_ids));
+		mldp_opaque_free = reallocarray(mldp_opaque_free,
+		    mldp_opaque_nids, sizeof(*mldp_opaque_free));
+		if (mldp_opaque_ids == NULL || mldp_opaque_free == NULL)
+			fatal(__func__);
+	}
+	mldp_opaque_ids[o->id] = o;
+
+	if (RB_INSERT(mldp_opaque_tree, &mldp_opaques, o) != NULL)
+		fatalx("mldp_opaque_get: RB_INSERT failed");
+
+	return (o->id);
+}
+
+static void
+mldp_opaque_put(uint32_t id)
+{
+	struct mldp_opaque	*o = mldp_opaque_ids[id];
+
+	if (--o->refcnt > 0)
+		return;
+
+	RB_REMOVE(mldp_opaque_tree, &mldp_opaques, o);
+	mldp_opaque_ids[id] = NULL;
+	mldp_opaque_free[mldp_opaque_nfree++] = id;
+	free(o);
+}
+
+const uint8_t *
+mldp_opaque_data(uint32_t id, uint16_t *len)
+{
+	struct mldp_opaque	*o = mldp_opaque_ids[id];
+
+	*len = o->len;
+	return (o->data);
+}
+
+/* a copy of an mLDP FEC is being stored */
+void
+mldp_fec_ref(struct fec *fec)
+{
+	if (fec->type == FEC_TYPE_MLDP)
+		mldp_opaque_ids[fec->u.mldp.opaque]->refcnt++;
+}
+
+void
+mldp_fec_unref(struct fec *fec)
+{
+	if (fec->type == FEC_TYPE_MLDP)
+		mldp_opaque_put(fec->u.mldp.opaque);
+}
+
+/* LSP database */
+
+struct mldp_lsp *
+mldp_lsp_find(struct fec *fec)
+{
+	struct mldp_lsp	 lsp;
+
+	lsp.fn.fec = *fec;
+	return (RB_FIND(mldp_lsp_tree, &mldp_lsps, &lsp));
+}
+
+static struct mldp_lsp *
+mldp_lsp_new(struct fec *fec)
+{
+	struct mldp_lsp	*lsp;
+	struct timeval	 now;
+
+	if ((lsp = calloc(1, sizeof(*lsp))) == NULL)
+		fatal(__func__);
+
+	gettimeofday(&now, NULL);
+	lsp->uptime = now.tv_sec;
+	lsp->fn.fec = *fec;
+	mldp_fec_ref(&lsp->fn.fec);
+	lsp->fn.local_label = lde_assign_label(LABEL_APP_MLDP);
+	lsp->fn.data = lsp;
+	LIST_INIT(&lsp->fn.nexthops);
+	LIST_INIT(&lsp->fn.downstream);
+	LIST_INIT(&lsp->fn.upstream);
+	RB_INIT(&lsp->downstream);
+	lsp->root = mldp_root_get(fec->u.mldp.root);
+	LIST_INSERT_HEAD(&lsp->root->lsps, lsp, root_entry);
+	mldp_lsp_role(lsp);
+
+	if (RB_INSERT(mldp_lsp_tree, &mldp_lsps, lsp) != NULL)
+		fatalx("mldp_lsp_new: RB_INSERT failed");
+
+	return (lsp);
+}
+
+static void
+mldp_lsp_del(struct mldp_lsp *lsp)
+{
+	struct label_nbr	*lnr;
+	struct lde_map		*me;
+
+	if (lsp->upstream)
+		label_nbr_del(lsp->upstream);
+	if (lsp->mbb_upstream)
+		label_nbr_del(lsp->mbb_upstream);
+	THREAD_TIMER_OFF(lsp->mbb_timer);
+	while ((lnr = RB_ROOT(&lsp->downstream)) != NULL)
+		label_nbr_del(lnr);
+
+	/* the sent mappings point back into this LSP */
+	while ((me = LIST_FIRST(&lsp->fn.upstream)) != NULL)
+		lde_map_del(me->nexthop, me, 1);
+
+	LIST_REMOVE(lsp, root_entry);
+	mldp_root_put(lsp->root);
+
+	RB_REMOVE(mldp_lsp_tree, &mldp_lsps, lsp);
+	lde_free_label(lsp->fn.local_label);
+	mldp_fec_unref(&lsp->fn.fec);
+	free(lsp);
+}
+
+/*
+ * Build an mLDP FEC with a generic LSP identifier as opaque value, drop
+ * it with mldp_fec_unref().
+ */
+void
+mldp_fec(struct fec *fec, uint8_t type, struct in_addr root, uint32_t lsp_id)
+{
+	uint8_t		 opaque[1 + sizeof(uint16_t) + sizeof(uint32_t)];
+	uint8_t		*p = opaque;
+	uint16_t	 len;
+	uint32_t	 id;
+
+	memset(fec, 0, sizeof(*fec));
+	fec->type = FEC_TYPE_MLDP;
+	fec->u.mldp.type = type;
+	fec->u.mldp.root = root;
+
+	len = htons(MLDP_OPAQUE_GENERIC_LSPID_LEN);
+	id = htonl(lsp_id);
+	*p++ = MLDP_OPAQUE_GENERIC_LSPID;
+	memcpy(p, &len, sizeof(len));
+	p += sizeof(len);
+	memcpy(p, &id, sizeof(id));
+	fec->u.mldp.opaque = mldp_opaque_get(opaque, sizeof(opaque));
+}
+
+/*
+ * RFC 6388 FEC element type to use towards a neighbor. For MP2MP the
+ * mapping sent upstream is the MP2MP downstream one and vice versa,
+ * releases carry the type of the mapping they answer.
+ */
+uint8_t
+mldp_map_type(struct fec_node *fn, struct lde_nbr *ln, int release)
+{
+	struct mldp_lsp	*lsp = fn->data;
+	int		 up;
+
+	if (fn->fec.u.mldp.type == MLDP_TYPE_P2MP)
+		return (MAP_TYPE_P2MP);
+
+	up = (lsp && ((lsp->upstream && lsp->upstream->peerid == ln->peerid) ||
+	    (lsp->mbb_upstream && lsp->mbb_upstream->peerid == ln->peerid)));
+	return ((up != release) ? MAP_TYPE_MP2MP_DOWN : MAP_TYPE_MP2MP_UP);
+}
+
+void
+mldp_lsp_clear(void)
+{
+	struct mldp_lsp	*lsp;
+
+	while ((lsp = RB_ROOT(&mldp_lsps)) != NULL)
+		mldp_lsp_del(lsp);
+	THREAD_OFF(mldp_root_ev);
+	THREAD_OFF(mldp_flush_ev);
+}
+
+/* branches */
+
+static struct label_nbr *
+label_nbr_add(struct mldp_lsp *lsp, struct lde_nbr *ln, enum stream_type type,
+    uint32_t label)
+{
+	struct label_nbr	*lnr;
+
+	if ((lnr = calloc(1, sizeof(*lnr))) == NULL)
+		fatal(__func__);
+
+	lnr->lsp = lsp;
+	lnr->peerid = ln->peerid;
+	lnr->type = type;
+	lnr->label = label;
+
+	switch (type) {
+	case STREAM_TYPE_UP:
+		/* let the old upstream know it no longer feeds this tree */
+		if (lsp->upstream)
+			mldp_release_upstream(lsp, lsp->upstream);
+		lsp->upstream = lnr;
+		break;
+	case STREAM_TYPE_DOWN:
+		if (RB_INSERT(label_nbr_tree, &lsp->downstream, lnr) != NULL)
+			fatalx("label_nbr_add: RB_INSERT failed");
+		break;
+	}
+	LIST_INSERT_HEAD(&ln->label_nbrs, lnr, nbr_entry);
+	label_nbr_install(lnr);
+
+	return (lnr);
+}
+
+/* a neighbor can be upstream and downstream of the same LSP */
+static struct label_nbr *
+label_nbr_find(struct mldp_lsp *lsp, uint32_t peerid, enum stream_type type)
+{
+	struct label_nbr	 lnr;
+
+	if (type == STREAM_TYPE_UP) {
+		if (lsp->upstream && lsp->upstream->peerid == peerid)
+			return (lsp->upstream);
+		if (lsp->mbb_upstream && lsp->mbb_upstream->peerid == peerid)
+			return (lsp->mbb_upstream);
+		return (NULL);
+	}
+
+	lnr.peerid = peerid;
+	lnr.type = type;
+	return (RB_FIND(label_nbr_tree, &lsp->downstream, &lnr));
+}
+
+/* only MP2MP upstream mappings come from the upstream LSR */
+static enum stream_type
+label_nbr_stream(struct map *map)
+{
+	if (map->type == MAP_TYPE_MP2MP_UP)
+		return (STREAM_TYPE_UP);
+	return (STREAM_TYPE_DOWN);
+}
+
+static void
+label_nbr_del(struct label_nbr *lnr)
+{
+	struct mldp_lsp		*lsp = lnr->lsp;
+
+	label_nbr_uninstall(lnr);
+	switch (lnr->type) {
+	case STREAM_TYPE_UP:
+		if (lsp->upstream == lnr)
+			lsp->upstream = NULL;
+		else
+			lsp->mbb_upstream = NULL;
+		break;
+	case STREAM_TYPE_DOWN:
+		RB_REMOVE(label_nbr_tree, &lsp->downstream, lnr);
+		break;
+	}
+	LIST_REMOVE(lnr, nbr_entry);
+	free(lnr);
+}
+
+static void
+label_nbr_set(struct label_nbr *lnr, uint32_t label)
+{
+	if (lnr->label == label && lnr->installed)
+		return;
+
+	label_nbr_uninstall(lnr);
+	lnr->label = label;
+	label_nbr_install(lnr);
+}
+
+/* pick the nexthop of the route to the neighbor that belongs to it */
+static int
+label_nbr_nexthop(struct label_nbr *lnr, union ldpd_addr *nexthop)
+{
+	struct lde_nbr	*ln;
+	struct fec_node	*fn;
+	struct fec_nh	*fnh;
+
+	if ((ln = lde_nbr_find(lnr->peerid)) == NULL ||
+	    (fn = mldp_root_route(ln->id)) == NULL)
+		return (-1);
+
+	LIST_FOREACH(fnh, &fn->nexthops, entry) {
+		if (fnh->af != AF_INET)
+			continue;
+		if (lde_address_find(ln, fnh->af, &fnh->nexthop)) {
+			*nexthop = fnh->nexthop;
+			return (0);
+		}
+	}
+
+	return (-1);
+}
+
+/*
+ * Every labeled branch is one NHLFE of the ILM entry for the local label,
+ * zebra adds and removes them one at a time as the tree changes.
+ */
+static void
+label_nbr_install(struct label_nbr *lnr)
+{
+	struct mldp_lsp	*lsp = lnr->lsp;
+	struct kroute	 kr;
+
+	if (lnr->installed || lnr->label == NO_LABEL ||
+	    lsp->fn.local_label == NO_LABEL)
+		return;
+	if (label_nbr_nexthop(lnr, &lnr->nexthop) == -1) {
+		debug_mldp("%s: no nexthop for branch %s of %s", __func__,
+		    log_label(lnr->label), log_fec(&lsp->fn.fec));
+		return;
+	}
+
+	memset(&kr, 0, sizeof(kr));
+	kr.af = AF_INET;
+	kr.prefix.v4 = lsp->fn.fec.u.mldp.root;
+	kr.prefixlen = 32;
+	kr.nexthop = lnr->nexthop;
+	kr.local_label = lsp->fn.local_label;
+	kr.remote_label = lnr->label;
+	kr.flags = F_MLDP;
+	lde_imsg_compose_parent(IMSG_KLABEL_CHANGE, 0, &kr, sizeof(kr));
+	lnr->installed = 1;
+}
+
+static void
+label_nbr_uninstall(struct label_nbr *lnr)
+{
+	struct mldp_lsp	*lsp = lnr->lsp;
+	struct kroute	 kr;
+
+	if (!lnr->installed)
+		return;
+
+	memset(&kr, 0, sizeof(kr));
+	kr.af = AF_INET;
+	kr.prefix.v4 = lsp->fn.fec.u.mldp.root;
+	kr.prefixlen = 32;
+	kr.nexthop = lnr->nexthop;
+	kr.local_label = lsp->fn.local_label;
+	kr.remote_label = lnr->label;
+	kr.flags = F_MLDP;
+	lde_imsg_compose_parent(IMSG_KLABEL_DELETE, 0, &kr, sizeof(kr));
+	lnr->installed = 0;
+}
+
+/* root resolution cache */
+
+static struct mldp_root *
+mldp_root_get(struct in_addr addr)
+{
+	struct mldp_root	 key, *r;
+
+	key.addr = addr;
+	if ((r = RB_FIND(mldp_root_tree, &mldp_roots, &key)) != NULL)
+		return (r);
+
+	if ((r = calloc(1, sizeof(*r))) == NULL)
+		fatal(__func__);
+	r->addr = addr;
+	LIST_INIT(&r->lsps);
+	mldp_root_resolve(r);
+
+	/* nothing goes out until the "for" list permits it */
+	r->adv_permit = 1;
+	if (adv_root_registered) {
+		r->adv_permit = 0;
+		lde_adv_filter_register(IMSG_ADV_FILTER_ADD, ADV_FILTER_ROOT,
+		    addr);
+	}
+
+	if (RB_INSERT(mldp_root_tree, &mldp_roots, r) != NULL)
+		fatalx("mldp_root_get: RB_INSERT failed");
+
+	return (r);
+}
+
+static void
+mldp_root_put(struct mldp_root *r)
+{
+	if (!LIST_EMPTY(&r->lsps))
+		return;
+
+	if (adv_root_registered)
+		lde_adv_filter_register(IMSG_ADV_FILTER_DEL, ADV_FILTER_ROOT,
+		    r->addr);
+	RB_REMOVE(mldp_root_tree, &mldp_roots, r);
+	free(r);
+}
+
+static void
+mldp_root_resolve(struct mldp_root *r)
+{
+	struct fec_node	*fn;
+
+	r->local = 0;
+	r->upstream = NULL;
+
+	fn = mldp_root_route(r->addr);
+	if (fn == NULL)
+		return;
+	if (mldp_is_root(fn))
+		r->local = 1;
+	else
+		r->upstream = mldp_upstream_nbr(fn);
+}
+
+/* move all LSPs of a root to its new upstream at once */
+static void
+mldp_root_resignal(struct mldp_root *r)
+{
+	struct mldp_lsp	*lsp;
+
+	LIST_FOREACH(lsp, &r->lsps, root_entry) {
+		mldp_lsp_role(lsp);
+
+		/* back to the upstream we were switching away from */
+		if (lsp->mbb_upstream && r->upstream &&
+		    lsp->mbb_upstream->peerid == r->upstream->peerid) {
+			THREAD_TIMER_OFF(lsp->mbb_timer);
+			if (lsp->upstream)
+				mldp_release_upstream(lsp, lsp->upstream);
+			lsp->upstream = lsp->mbb_upstream;
+			lsp->mbb_upstream = NULL;
+		}
+
+		if (lsp->upstream && (r->upstream == NULL ||
+		    lsp->upstream->peerid != r->upstream->peerid)) {
+			if ((ldeconf->flags & F_LDPD_MLDP_MBB) &&
+			    r->upstream && lsp->role != MLDP_ROLE_ROOT)
+				mldp_mbb_start(lsp);
+			else
+				mldp_release_upstream(lsp, lsp->upstream);
+		}
+		if (r->upstream == NULL || lsp->role == MLDP_ROLE_ROOT)
+			mldp_mbb_finish(lsp);
+
+		if (lsp->role != MLDP_ROLE_ROOT && lsp->upstream == NULL &&
+		    ((lsp->flags & F_MLDP_JOINED) ||
+		    !RB_EMPTY(&lsp->downstream)))
+			mldp_send_upstream(lsp);
+	}
+}
+
+/* FIB nexthops of a root changed */
+void
+mldp_root_update(struct in_addr addr)
+{
+	struct mldp_root	 key, *r;
+	struct lde_nbr		*upstream;
+	int			 local;
+
+	key.addr = addr;
+	if ((r = RB_FIND(mldp_root_tree, &mldp_roots, &key)) == NULL)
+		return;
+
+	local = r->local;
+	upstream = r->upstream;
+	mldp_root_resolve(r);
+	if (r->local != local || r->upstream != upstream) {
+		debug_mldp("root %s: upstream %s%s",
+		    log_addr(AF_INET, (union ldpd_addr *)&r->addr),
+		    r->upstream ? log_addr(AF_INET,
+		    (union ldpd_addr *)&r->upstream->id) : "none",
+		    r->local ? " (local)" : "");
+		mldp_root_resignal(r);
+	}
+}
+
+/* ARGSUSED */
+static int
+mldp_root_event(struct thread *thread)
+{
+	struct mldp_root	*r, *safe;
+
+	mldp_root_ev = NULL;
+
+	RB_FOREACH_SAFE(r, mldp_root_tree, &mldp_roots, safe)
+		mldp_root_update(r->addr);
+
+	return (0);
+}
+
+/* neighbor addresses changed, re-resolve every root once */
+void
+mldp_root_update_all(void)
+{
+	if (mldp_root_ev == NULL)
+		mldp_root_ev = thread_add_event(master, mldp_root_event,
+		    NULL, 0);
+}
+
+/* label advertisement filters */
+
+/* the "for" prefix-list was set or removed */
+void
+mldp_adv_filter_config(int registered)
+{
+	struct mldp_root	*r;
+	struct mldp_lsp		*lsp;
+
+	if (registered == adv_root_registered)
+		return;
+	adv_root_registered = registered;
+
+	RB_FOREACH(r, mldp_root_tree, &mldp_roots) {
+		lde_adv_filter_register(registered ? IMSG_ADV_FILTER_ADD :
+		    IMSG_ADV_FILTER_DEL, ADV_FILTER_ROOT, r->addr);
+		/* keep advertising until the parent says otherwise */
+		if (!registered && !r->adv_permit) {
+			r->adv_permit = 1;
+			LIST_FOREACH(lsp, &r->lsps, root_entry)
+				mldp_adv_lsp_update(lsp);
+		}
+	}
+}
+
+/* only the LSPs of a root that changed sides of the list are re-checked */
+void
+mldp_adv_filter_result(struct in_addr addr, int permit)
+{
+	struct mldp_root	 key, *r;
+	struct mldp_lsp		*lsp;
+
+	if (!adv_root_registered)
+		return;
+
+	key.addr = addr;
+	r = RB_FIND(mldp_root_tree, &mldp_roots, &key);
+	if (r == NULL || r->adv_permit == permit)
+		return;
+
+	r->adv_permit = permit;
+	LIST_FOREACH(lsp, &r->lsps, root_entry)
+		mldp_adv_lsp_update(lsp);
+}
+
+int
+mldp_adv_permitted(struct fec_node *fn)
+{
+	struct mldp_lsp		*lsp;
+
+	if (!adv_root_registered)
+		return (1);
+
+	lsp = mldp_lsp_find(&fn->fec);
+	return (lsp == NULL || lsp->root->adv_permit);
+}
+
+/* a neighbor changed sides of the "to" list */
+void
+mldp_adv_nbr_update(struct lde_nbr *ln)
+{
+	struct label_nbr	*lnr;
+
+	LIST_FOREACH(lnr, &ln->label_nbrs, nbr_entry)
+		if (mldp_adv_branch(lnr))
+			mldp_adv_branch_update(lnr);
+}
+
+/* the branches we send a mapping on */
+static int
+mldp_adv_branch(struct label_nbr *lnr)
+{
+	struct mldp_lsp		*lsp = lnr->lsp;
+
+	if (lnr == lsp->upstream)
+		return (1);
+
+	/* only MP2MP downstream branches get a label from us */
+	return (lnr->type == STREAM_TYPE_DOWN &&
+	    lsp->fn.fec.u.mldp.type == MLDP_TYPE_MP2MP &&
+	    (lsp->role == MLDP_ROLE_ROOT || lsp->upstream != NULL));
+}
+
+static void
+mldp_adv_lsp_update(struct mldp_lsp *lsp)
+{
+	struct label_nbr	*lnr;
+
+	if (lsp->upstream)
+		mldp_adv_branch_update(lsp->upstream);
+	RB_FOREACH(lnr, label_nbr_tree, &lsp->downstream)
+		if (mldp_adv_branch(lnr))
+			mldp_adv_branch_update(lnr);
+}
+
+static void
+mldp_adv_branch_update(struct label_nbr *lnr)
+{
+	struct mldp_lsp		*lsp = lnr->lsp;
+	struct lde_nbr		*ln;
+	struct lde_map		*me;
+	struct lde_wdraw	*lw;
+
+	if ((ln = lde_nbr_find(lnr->peerid)) == NULL)
+		return;
+
+	me = (struct lde_map *)fec_find(&ln->sent_map, &lsp->fn.fec);
+	lw = (struct lde_wdraw *)fec_find(&ln->sent_wdraw, &lsp->fn.fec);
+	if (lde_adv_permitted(ln, &lsp->fn)) {
+		if (me == NULL || lw)
+			mldp_send_mapping(ln, lsp);
+	} else if (me && lw == NULL) {
+		mldp_flush_nbr(ln);
+		lde_send_labelwithdraw(ln, &lsp->fn, NO_LABEL, NULL);
+	}
+}
+
+/* route towards the root */
+
+static struct fec_node *
+mldp_root_route(struct in_addr root)
+{
+	struct fec	 fec, *f;
+	struct fec_node	*fn;
+
+	/* the lowest prefixlen for this address sorts first */
+	memset(&fec, 0, sizeof(fec));
+	fec.type = FEC_TYPE_IPV4;
+	fec.u.ipv4.prefix = root;
+	fec.u.ipv4.prefixlen = 0;
+
+	for (f = RB_NFIND(fec_tree, &ft, &fec); f != NULL;
+	    f = RB_NEXT(fec_tree, &ft, f)) {
+		if (f->type != FEC_TYPE_IPV4 ||
+		    f->u.ipv4.prefix.s_addr != root.s_addr)
+			break;
+		fn = (struct fec_node *)f;
+		if (!LIST_EMPTY(&fn->nexthops))
+			return (fn);
+	}
+
+	return (NULL);
+}
+
+static struct lde_nbr *
+mldp_upstream_nbr(struct fec_node *fn)
+{
+	struct fec_nh	*fnh;
+	struct lde_nbr	*ln;
+
+	LIST_FOREACH(fnh, &fn->nexthops, entry) {
+		ln = lde_nbr_find_by_addr(fnh->af, &fnh->nexthop);
+		/* nexthop not advertised by the neighbor, try the aliases */
+		if (ln == NULL && fnh->af == AF_INET)
+			ln = lde_nbr_find_by_lsrid(fnh->nexthop.v4);
+		if (ln)
+			return (ln);
+	}
+
+	return (NULL);
+}
+
+/* a directly connected route to the root means we are the root */
+static int
+mldp_is_root(struct fec_node *fn)
+{
+	struct fec_nh	*fnh;
+
+	LIST_FOREACH(fnh, &fn->nexthops, entry)
+		if (fnh->af == AF_INET && fnh->nexthop.v4.s_addr == INADDR_ANY)
+			return (1);
+
+	return (0);
+}
+
+/*
+ * Mappings are queued in ldpe and only sent once per event loop turn, so
+ * that a burst of LSPs towards the same neighbor is packed into full PDUs.
+ */
+static void
+mldp_send_mapping(struct lde_nbr *ln, struct mldp_lsp *lsp)
+{
+	lde_send_labelmapping(ln, &lsp->fn, 0);
+
+	if (!ln->mldp_flush) {
+		ln->mldp_flush = 1;
+		LIST_INSERT_HEAD(&mldp_flush_list, ln, mldp_flush_entry);
+	}
+	if (mldp_flush_ev == NULL)
+		mldp_flush_ev = thread_add_event(master, mldp_flush, NULL, 0);
+}
+
+/* push out queued mappings, e.g. before a withdraw for the same FEC */
+static void
+mldp_flush_nbr(struct lde_nbr *ln)
+{
+	if (!ln->mldp_flush)
+		return;
+
+	LIST_REMOVE(ln, mldp_flush_entry);
+	ln->mldp_flush = 0;
+	lde_imsg_compose_ldpe(IMSG_MAPPING_ADD_END, ln->peerid, 0, NULL, 0);
+}
+
+/* ARGSUSED */
+static int
+mldp_flush(struct thread *thread)
+{
+	struct lde_nbr	*ln;
+
+	mldp_flush_ev = NULL;
+
+	while ((ln = LIST_FIRST(&mldp_flush_list)) != NULL)
+		mldp_flush_nbr(ln);
+
+	return (0);
+}
+
+static void
+mldp_send_upstream(struct mldp_lsp *lsp)
+{
+	struct lde_nbr	*ln = lsp->root->upstream;
+
+	if (ln == NULL)
+		return;
+
+	label_nbr_add(lsp, ln, STREAM_TYPE_UP, NO_LABEL);
+	mldp_send_mapping(ln, lsp);
+}
+
+static void
+mldp_release_upstream(struct mldp_lsp *lsp, struct label_nbr *lnr)
+{
+	struct lde_nbr		*ln;
+
+	ln = lde_nbr_find(lnr->peerid);
+	if (ln) {
+		mldp_flush_nbr(ln);
+		lde_send_labelwithdraw(ln, &lsp->fn, NO_LABEL, NULL);
+		if (lnr->label != NO_LABEL)
+			lde_send_labelrelease(ln, &lsp->fn, lnr->label);
+	}
+	label_nbr_del(lnr);
+}
+
+/*
+ * Make-before-break: keep the old upstream branch, and the forwarding
+ * through it, until the new upstream has answered or the switchover
+ * times out.
+ */
+static void
+mldp_mbb_start(struct mldp_lsp *lsp)
+{
+	/* a previous switchover is still running, give up its old path */
+	mldp_mbb_finish(lsp);
+
+	lsp->mbb_upstream = lsp->upstream;
+	lsp->upstream = NULL;
+	lsp->mbb_timer = thread_add_timer(master, mldp_mbb_timer, lsp,
+	    MLDP_MBB_TIMEOUT);
+}
+
+static void
+mldp_mbb_finish(struct mldp_lsp *lsp)
+{
+	THREAD_TIMER_OFF(lsp->mbb_timer);
+	if (lsp->mbb_upstream)
+		mldp_release_upstream(lsp, lsp->mbb_upstream);
+}
+
+/* ARGSUSED */
+static int
+mldp_mbb_timer(struct thread *thread)
+{
+	struct mldp_lsp	*lsp = THREAD_ARG(thread);
+
+	lsp->mbb_timer = NULL;
+	mldp_mbb_finish(lsp);
+
+	return (0);
+}
+
+static void
+mldp_lsp_role(struct mldp_lsp *lsp)
+{
+	if (lsp->root->local)
+		lsp->role = MLDP_ROLE_ROOT;
+	else if (lsp->flags & F_MLDP_JOINED)
+		lsp->role = MLDP_ROLE_LEAF;
+	else
+		lsp->role = MLDP_ROLE_TRANSIT;
+}
+
+/* release what is no longer needed after a branch went away */
+static void
+mldp_lsp_prune(struct mldp_lsp *lsp)
+{
+	if (lsp->role == MLDP_ROLE_TRANSIT && RB_EMPTY(&lsp->downstream)) {
+		mldp_mbb_finish(lsp);
+		if (lsp->upstream)
+			mldp_release_upstream(lsp, lsp->upstream);
+	}
+
+	if (!(lsp->flags & F_MLDP_JOINED) && lsp->upstream == NULL &&
+	    RB_EMPTY(&lsp->downstream))
+		mldp_lsp_del(lsp);
+}
+
+/* protocol events */
+
+void
+mldp_recv_labelmessage(int type, struct map *map, struct lde_nbr *ln)
+{
+	struct fec	 fec;
+
+	if (!ln->v4_enabled)
+		return;
+
+	/* holds a reference on the opaque value */
+	lde_map2fec(map, ln->id, &fec);
+	switch (type) {
+	case IMSG_LABEL_MAPPING:
+		mldp_recv_mapping(map, &fec, ln);
+		break;
+	case IMSG_LABEL_WITHDRAW:
+		mldp_recv_withdraw(map, &fec, ln);
+		break;
+	case IMSG_LABEL_RELEASE:
+		mldp_recv_release(map, &fec, ln);
+		break;
+	default:
+		/* mLDP is downstream unsolicited only */
+		break;
+	}
+	mldp_fec_unref(&fec);
+}
+
+static void
+mldp_recv_mapping(struct map *map, struct fec *fec, struct lde_nbr *ln)
+{
+	struct mldp_lsp		*lsp;
+	struct label_nbr	*lnr = NULL, *down;
+	struct lde_nbr		*dln;
+
+	lsp = mldp_lsp_find(fec);
+	if (lsp)
+		lnr = label_nbr_find(lsp, ln->peerid, label_nbr_stream(map));
+
+	if (lnr) {
+		/* mapping from a branch we already know about */
+		label_nbr_set(lnr, map->label);
+		if (lnr != lsp->upstream ||
+		    fec->u.mldp.type != MLDP_TYPE_MP2MP)
+			return;
+		/* the new upstream path is up, drop the old one */
+		if (lsp->mbb_upstream)
+			mldp_mbb_finish(lsp);
+		RB_FOREACH(down, label_nbr_tree, &lsp->downstream) {
+			dln = lde_nbr_find(down->peerid);
+			if (dln && !fec_find(&dln->sent_map, &lsp->fn.fec))
+				mldp_send_mapping(dln, lsp);
+		}
+		return;
+	}
+
+	/* only the upstream LSR sends MP2MP upstream mappings */
+	if (map->type == MAP_TYPE_MP2MP_UP) {
+		debug_mldp("%s: unexpected mp2mp-up mapping from %s", __func__,
+		    inet_ntoa(ln->id));
+		return;
+	}
+
+	/* a downstream branch towards our own upstream would loop */
+	if (lsp && lsp->upstream && lsp->upstream->peerid == ln->peerid) {
+		debug_mldp("%s: mapping for %s from upstream %s ignored",
+		    __func__, log_fec(fec), inet_ntoa(ln->id));
+		return;
+	}
+
+	/* new downstream branch */
+	if (lsp == NULL)
+		lsp = mldp_lsp_new(fec);
+	label_nbr_add(lsp, ln, STREAM_TYPE_DOWN, map->label);
+
+	if (lsp->role != MLDP_ROLE_ROOT && lsp->upstream == NULL) {
+		mldp_send_upstream(lsp);
+		return;
+	}
+
+	/* MP2MP branches also get a label for the upstream direction */
+	if (fec->u.mldp.type == MLDP_TYPE_MP2MP &&
+	    !fec_find(&ln->sent_map, &lsp->fn.fec))
+		mldp_send_mapping(ln, lsp);
+}
+
+static void
+mldp_recv_withdraw(struct map *map, struct fec *fec, struct lde_nbr *ln)
+{
+	struct fec_node		 fn;
+	struct mldp_lsp		*lsp;
+	struct label_nbr	*lnr = NULL;
+
+	lsp = mldp_lsp_find(fec);
+	if (lsp)
+		lnr = label_nbr_find(lsp, ln->peerid, label_nbr_stream(map));
+
+	/* LWd.2: send label release */
+	mldp_flush_nbr(ln);
+	if (lsp)
+		lde_send_labelrelease(ln, &lsp->fn, map->label);
+	else {
+		memset(&fn, 0, sizeof(fn));
+		fn.fec = *fec;
+		lde_send_labelrelease(ln, &fn, map->label);
+	}
+
+	if (lnr == NULL)
+		return;
+
+	if (lnr->type == STREAM_TYPE_UP) {
+		/* keep the branch, the upstream LSR will map it again */
+		label_nbr_set(lnr, NO_LABEL);
+		return;
+	}
+
+	label_nbr_del(lnr);
+	mldp_lsp_prune(lsp);
+}
+
+static void
+mldp_recv_release(struct map *map, struct fec *fec, struct lde_nbr *ln)
+{
+	struct lde_wdraw	*lw;
+	struct lde_map		*me;
+
+	lw = (struct lde_wdraw *)fec_find(&ln->sent_wdraw, fec);
+	if (lw && (map->label == NO_LABEL ||
+	    (lw->label != NO_LABEL && map->label == lw->label)))
+		lde_wdraw_del(ln, lw);
+
+	me = (struct lde_map *)fec_find(&ln->sent_map, fec);
+	if (me && (map->label == NO_LABEL || map->label == me->map.label))
+		lde_map_del(ln, me, 1);
+}
+
+void
+mldp_nbr_del(struct lde_nbr *ln)
+{
+	struct label_nbr	*lnr;
+	struct mldp_lsp		*lsp;
+	struct mldp_root	*r;
+
+	RB_FOREACH(r, mldp_root_tree, &mldp_roots)
+		if (r->upstream == ln)
+			r->upstream = NULL;
+
+	if (ln->mldp_flush) {
+		LIST_REMOVE(ln, mldp_flush_entry);
+		ln->mldp_flush = 0;
+	}
+
+	while ((lnr = LIST_FIRST(&ln->label_nbrs)) != NULL) {
+		lsp = lnr->lsp;
+		label_nbr_del(lnr);
+		mldp_lsp_prune(lsp);
+	}
+}
+
+void
+mldp_tree_up(struct fec *fec)
+{
+	struct mldp_lsp		*lsp;
+
+	lsp = mldp_lsp_find(fec);
+	if (lsp == NULL)
+		lsp = mldp_lsp_new(fec);
+	lsp->flags |= F_MLDP_JOINED;
+	mldp_lsp_role(lsp);
+
+	if (lsp->role != MLDP_ROLE_ROOT && lsp->upstream == NULL)
+		mldp_send_upstream(lsp);
+}
+
+void
+mldp_tree_down(struct fec *fec)
+{
+	struct mldp_lsp		*lsp;
+
+	lsp = mldp_lsp_find(fec);
+	if (lsp == NULL || !(lsp->flags & F_MLDP_JOINED))
+		return;
+	lsp->flags &= ~F_MLDP_JOINED;
+	mldp_lsp_role(lsp);
+	mldp_lsp_prune(lsp);
+}
+
+static void
+mldp_rt_dump_branch(pid_t pid, struct ctl_rt *rtctl, struct label_nbr *lnr)
+{
+	struct lde_nbr		*ln;
+
+	ln = lde_nbr_find(lnr->peerid);
+	if (ln == NULL)
+		return;
+
+	rtctl->first = 1;
+	rtctl->nexthop = ln->id;
+	rtctl->remote_label = lnr->label;
+	rtctl->in_use = (lnr->type == STREAM_TYPE_UP);
+	lde_imsg_compose_ldpe(IMSG_CTL_SHOW_LIB, 0, pid, rtctl, sizeof(*rtctl));
+}
+
+void
+mldp_rt_dump(pid_t pid)
+{
+	struct mldp_lsp		*lsp;
+	struct label_nbr	*lnr;
+	static struct ctl_rt	 rtctl;
+	const uint8_t		*opaque;
+	uint16_t		 len;
+
+	RB_FOREACH(lsp, mldp_lsp_tree, &mldp_lsps) {
+		rtctl.af = AF_INET;
+		rtctl.prefix.v4 = lsp->fn.fec.u.mldp.root;
+		rtctl.prefixlen = 32;
+		rtctl.lsp_id = 0;
+		opaque = mldp_opaque_data(lsp->fn.fec.u.mldp.opaque, &len);
+		mldp_opaque_lspid(opaque, len, &rtctl.lsp_id);
+		rtctl.local_label = lsp->fn.local_label;
+
+		if (lsp->upstream)
+			mldp_rt_dump_branch(pid, &rtctl, lsp->upstream);
+		if (lsp->mbb_upstream)
+			mldp_rt_dump_branch(pid, &rtctl, lsp->mbb_upstream);
+		RB_FOREACH(lnr, label_nbr_tree, &lsp->downstream)
+			mldp_rt_dump_branch(pid, &rtctl, lnr);
+	}
+}
+
+static void
+mldp_ctl_branch(pid_t pid, struct label_nbr *lnr, uint8_t type)
+{
+	struct lde_nbr		*ln;
+	struct ctl_mldp_branch	 bctl;
+
+	ln = lde_nbr_find(lnr->peerid);
+	if (ln == NULL)
+		return;
+
+	memset(&bctl, 0, sizeof(bctl));
+	bctl.lsr_id = ln->id;
+	bctl.type = type;
+	bctl.label = lnr->label;
+	bctl.installed = lnr->installed;
+	lde_imsg_compose_ldpe(IMSG_CTL_SHOW_MLDP_BRANCH, 0, pid, &bctl,
+	    sizeof(bctl));
+}
+
+/*
+ * Send one page of the LSP database, starting after req->last when
+ * continuing a previous request.  The client asks for the next page
+ * when it received a full one.
+ */
+void
+mldp_ctl(pid_t pid, struct ctl_mldp_req *req)
+{
+	struct mldp_lsp		*lsp, key;
+	struct label_nbr	*lnr;
+	struct ctl_mldp_lsp	 lctl;
+	struct timeval		 now;
+	const uint8_t		*opaque;
+	int			 n = 0;
+
+	memset(&key, 0, sizeof(key));
+	key.fn.fec.type = FEC_TYPE_MLDP;
+	if (req->cont) {
+		key.fn.fec.u.mldp.type = req->last.type;
+		key.fn.fec.u.mldp.root = req->last.root;
+		key.fn.fec.u.mldp.opaque = mldp_opaque_get(req->last.opaque,
+		    MIN(req->last.opaque_len, MLDP_OPAQUE_MAX_LEN));
+		lsp = RB_NFIND(mldp_lsp_tree, &mldp_lsps, &key);
+		if (lsp && mldp_lsp_compare(lsp, &key) == 0)
+			lsp = RB_NEXT(mldp_lsp_tree, &mldp_lsps, lsp);
+		mldp_fec_unref(&key.fn.fec);
+	} else if (req->root.s_addr != INADDR_ANY) {
+		key.fn.fec.u.mldp.root = req->root;
+		lsp = RB_NFIND(mldp_lsp_tree, &mldp_lsps, &key);
+	} else
+		lsp = RB_MIN(mldp_lsp_tree, &mldp_lsps);
+
+	gettimeofday(&now, NULL);
+	for (; lsp && n < CTL_MLDP_PAGE;
+	    lsp = RB_NEXT(mldp_lsp_tree, &mldp_lsps, lsp), n++) {
+		if (req->root.s_addr != INADDR_ANY &&
+		    lsp->fn.fec.u.mldp.root.s_addr != req->root.s_addr)
+			break;
+
+		memset(&lctl, 0, sizeof(lctl));
+		lctl.key.type = lsp->fn.fec.u.mldp.type;
+		lctl.key.root = lsp->fn.fec.u.mldp.root;
+		opaque = mldp_opaque_data(lsp->fn.fec.u.mldp.opaque,
+		    &lctl.key.opaque_len);
+		memcpy(lctl.key.opaque, opaque, lctl.key.opaque_len);
+		lctl.lsp_id_valid = (mldp_opaque_lspid(lctl.key.opaque,
+		    lctl.key.opaque_len, &lctl.lsp_id) == 0);
+		lctl.role = lsp->role;
+		lctl.joined = (lsp->flags & F_MLDP_JOINED) ? 1 : 0;
+		lctl.local_label = lsp->fn.local_label;
+		lctl.uptime = now.tv_sec - lsp->uptime;
+		lctl.nbranches = (lsp->upstream ? 1 : 0) +
+		    (lsp->mbb_upstream ? 1 : 0);
+		RB_FOREACH(lnr, label_nbr_tree, &lsp->downstream)
+			lctl.nbranches++;
+		lde_imsg_compose_ldpe(IMSG_CTL_SHOW_MLDP, 0, pid, &lctl,
+		    sizeof(lctl));
+
+		if (lsp->upstream)
+			mldp_ctl_branch(pid, lsp->upstream,
+			    CTL_MLDP_BRANCH_UP);
+		if (lsp->mbb_upstream)
+			mldp_ctl_branch(pid, lsp->mbb_upstream,
+			    CTL_MLDP_BRANCH_MBB);
+		RB_FOREACH(lnr, label_nbr_tree, &lsp->downstream)
+			mldp_ctl_branch(pid, lnr, CTL_MLDP_BRANCH_DOWN);
+	}
+}
@@ -30,13 +30,13 @@ static __inline int	 nbr_id_compare(struct nbr *, struct nbr *);
 static __inline int	 nbr_addr_compare(struct nbr *, struct nbr *);
 static __inline int	 nbr_pid_compare(struct nbr *, struct nbr *);
 static void		 nbr_update_peerid(struct nbr *);
-static int		 nbr_ktimer(struct thread *);
+static void		 nbr_ktimer(void *);
 static void		 nbr_start_ktimer(struct nbr *);
-static int		 nbr_ktimeout(struct thread *);
+static void		 nbr_ktimeout(void *);
 static void		 nbr_start_ktimeout(struct nbr *);
-static int		 nbr_itimeout(struct thread *);
+static void		 nbr_itimeout(void *);
 static void		 nbr_start_itimeout(struct nbr *);
-static int		 nbr_idtimer(struct thread *);
+static void		 nbr_idtimer(void *);
 static int		 nbr_act_session_operational(struct nbr *);
 static void		 nbr_send_labelmappings(struct nbr *);
 
@@ -202,6 +202,8 @@ nbr_fsm(struct nbr *nbr, enum nbr_event event)
 		ldpe_imsg_compose_lde(IMSG_NEIGHBOR_DOWN, nbr->peerid, 0,
 		    NULL, 0);
 		session_close(nbr);
+		nbr->flags &= ~F_NBR_LDP_SYNC;
+		nbr_ldp_sync_update(nbr);
 		break;
 	case NBR_ACT_NOTHING:
 		/* do nothing */
@@ -217,7 +219,7 @@ nbr_new(struct in_addr id, int af, int ds_tlv, union ldpd_addr *addr,
 {
 	struct nbr		*nbr;
 	struct nbr_params	*nbrp;
-	struct adj		*adj;
+	struct adj		*adj, key;
 	struct pending_conn	*pconn;
 
 	log_debug("%s: lsr-id %s transport-address %s", __func__,
@@ -241,11 +243,15 @@ nbr_new(struct in_addr id, int af, int ds_tlv, union ldpd_addr *addr,
 	nbr->raddr_scope = scope_id;
 	nbr->conf_seqnum = 0;
 
-	LIST_FOREACH(adj, &global.adj_list, global_entry) {
-		if (adj->lsr_id.s_addr == nbr->id.s_addr) {
-			adj->nbr = nbr;
-			LIST_INSERT_HEAD(&nbr->adj_list, adj, nbr_entry);
-		}
+	/* adjacencies sort by lsr-id first, a key without a source leads */
+	memset(&key, 0, sizeof(key));
+	key.lsr_id = id;
+	key.source.type = HELLO_LINK;
+	for (adj = RB_NFIND(global_adj_head, &global.adj_tree, &key);
+	    adj != NULL && adj->lsr_id.s_addr == id.s_addr;
+	    adj = RB_NEXT(global_adj_head, &global.adj_tree, adj)) {
+		adj->nbr = nbr;
+		LIST_INSERT_HEAD(&nbr->adj_list, adj, nbr_entry);
 	}
 
 	if (RB_INSERT(nbr_id_head, &nbrs_by_id, nbr) != NULL)
@@ -259,6 +265,11 @@ nbr_new(struct in_addr id, int af, int ds_tlv, union ldpd_addr *addr,
 	TAILQ_INIT(&nbr->release_list);
 	TAILQ_INIT(&nbr->abortreq_list);
 
+	wheel_timer_init(&nbr->keepalive_timer, nbr_ktimer, nbr);
+	wheel_timer_init(&nbr->keepalive_timeout, nbr_ktimeout, nbr);
+	wheel_timer_init(&nbr->init_timeout, nbr_itimeout, nbr);
+	wheel_timer_init(&nbr->initdelay_timer, nbr_idtimer, nbr);
+
 	nbrp = nbr_params_find(leconf, nbr->id);
 	if (nbrp) {
 #ifdef __OpenBSD__
@@ -370,6 +381,17 @@ nbr_adj_count(struct nbr *nbr, int af)
 	return (total);
 }
 
+/* re-evaluate LDP-IGP sync on the links this neighbor was discovered on */
+void
+nbr_ldp_sync_update(struct nbr *nbr)
+{
+	struct adj	*adj;
+
+	LIST_FOREACH(adj, &nbr->adj_list, nbr_entry)
+		if (adj->source.type == HELLO_LINK)
+			if_ldp_sync_update(adj->source.link.ia->iface);
+}
+
 int
 nbr_session_active_role(struct nbr *nbr)
 {
@@ -383,16 +405,13 @@ nbr_session_active_role(struct nbr *nbr)
 
 /* Keepalive timer: timer to send keepalive message to neighbors */
 
-static int
-nbr_ktimer(struct thread *thread)
+static void
+nbr_ktimer(void *arg)
 {
-	struct nbr	*nbr = THREAD_ARG(thread);
+	struct nbr	*nbr = arg;
 
-	nbr->keepalive_timer = NULL;
 	send_keepalive(nbr);
 	nbr_start_ktimer(nbr);
-
-	return (0);
 }
 
 static void
@@ -402,58 +421,50 @@ nbr_start_ktimer(struct nbr *nbr)
 
 	/* send three keepalives per period */
 	secs = nbr->keepalive / KEEPALIVE_PER_PERIOD;
-	THREAD_TIMER_OFF(nbr->keepalive_timer);
-	nbr->keepalive_timer = thread_add_timer(master, nbr_ktimer, nbr, secs);
+	wheel_timer_add(ldpe_timers, &nbr->keepalive_timer, secs * 1000UL);
 }
 
 void
 nbr_stop_ktimer(struct nbr *nbr)
 {
-	THREAD_TIMER_OFF(nbr->keepalive_timer);
+	wheel_timer_del(ldpe_timers, &nbr->keepalive_timer);
 }
 
 /* Keepalive timeout: if the nbr hasn't sent keepalive */
 
-static int
-nbr_ktimeout(struct thread *thread)
+static void
+nbr_ktimeout(void *arg)
 {
-	struct nbr *nbr = THREAD_ARG(thread);
-
-	nbr->keepalive_timeout = NULL;
+	struct nbr *nbr = arg;
 
 	log_debug("%s: lsr-id %s", __func__, inet_ntoa(nbr->id));
 
 	session_shutdown(nbr, S_KEEPALIVE_TMR, 0, 0);
-
-	return (0);
 }
 
 static void
 nbr_start_ktimeout(struct nbr *nbr)
 {
-	THREAD_TIMER_OFF(nbr->keepalive_timeout);
-	nbr->keepalive_timeout = thread_add_timer(master, nbr_ktimeout, nbr,
-	    nbr->keepalive);
+	wheel_timer_add(ldpe_timers, &nbr->keepalive_timeout,
+	    nbr->keepalive * 1000UL);
 }
 
 void
 nbr_stop_ktimeout(struct nbr *nbr)
 {
-	THREAD_TIMER_OFF(nbr->keepalive_timeout);
+	wheel_timer_del(ldpe_timers, &nbr->keepalive_timeout);
 }
 
 /* Session initialization timeout: if nbr got stuck in the initialization FSM */
 
-static int
-nbr_itimeout(struct thread *thread)
+static void
+nbr_itimeout(void *arg)
 {
-	struct nbr	*nbr = THREAD_ARG(thread);
+	struct nbr	*nbr = arg;
 
 	log_debug("%s: lsr-id %s", __func__, inet_ntoa(nbr->id));
 
 	nbr_fsm(nbr, NBR_EVT_CLOSE_SESSION);
-
-	return (0);
 }
 
 static void
@@ -462,30 +473,25 @@ nbr_start_itimeout(struct nbr *nbr)
 	int		 secs;
 
 	secs = INIT_FSM_TIMEOUT;
-	THREAD_TIMER_OFF(nbr->init_timeout);
-	nbr->init_timeout = thread_add_timer(master, nbr_itimeout, nbr, secs);
+	wheel_timer_add(ldpe_timers, &nbr->init_timeout, secs * 1000UL);
 }
 
 void
 nbr_stop_itimeout(struct nbr *nbr)
 {
-	THREAD_TIMER_OFF(nbr->init_timeout);
+	wheel_timer_del(ldpe_timers, &nbr->init_timeout);
 }
 
 /* Init delay timer: timer to retry to iniziatize session */
 
-static int
-nbr_idtimer(struct thread *thread)
+static void
+nbr_idtimer(void *arg)
 {
-	struct nbr *nbr = THREAD_ARG(thread);
-
-	nbr->initdelay_timer = NULL;
+	struct nbr *nbr = arg;
 
 	log_debug("%s: lsr-id %s", __func__, inet_ntoa(nbr->id));
 
 	nbr_establish_connection(nbr);
-
-	return (0);
 }
 
 void
@@ -510,20 +516,19 @@ nbr_start_idtimer(struct nbr *nbr)
 		break;
 	}
 
-	THREAD_TIMER_OFF(nbr->initdelay_timer);
-	nbr->initdelay_timer = thread_add_timer(master, nbr_idtimer, nbr, secs);
+	wheel_timer_add(ldpe_timers, &nbr->initdelay_timer, secs * 1000UL);
 }
 
 void
 nbr_stop_idtimer(struct nbr *nbr)
 {
-	THREAD_TIMER_OFF(nbr->initdelay_timer);
+	wheel_timer_del(ldpe_timers, &nbr->initdelay_timer);
 }
 
 int
 nbr_pending_idtimer(struct nbr *nbr)
 {
-	return (nbr->initdelay_timer != NULL);
+	return (WHEEL_TIMER_ARMED(&nbr->initdelay_timer));
 }
 
 int
@@ -741,6 +746,10 @@ nbr_act_session_operational(struct nbr *nbr)
 	lde_nbr.id = nbr->id;
 	lde_nbr.v4_enabled = nbr->v4_enabled;
 	lde_nbr.v6_enabled = nbr->v6_enabled;
+	if (nbr->flags & F_NBR_GR_NEGOTIATED) {
+		lde_nbr.gr_reconnect = nbr->gr_reconnect;
+		lde_nbr.gr_recovery = nbr->gr_recovery;
+	}
 	return (ldpe_imsg_compose_lde(IMSG_NEIGHBOR_UP, nbr->peerid, 0,
 	    &lde_nbr, sizeof(lde_nbr)));
 }
@@ -804,6 +813,11 @@ nbr_to_ctl(struct nbr *nbr)
 	nctl.rport = nbr->tcp->rport;
 	nctl.holdtime = nbr->keepalive;
 	nctl.nbr_state = nbr->state;
+	nctl.flags = 0;
+	if (nbr->flags & F_NBR_GR_NEGOTIATED)
+		nctl.flags |= F_CTL_NBR_GR;
+	nctl.gr_reconnect = nbr->gr_reconnect;
+	nctl.gr_recovery = nbr->gr_recovery;
 
 	gettimeofday(&now, NULL);
 	if (nbr->state == NBR_STA_OPER) {
@@ -30,6 +30,7 @@ static struct iface		*disc_find_iface(unsigned int, int,
 				    union ldpd_addr *, int);
 static int			 session_read(struct thread *);
 static int			 session_write(struct thread *);
+static int			 session_writev(struct tcp_conn *);
 static ssize_t			 session_get_pdu(struct ibuf_read *, char **);
 static void			 tcp_close(struct tcp_conn *);
 static struct pending_conn	*pending_conn_new(int, int, union ldpd_addr *);
@@ -462,16 +463,16 @@ session_read(struct thread *thread)
 		if (errno != EINTR && errno != EAGAIN) {
 			log_warn("%s: read error", __func__);
 			nbr_fsm(nbr, NBR_EVT_CLOSE_SESSION);
-			return (0);
+			goto out;
 		}
 		/* retry read */
-		return (0);
+		goto out;
 	}
 	if (n == 0) {
 		/* connection closed */
 		log_debug("%s: connection closed by remote end", __func__);
 		nbr_fsm(nbr, NBR_EVT_CLOSE_SESSION);
-		return (0);
+		goto out;
 	}
 	tcp->rbuf->wpos += n;
 
@@ -481,7 +482,7 @@ session_read(struct thread *thread)
 		if (ntohs(ldp_hdr->version) != LDP_VERSION) {
 			session_shutdown(nbr, S_BAD_PROTO_VER, 0, 0);
 			free(buf);
-			return (0);
+			goto out;
 		}
 
 		pdu_len = ntohs(ldp_hdr->length);
@@ -498,14 +499,14 @@ session_read(struct thread *thread)
 		    pdu_len > max_pdu_len) {
 			session_shutdown(nbr, S_BAD_PDU_LEN, 0, 0);
 			free(buf);
-			return (0);
+			goto out;
 		}
 		pdu_len -= LDP_HDR_PDU_LEN;
 		if (ldp_hdr->lsr_id != nbr->id.s_addr ||
 		    ldp_hdr->lspace_id != 0) {
 			session_shutdown(nbr, S_BAD_LDP_ID, 0, 0);
 			free(buf);
-			return (0);
+			goto out;
 		}
 		pdu += LDP_HDR_SIZE;
 		len -= LDP_HDR_SIZE;
@@ -523,7 +524,7 @@ session_read(struct thread *thread)
 				session_shutdown(nbr, S_BAD_TLV_LEN, msg->id,
 				    msg->type);
 				free(buf);
-				return (0);
+				goto out;
 			}
 			msg_size = msg_len + LDP_MSG_DEAD_LEN;
 			pdu_len -= msg_size;
@@ -536,7 +537,7 @@ session_read(struct thread *thread)
 					session_shutdown(nbr, S_SHUTDOWN,
 					    msg->id, msg->type);
 					free(buf);
-					return (0);
+					goto out;
 				}
 				break;
 			case MSG_TYPE_KEEPALIVE:
@@ -545,7 +546,7 @@ session_read(struct thread *thread)
 					session_shutdown(nbr, S_SHUTDOWN,
 					    msg->id, msg->type);
 					free(buf);
-					return (0);
+					goto out;
 				}
 				break;
 			case MSG_TYPE_ADDR:
@@ -559,7 +560,7 @@ session_read(struct thread *thread)
 					session_shutdown(nbr, S_SHUTDOWN,
 					    msg->id, msg->type);
 					free(buf);
-					return (0);
+					goto out;
 				}
 				break;
 			default:
@@ -603,7 +604,7 @@ session_read(struct thread *thread)
 			if (ret == -1) {
 				/* parser failed, giving up */
 				free(buf);
-				return (0);
+				goto out;
 			}
 
 			/* Analyse the next message */
@@ -613,10 +614,14 @@ session_read(struct thread *thread)
 		free(buf);
 		if (len != 0) {
 			session_shutdown(nbr, S_BAD_PDU_LEN, 0, 0);
-			return (0);
+			goto out;
 		}
 	}
 
+out:
+	/* hand the label messages of this read over to lde */
+	ldpe_imsg_flush_lde();
+
 	return (0);
 }
 
@@ -627,8 +632,9 @@ session_write(struct thread *thread)
 	struct nbr	*nbr = tcp->nbr;
 
 	tcp->wbuf.ev = NULL;
+	tcp->lbuf = NULL;
 
-	if (msgbuf_write(&tcp->wbuf.wbuf) <= 0)
+	if (session_writev(tcp) <= 0)
 		if (errno != EAGAIN && nbr)
 			nbr_fsm(nbr, NBR_EVT_CLOSE_SESSION);
 
@@ -646,6 +652,50 @@ session_write(struct thread *thread)
 	return (0);
 }
 
+/*
+ * Gather queued pdus into one writev(), but stop after a few pdus worth of
+ * bytes so that a peer with a large backlog yields to the other sessions;
+ * the rest goes out on the next write event.
+ */
+static int
+session_writev(struct tcp_conn *tcp)
+{
+	struct msgbuf	*msgbuf = &tcp->wbuf.wbuf;
+	struct iovec	 iov[IOV_MAX];
+	struct ibuf	*buf;
+	size_t		 budget = SESSION_WRITE_BUDGET, len;
+	unsigned int	 i = 0;
+	ssize_t		 n;
+
+	TAILQ_FOREACH(buf, &msgbuf->bufs, entry) {
+		if (i >= IOV_MAX || budget == 0)
+			break;
+		len = min(buf->wpos - buf->rpos, budget);
+		iov[i].iov_base = buf->buf + buf->rpos;
+		iov[i].iov_len = len;
+		budget -= len;
+		i++;
+	}
+
+again:
+	if ((n = writev(msgbuf->fd, iov, i)) == -1) {
+		if (errno == EINTR)
+			goto again;
+		if (errno == ENOBUFS)
+			errno = EAGAIN;
+		return (-1);
+	}
+
+	if (n == 0) {			/* connection closed */
+		errno = 0;
+		return (0);
+	}
+
+	msgbuf_drain(msgbuf, n);
+
+	return (1);
+}
+
 void
 session_shutdown(struct nbr *nbr, uint32_t status, uint32_t msg_id,
     uint32_t msg_type)
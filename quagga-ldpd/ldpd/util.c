@@ -24,6 +24,11 @@
 #include "ldpd.h"
 #include "log.h"
 
+static __inline int	 lsrid_alias_compare(struct lsrid_alias *,
+			    struct lsrid_alias *);
+
+RB_GENERATE(lsrid_alias_head, lsrid_alias, entry, lsrid_alias_compare)
+
 uint8_t
 mask2prefixlen(in_addr_t ina)
 {
@@ -383,3 +388,41 @@ sockaddr_len(struct sockaddr *sa)
 	}
 #endif
 }
+
+/* extract the generic LSP identifier from an mLDP opaque value */
+int
+mldp_opaque_lspid(const uint8_t *opaque, uint16_t len, uint32_t *lsp_id)
+{
+	uint16_t	 vlen;
+	uint32_t	 id;
+
+	if (len != 1 + sizeof(vlen) + sizeof(id) ||
+	    opaque[0] != MLDP_OPAQUE_GENERIC_LSPID)
+		return (-1);
+	memcpy(&vlen, opaque + 1, sizeof(vlen));
+	if (ntohs(vlen) != MLDP_OPAQUE_GENERIC_LSPID_LEN)
+		return (-1);
+	memcpy(&id, opaque + 1 + sizeof(vlen), sizeof(id));
+	*lsp_id = ntohl(id);
+
+	return (0);
+}
+
+static __inline int
+lsrid_alias_compare(struct lsrid_alias *a, struct lsrid_alias *b)
+{
+	if (ntohl(a->addr.s_addr) < ntohl(b->addr.s_addr))
+		return (-1);
+	if (ntohl(a->addr.s_addr) > ntohl(b->addr.s_addr))
+		return (1);
+	return (0);
+}
+
+struct lsrid_alias *
+lsrid_alias_find(struct ldpd_conf *xconf, struct in_addr addr)
+{
+	struct lsrid_alias	 alias;
+
+	alias.addr = addr;
+	return (RB_FIND(lsrid_alias_head, &xconf->alias_tree, &alias));
+}
@@ -900,6 +900,9 @@ static const struct zebra_desc_table command_types[] = {
   DESC_ENTRY	(ZEBRA_VRF_UNREGISTER),
   DESC_ENTRY	(ZEBRA_MPLS_LSP_ADD),
   DESC_ENTRY	(ZEBRA_MPLS_LSP_DELETE),
+  DESC_ENTRY	(ZEBRA_MPLS_LDP_GR),
+  DESC_ENTRY	(ZEBRA_MPLS_LDP_SYNC),
+  DESC_ENTRY	(ZEBRA_MPLS_LDP_GR_STALE),
 };
 #undef DESC_ENTRY
 
@@ -68,6 +68,8 @@ struct memory_list memory_list_lib[] =
   { MTYPE_WORK_QUEUE_NAME,	"Work queue name string"	},
   { MTYPE_PQUEUE,		"Priority queue"		},
   { MTYPE_PQUEUE_DATA,		"Priority queue data"		},
+  { MTYPE_TIMER_WHEEL,		"Timer wheel"			},
+  { MTYPE_TIMER_WHEEL_SLOTS,	"Timer wheel slots"		},
   { MTYPE_HOST,			"Host config"			},
   { MTYPE_VRF,			"VRF"				},
   { MTYPE_VRF_NAME,		"VRF name"			},
@@ -83,7 +83,8 @@ enum lsp_types_t
 {
   ZEBRA_LSP_INVALID = 0,     /* Invalid. */
   ZEBRA_LSP_STATIC = 1,      /* Static LSP. */
-  ZEBRA_LSP_LDP = 2          /* LDP LSP. */
+  ZEBRA_LSP_LDP = 2,         /* LDP LSP. */
+  ZEBRA_LSP_MLDP = 3         /* mLDP point-to-multipoint LSP. */
 };
 
 /* Functions for basic label operations. */
@@ -0,0 +1,227 @@
+/* Hashed timer wheel.
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/*
+ * Protocol timers that are re-armed on every packet (hold timers,
+ * keepalives) cost a heap removal and insertion each time in the thread
+ * library.  Here timers are hashed by expiry tick into a fixed array of
+ * slots instead, and one thread timer advances the wheel a slot per tick
+ * while anything is armed.  Arming, re-arming and cancelling are O(1)
+ * list operations; a timer further away than one revolution just stays
+ * in its slot until its round comes up.
+ */
+
+#include <zebra.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "timerwheel.h"
+
+static int timer_wheel_run (struct thread *);
+
+/* Current time, in ticks. */
+static uint64_t
+timer_wheel_now (struct timer_wheel *wheel, uint64_t *msec)
+{
+  struct timeval tv;
+  uint64_t now;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &tv);
+  now = (uint64_t) tv.tv_sec * 1000 + tv.tv_usec / 1000;
+  if (msec)
+    *msec = now;
+
+  return now / wheel->period;
+}
+
+static void
+wheel_timer_link (struct wheel_timer **head, struct wheel_timer *timer)
+{
+  timer->next = *head;
+  if (timer->next)
+    timer->next->pprev = &timer->next;
+  *head = timer;
+  timer->pprev = head;
+}
+
+static void
+wheel_timer_unlink (struct wheel_timer *timer)
+{
+  if (timer->next)
+    timer->next->pprev = timer->pprev;
+  *timer->pprev = timer->next;
+  timer->next = NULL;
+  timer->pprev = NULL;
+}
+
+static void
+timer_wheel_schedule (struct timer_wheel *wheel)
+{
+  uint64_t now, next;
+
+  timer_wheel_now (wheel, &now);
+  next = (wheel->tick + 1) * wheel->period;
+
+  wheel->t_tick = thread_add_timer_msec (wheel->master, timer_wheel_run,
+					 wheel, next > now ? next - now : 0);
+}
+
+static int
+timer_wheel_run (struct thread *thread)
+{
+  struct timer_wheel *wheel = THREAD_ARG (thread);
+  struct wheel_timer *timer, *next, *expired;
+  uint64_t now;
+
+  wheel->t_tick = NULL;
+  now = timer_wheel_now (wheel, NULL);
+
+  while (wheel->tick < now && wheel->count > 0)
+    {
+      wheel->tick++;
+
+      /* Set the expired timers aside first, their callbacks are free to
+         add or delete any timer, including others in this slot. */
+      expired = NULL;
+      for (timer = wheel->slots[wheel->tick & (wheel->nslots - 1)];
+	   timer; timer = next)
+	{
+	  next = timer->next;
+	  if (timer->expiry > wheel->tick)
+	    continue;
+	  wheel_timer_unlink (timer);
+	  wheel_timer_link (&expired, timer);
+	}
+
+      while ((timer = expired) != NULL)
+	{
+	  wheel_timer_unlink (timer);
+	  wheel->count--;
+	  (*timer->func) (timer->arg);
+	}
+    }
+  wheel->tick = now;
+
+  if (wheel->count > 0 && wheel->t_tick == NULL)
+    timer_wheel_schedule (wheel);
+
+  return 0;
+}
+
+/* Create a wheel of nslots slots (rounded up to a power of two), each
+   covering period msecs. */
+struct timer_wheel *
+timer_wheel_new (struct thread_master *master, unsigned int nslots,
+		 unsigned long period)
+{
+  struct timer_wheel *wheel;
+  unsigned int size = 1;
+
+  while (size < nslots)
+    size <<= 1;
+
+  wheel = XCALLOC (MTYPE_TIMER_WHEEL, sizeof (struct timer_wheel));
+  wheel->slots = XCALLOC (MTYPE_TIMER_WHEEL_SLOTS,
+			  size * sizeof (struct wheel_timer *));
+  wheel->master = master;
+  wheel->nslots = size;
+  wheel->period = period ? period : 1;
+  wheel->tick = timer_wheel_now (wheel, NULL);
+
+  return wheel;
+}
+
+/* Free the wheel.  Timers still armed are disarmed without firing. */
+void
+timer_wheel_free (struct timer_wheel *wheel)
+{
+  unsigned int i;
+
+  THREAD_TIMER_OFF (wheel->t_tick);
+  for (i = 0; i < wheel->nslots; i++)
+    while (wheel->slots[i])
+      wheel_timer_unlink (wheel->slots[i]);
+
+  XFREE (MTYPE_TIMER_WHEEL_SLOTS, wheel->slots);
+  XFREE (MTYPE_TIMER_WHEEL, wheel);
+}
+
+void
+wheel_timer_init (struct wheel_timer *timer, void (*func) (void *),
+		  void *arg)
+{
+  memset (timer, 0, sizeof (*timer));
+  timer->func = func;
+  timer->arg = arg;
+}
+
+/* Arm the timer to fire in msec milliseconds, re-arming it if it is
+   already running.  It never fires early, and at most one tick late. */
+void
+wheel_timer_add (struct timer_wheel *wheel, struct wheel_timer *timer,
+		 unsigned long msec)
+{
+  uint64_t now;
+  int idle = 0;
+
+  now = timer_wheel_now (wheel, NULL);
+
+  if (WHEEL_TIMER_ARMED (timer))
+    wheel_timer_unlink (timer);
+  else if (wheel->count++ == 0 && wheel->t_tick == NULL)
+    {
+      /* An idle wheel doesn't tick, catch up. */
+      wheel->tick = now;
+      idle = 1;
+    }
+
+  /* The current tick is partly gone already, so round up one more. */
+  timer->expiry = now + (msec + wheel->period - 1) / wheel->period + 1;
+  wheel_timer_link (&wheel->slots[timer->expiry & (wheel->nslots - 1)],
+		    timer);
+
+  if (idle)
+    timer_wheel_schedule (wheel);
+}
+
+void
+wheel_timer_del (struct timer_wheel *wheel, struct wheel_timer *timer)
+{
+  if (!WHEEL_TIMER_ARMED (timer))
+    return;
+
+  wheel_timer_unlink (timer);
+  wheel->count--;
+}
+
+/* Msecs left before the timer fires, 0 if it isn't armed. */
+unsigned long
+wheel_timer_remain (struct timer_wheel *wheel, struct wheel_timer *timer)
+{
+  uint64_t now, expiry;
+
+  if (!WHEEL_TIMER_ARMED (timer))
+    return 0;
+
+  timer_wheel_now (wheel, &now);
+  expiry = timer->expiry * wheel->period;
+
+  return expiry > now ? expiry - now : 0;
+}
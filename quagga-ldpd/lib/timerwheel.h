@@ -0,0 +1,61 @@
+/* Hashed timer wheel.
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _ZEBRA_TIMERWHEEL_H
+#define _ZEBRA_TIMERWHEEL_H
+
+/* A timer embedded in the user's own structure.  Set it up once with
+   wheel_timer_init (); it is armed for as long as pprev is set. */
+struct wheel_timer
+{
+  struct wheel_timer *next;
+  struct wheel_timer **pprev;
+  uint64_t expiry;			/* tick this timer fires at */
+  void (*func) (void *);
+  void *arg;
+};
+
+struct timer_wheel
+{
+  struct thread_master *master;
+  struct thread *t_tick;
+  struct wheel_timer **slots;
+  unsigned int nslots;			/* power of two */
+  unsigned long period;			/* msecs per tick */
+  uint64_t tick;			/* last tick processed */
+  unsigned long count;			/* armed timers */
+};
+
+#define WHEEL_TIMER_ARMED(T) ((T)->pprev != NULL)
+
+extern struct timer_wheel *timer_wheel_new (struct thread_master *,
+					    unsigned int nslots,
+					    unsigned long period);
+extern void timer_wheel_free (struct timer_wheel *);
+
+extern void wheel_timer_init (struct wheel_timer *, void (*) (void *),
+			      void *);
+extern void wheel_timer_add (struct timer_wheel *, struct wheel_timer *,
+			     unsigned long msec);
+extern void wheel_timer_del (struct timer_wheel *, struct wheel_timer *);
+extern unsigned long wheel_timer_remain (struct timer_wheel *,
+					 struct wheel_timer *);
+
+#endif /* _ZEBRA_TIMERWHEEL_H */
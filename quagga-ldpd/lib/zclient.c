@@ -1053,6 +1053,14 @@ zclient_read (struct thread *thread)
       if (zclient->ipv6_route_delete)
 	(*zclient->ipv6_route_delete) (command, zclient, length, vrf_id);
       break;
+    case ZEBRA_MPLS_LDP_SYNC:
+      if (zclient->ldp_sync_update)
+	(*zclient->ldp_sync_update) (command, zclient, length, vrf_id);
+      break;
+    case ZEBRA_MPLS_LDP_GR_STALE:
+      if (zclient->ldp_gr_stale)
+	(*zclient->ldp_gr_stale) (command, zclient, length, vrf_id);
+      break;
     default:
       break;
     }
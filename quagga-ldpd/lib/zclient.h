@@ -89,8 +89,15 @@ struct zclient
   int (*ipv4_route_delete) (int, struct zclient *, uint16_t, vrf_id_t);
   int (*ipv6_route_add) (int, struct zclient *, uint16_t, vrf_id_t);
   int (*ipv6_route_delete) (int, struct zclient *, uint16_t, vrf_id_t);
+  int (*ldp_sync_update) (int, struct zclient *, uint16_t, vrf_id_t);
+  int (*ldp_gr_stale) (int, struct zclient *, uint16_t, vrf_id_t);
 };
 
+/* LDP-IGP synchronization state of an interface (RFC 5443). */
+#define LDP_IGP_SYNC_OFF             0	/* LDP not enabled on the link */
+#define LDP_IGP_SYNC_NOT_ACHIEVED    1
+#define LDP_IGP_SYNC_ACHIEVED        2
+
 /* Zebra API message flag. */
 #define ZAPI_MESSAGE_NEXTHOP  0x01
 #define ZAPI_MESSAGE_IFINDEX  0x02
@@ -417,7 +417,10 @@ struct in_pktinfo
 #define ZEBRA_VRF_UNREGISTER              25
 #define ZEBRA_MPLS_LSP_ADD                26
 #define ZEBRA_MPLS_LSP_DELETE             27
-#define ZEBRA_MESSAGE_MAX                 28
+#define ZEBRA_MPLS_LDP_GR                 28
+#define ZEBRA_MPLS_LDP_SYNC               29
+#define ZEBRA_MPLS_LDP_GR_STALE           30
+#define ZEBRA_MESSAGE_MAX                 31
 
 /* Marker value used in new Zserv, in the byte location corresponding
  * the command value in the old zserv header. To allow old and new
@@ -31,6 +31,7 @@
 #include "command.h"
 #include "stream.h"
 #include "log.h"
+#include "zclient.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_spf.h"
@@ -102,6 +103,42 @@ ospf_if_recalculate_output_cost (struct interface *ifp)
     }
 }
 
+/* LDP-IGP synchronization (RFC 5443): ldpd reported a new state for the
+   link, re-originate the router-LSAs that describe it. */
+void
+ospf_if_ldp_sync_set (struct interface *ifp, u_char state)
+{
+  struct route_node *rn;
+
+  if (IF_OSPF_IF_INFO (ifp)->ldp_sync == state)
+    return;
+  IF_OSPF_IF_INFO (ifp)->ldp_sync = state;
+
+  for (rn = route_top (IF_OIFS (ifp)); rn; rn = route_next (rn))
+    {
+      struct ospf_interface *oi;
+
+      if ( (oi = rn->info) == NULL)
+	continue;
+
+      if (CHECK_FLAG (oi->ospf->config, OSPF_LDP_SYNC))
+	ospf_router_lsa_update_area (oi->area);
+    }
+}
+
+/* Should the link be advertised with the maximum metric while LDP has
+   not finished exchanging labels over it? */
+int
+ospf_if_ldp_sync_hold (struct ospf_interface *oi)
+{
+  if (!CHECK_FLAG (oi->ospf->config, OSPF_LDP_SYNC))
+    return 0;
+  if (oi->type == OSPF_IFTYPE_VIRTUALLINK || IF_OSPF_IF_INFO (oi->ifp) == NULL)
+    return 0;
+
+  return (IF_OSPF_IF_INFO (oi->ifp)->ldp_sync == LDP_IGP_SYNC_NOT_ACHIEVED);
+}
+
 /* Simulate down/up on the interface.  This is needed, for example, when 
    the MTU changes. */
 void
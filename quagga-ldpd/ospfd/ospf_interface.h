@@ -101,6 +101,7 @@ struct ospf_if_info
   struct route_table *params;
   struct route_table *oifs;
   unsigned int membership_counts[MEMBER_MAX];	/* multicast group refcnts */
+  u_char ldp_sync;		/* LDP-IGP sync state reported by ldpd */
 };
 
 struct ospf_interface;
@@ -282,6 +283,8 @@ extern void ospf_if_recalculate_output_cost (struct interface *);
 
 /* Simulate down/up on the interface. */
 extern void ospf_if_reset (struct interface *);
+extern void ospf_if_ldp_sync_set (struct interface *, u_char);
+extern int ospf_if_ldp_sync_hold (struct ospf_interface *);
 
 extern struct ospf_interface *ospf_vl_new (struct ospf *,
 					   struct ospf_vl_data *);
@@ -484,6 +484,10 @@ ospf_nbr_lookup_ptop (struct ospf_interface *oi)
 static u_int16_t
 ospf_link_cost (struct ospf_interface *oi)
 {
+  /* RFC5443 LDP-IGP synchronization */
+  if (ospf_if_ldp_sync_hold (oi))
+    return OSPF_OUTPUT_COST_INFINITE;
+
   /* RFC3137 stub router support */
   if (!CHECK_FLAG (oi->area->stub_router_state, OSPF_AREA_IS_STUB_ROUTED))
     return oi->output_cost;
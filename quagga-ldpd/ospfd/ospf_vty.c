@@ -2208,6 +2208,39 @@ DEFUN (no_ospf_log_adjacency_changes_detail,
   return CMD_SUCCESS;
 }
 
+DEFUN (ospf_mpls_ldp_sync,
+       ospf_mpls_ldp_sync_cmd,
+       "mpls ldp-sync",
+       "MPLS specific commands\n"
+       "Enable LDP-IGP synchronization\n")
+{
+  struct ospf *ospf = vty->index;
+
+  if (!CHECK_FLAG (ospf->config, OSPF_LDP_SYNC))
+    {
+      SET_FLAG (ospf->config, OSPF_LDP_SYNC);
+      ospf_router_lsa_update (ospf);
+    }
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_ospf_mpls_ldp_sync,
+       no_ospf_mpls_ldp_sync_cmd,
+       "no mpls ldp-sync",
+       NO_STR
+       "MPLS specific commands\n"
+       "Enable LDP-IGP synchronization\n")
+{
+  struct ospf *ospf = vty->index;
+
+  if (CHECK_FLAG (ospf->config, OSPF_LDP_SYNC))
+    {
+      UNSET_FLAG (ospf->config, OSPF_LDP_SYNC);
+      ospf_router_lsa_update (ospf);
+    }
+  return CMD_SUCCESS;
+}
+
 DEFUN (ospf_compatible_rfc1583,
        ospf_compatible_rfc1583_cmd,
        "compatible rfc1583",
@@ -7425,6 +7458,10 @@ ospf_config_write (struct vty *vty)
 	  vty_out(vty, "%s", VTY_NEWLINE);
 	}
 
+      /* LDP-IGP synchronization print. */
+      if (CHECK_FLAG (ospf->config, OSPF_LDP_SYNC))
+	vty_out (vty, " mpls ldp-sync%s", VTY_NEWLINE);
+
       /* RFC1583 compatibility flag print -- Compatible with CISCO 12.1. */
       if (CHECK_FLAG (ospf->config, OSPF_RFC1583_COMPATIBLE))
 	vty_out (vty, " compatible rfc1583%s", VTY_NEWLINE);
@@ -7768,6 +7805,10 @@ ospf_vty_init (void)
   install_element (OSPF_NODE, &no_ospf_log_adjacency_changes_cmd);
   install_element (OSPF_NODE, &no_ospf_log_adjacency_changes_detail_cmd);
 
+  /* "mpls ldp-sync" commands. */
+  install_element (OSPF_NODE, &ospf_mpls_ldp_sync_cmd);
+  install_element (OSPF_NODE, &no_ospf_mpls_ldp_sync_cmd);
+
   /* "ospf rfc1583-compatible" commands. */
   install_element (OSPF_NODE, &ospf_rfc1583_flag_cmd);
   install_element (OSPF_NODE, &no_ospf_rfc1583_flag_cmd);
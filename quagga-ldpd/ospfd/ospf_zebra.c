@@ -250,6 +250,31 @@ ospf_interface_state_down (int command, struct zclient *zclient,
   return 0;
 }
 
+static int
+ospf_ldp_sync_update (int command, struct zclient *zclient,
+                      zebra_size_t length, vrf_id_t vrf_id)
+{
+  struct stream *s = zclient->ibuf;
+  struct interface *ifp;
+  ifindex_t ifindex;
+  u_char state;
+
+  ifindex = stream_getl (s);
+  state = stream_getc (s);
+
+  ifp = if_lookup_by_index_vrf (ifindex, vrf_id);
+  if (ifp == NULL)
+    return 0;
+
+  if (IS_DEBUG_OSPF (zebra, ZEBRA_INTERFACE))
+    zlog_debug ("Zebra: Interface[%s] LDP-IGP sync state %u.",
+                ifp->name, state);
+
+  ospf_if_ldp_sync_set (ifp, state);
+
+  return 0;
+}
+
 static int
 ospf_interface_address_add (int command, struct zclient *zclient,
                             zebra_size_t length, vrf_id_t vrf_id)
@@ -1321,6 +1346,7 @@ ospf_zebra_init (struct thread_master *master)
   zclient->interface_address_delete = ospf_interface_address_delete;
   zclient->ipv4_route_add = ospf_zebra_read_ipv4;
   zclient->ipv4_route_delete = ospf_zebra_read_ipv4;
+  zclient->ldp_sync_update = ospf_ldp_sync_update;
 
   access_list_add_hook (ospf_filter_update);
   access_list_delete_hook (ospf_filter_update);
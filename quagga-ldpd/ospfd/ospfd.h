@@ -130,6 +130,7 @@ struct ospf
 #define OSPF_OPAQUE_CAPABLE		(1 << 2)
 #define OSPF_LOG_ADJACENCY_CHANGES	(1 << 3)
 #define OSPF_LOG_ADJACENCY_DETAIL	(1 << 4)
+#define OSPF_LDP_SYNC			(1 << 5)
 
   /* Opaque-LSA administrative flags. */
   u_char opaque;
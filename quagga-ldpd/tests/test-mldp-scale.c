@@ -0,0 +1,484 @@
+/*
+ * mLDP scale benchmark.
+ *
+ * Feeds the label decision engine of ldpd with synthetic imsgs, as if
+ * they came from ldpe, and measures how fast they are processed.  No LDP
+ * sessions are involved: the messages go over a local socketpair straight
+ * into lde_dispatch_imsg() and everything lde sends back is counted and
+ * dropped.
+ *
+ * This file is part of Quagga
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* lde_dispatch_imsg() and the ldpe pipe are private to lde.c */
+#include "ldpd/lde.c"
+
+#include "pqueue.h"
+
+#include <sys/resource.h>
+#include <time.h>
+
+enum bench_role
+{
+  BENCH_ROOT,
+  BENCH_TRANSIT,
+  BENCH_LEAF,
+};
+
+static const char *role_names[] = { "root", "transit", "leaf" };
+
+static enum bench_role role = BENCH_TRANSIT;
+static uint8_t tree_type = MLDP_TYPE_P2MP;
+static uint32_t ntrees = 10000;
+static uint32_t fanout = 4;
+static uint32_t nfecs;			/* extra LIB entries to snapshot */
+
+static struct imsgbuf peer;		/* ldpe side of the pipe */
+static struct in_addr root_addr;
+
+static uint64_t *samples;
+static size_t nsamples, maxsamples;
+static unsigned long sent_ldpe, sent_parent;
+
+/*
+ * ldpd.c brings its own main() and pulls in ldpe, so the few symbols lde
+ * needs from the rest of the daemon are provided here.  Pseudowires are
+ * not exercised.
+ */
+struct ldpd_global global;
+struct ldp_debug ldp_debug;
+
+int
+imsg_compose_event (struct imsgev *iev, uint16_t type, uint32_t peerid,
+		    pid_t pid, int fd, void *data, uint16_t datalen)
+{
+  if (iev == iev_ldpe)
+    sent_ldpe++;
+  else if (type != IMSG_LOG)
+    sent_parent++;
+  return 1;
+}
+
+void
+imsg_event_add (struct imsgev *iev)
+{
+}
+
+int
+ldp_write_handler (struct thread *thread)
+{
+  return 0;
+}
+
+struct ldpd_conf *
+config_new_empty (void)
+{
+  struct ldpd_conf *xconf;
+
+  if ((xconf = calloc (1, sizeof (*xconf))) == NULL)
+    fatal (NULL);
+  return xconf;
+}
+
+void
+config_clear (struct ldpd_conf *conf)
+{
+  free (conf);
+}
+
+void
+merge_config (struct ldpd_conf *conf, struct ldpd_conf *xconf)
+{
+}
+
+int
+ldpe_imsg_compose_parent (int type, pid_t pid, void *data, uint16_t datalen)
+{
+  return 0;
+}
+
+void
+l2vpn_pw_reset (struct l2vpn_pw *pw)
+{
+}
+
+int
+l2vpn_pw_ok (struct l2vpn_pw *pw, struct fec_nh *fnh)
+{
+  return 0;
+}
+
+int
+l2vpn_pw_negotiate (struct lde_nbr *ln, struct fec_node *fn, struct map *map)
+{
+  return 0;
+}
+
+void
+l2vpn_recv_pw_status (struct lde_nbr *ln, struct notify_msg *nm)
+{
+}
+
+void
+l2vpn_sync_pws (int af, union ldpd_addr *addr)
+{
+}
+
+void
+l2vpn_pw_ctl (pid_t pid)
+{
+}
+
+void
+l2vpn_binding_ctl (pid_t pid)
+{
+}
+
+/* neighbor i: LSR-ID 10.255.x.y, interface address 172.16.x.y */
+static struct in_addr
+nbr_id (uint32_t i)
+{
+  struct in_addr addr;
+
+  addr.s_addr = htonl (0x0aff0000 | i);
+  return addr;
+}
+
+static struct in_addr
+nbr_addr (uint32_t i)
+{
+  struct in_addr addr;
+
+  addr.s_addr = htonl (0xac100000 | i);
+  return addr;
+}
+
+static uint64_t
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* run everything lde scheduled, including work queues, like its event loop */
+static void
+drain_events (void)
+{
+  struct thread thread;
+
+  while (master->event.count || master->ready.count ||
+	 master->background->size)
+    {
+      if (thread_fetch (master, &thread) == NULL)
+	break;
+      thread_call (&thread);
+    }
+}
+
+static void
+dispatch (uint16_t type, uint32_t peerid, void *data, uint16_t len)
+{
+  struct thread thread;
+  uint64_t start;
+
+  if (imsg_compose (&peer, type, peerid, 0, -1, data, len) == -1 ||
+      msgbuf_write (&peer.w) <= 0)
+    {
+      perror ("imsg_compose");
+      exit (1);
+    }
+
+  memset (&thread, 0, sizeof (thread));
+  thread.arg = iev_ldpe;
+
+  start = now_ns ();
+  lde_dispatch_imsg (&thread);
+  drain_events ();
+  if (nsamples < maxsamples)
+    samples[nsamples++] = now_ns () - start;
+}
+
+static void
+add_route (struct in_addr prefix, struct in_addr nexthop, int connected)
+{
+  struct fec fec;
+  union ldpd_addr nh;
+
+  memset (&fec, 0, sizeof (fec));
+  fec.type = FEC_TYPE_IPV4;
+  fec.u.ipv4.prefix = prefix;
+  fec.u.ipv4.prefixlen = 32;
+  memset (&nh, 0, sizeof (nh));
+  nh.v4 = nexthop;
+  lde_kernel_insert (&fec, AF_INET, &nh, 0, connected, NULL);
+}
+
+static void
+nbr_up (uint32_t i)
+{
+  struct lde_nbr ln;
+  struct lde_addr la;
+
+  memset (&ln, 0, sizeof (ln));
+  ln.id = nbr_id (i);
+  ln.v4_enabled = 1;
+  dispatch (IMSG_NEIGHBOR_UP, i, &ln, sizeof (ln));
+
+  memset (&la, 0, sizeof (la));
+  la.af = AF_INET;
+  la.addr.v4 = nbr_addr (i);
+  dispatch (IMSG_ADDRESS_ADD, i, &la, sizeof (la));
+}
+
+static void
+send_map (uint16_t type, uint32_t peerid, uint8_t map_type, uint32_t lsp_id,
+	  uint32_t label)
+{
+  struct fec fec;
+  struct map map;
+  const uint8_t *opaque;
+
+  mldp_fec (&fec, tree_type, root_addr, lsp_id);
+
+  memset (&map, 0, sizeof (map));
+  map.type = map_type;
+  map.fec.mldp.root = root_addr;
+  opaque = mldp_opaque_data (fec.u.mldp.opaque, &map.fec.mldp.opaque_len);
+  memcpy (map.fec.mldp.opaque, opaque, map.fec.mldp.opaque_len);
+  map.label = label;
+  mldp_fec_unref (&fec);
+  dispatch (type, peerid, &map, sizeof (map));
+}
+
+static void
+tree_ctl (uint8_t op, uint32_t lsp_id)
+{
+  struct mldp_lsp_info info;
+
+  memset (&info, 0, sizeof (info));
+  info.op = op;
+  info.protocol_type = tree_type;
+  info.root_ip = root_addr;
+  info.lsp_id = lsp_id;
+  dispatch (IMSG_CTL_MLDP_LSP, 0, &info, sizeof (info));
+}
+
+static int
+cmp_u64 (const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+  return (x > y) - (x < y);
+}
+
+static size_t phase_first;
+static uint64_t phase_start, total_elapsed;
+
+static void
+report (const char *phase, uint64_t elapsed, size_t first)
+{
+  size_t n = nsamples - first;
+  uint64_t *s = samples + first;
+
+  if (n == 0)
+    return;
+  qsort (s, n, sizeof (*s), cmp_u64);
+  printf ("%-10s %8zu msgs %10.0f msg/s  p50 %6.2f  p90 %6.2f  "
+	  "p99 %7.2f  max %8.2f us\n", phase, n,
+	  n / (elapsed / 1e9), s[n / 2] / 1e3, s[n * 90 / 100] / 1e3,
+	  s[n * 99 / 100] / 1e3, s[n - 1] / 1e3);
+}
+
+static void
+phase_begin (void)
+{
+  phase_first = nsamples;
+  phase_start = now_ns ();
+}
+
+static void
+phase_end (const char *phase)
+{
+  uint64_t elapsed = now_ns () - phase_start;
+
+  total_elapsed += elapsed;
+  report (phase, elapsed, phase_first);
+}
+
+static void
+usage (const char *prog)
+{
+  fprintf (stderr, "usage: %s [-r root|transit|leaf] [-t p2mp|mp2mp] "
+	   "[-n trees] [-f fanout] [-l fecs]\n", prog);
+  exit (1);
+}
+
+int
+main (int argc, char **argv)
+{
+  struct rusage ru;
+  uint32_t i, j, up, first_down;
+  uint8_t down_type, up_type;
+  struct in_addr any;
+  int sv[2], ch;
+
+  while ((ch = getopt (argc, argv, "r:t:n:f:l:")) != -1)
+    {
+      switch (ch)
+	{
+	case 'r':
+	  if (strcmp (optarg, "root") == 0)
+	    role = BENCH_ROOT;
+	  else if (strcmp (optarg, "transit") == 0)
+	    role = BENCH_TRANSIT;
+	  else if (strcmp (optarg, "leaf") == 0)
+	    role = BENCH_LEAF;
+	  else
+	    usage (argv[0]);
+	  break;
+	case 't':
+	  if (strcmp (optarg, "p2mp") == 0)
+	    tree_type = MLDP_TYPE_P2MP;
+	  else if (strcmp (optarg, "mp2mp") == 0)
+	    tree_type = MLDP_TYPE_MP2MP;
+	  else
+	    usage (argv[0]);
+	  break;
+	case 'n':
+	  ntrees = strtoul (optarg, NULL, 10);
+	  break;
+	case 'f':
+	  fanout = strtoul (optarg, NULL, 10);
+	  break;
+	case 'l':
+	  nfecs = strtoul (optarg, NULL, 10);
+	  break;
+	default:
+	  usage (argv[0]);
+	}
+    }
+  if (ntrees == 0 || fanout == 0 || fanout > 0xfffe)
+    usage (argv[0]);
+  if (role == BENCH_LEAF)
+    fanout = 0;
+
+  ldpd_process = PROC_LDE_ENGINE;
+  master = thread_master_create ();
+  ldeconf = config_new_empty ();
+  lde_label_init ();
+
+  if (socketpair (AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+    {
+      perror ("socketpair");
+      exit (1);
+    }
+  imsg_init (&peer, sv[0]);
+  if ((iev_ldpe = calloc (1, sizeof (*iev_ldpe))) == NULL)
+    fatal (NULL);
+  imsg_init (&iev_ldpe->ibuf, sv[1]);
+
+  maxsamples = (size_t) ntrees * (2 * fanout + 3) + 5 * (fanout + 2);
+  if ((samples = calloc (maxsamples, sizeof (*samples))) == NULL)
+    fatal (NULL);
+
+  /* neighbor 1 is upstream, 2..fanout+1 are downstream */
+  up = 1;
+  first_down = 2;
+  root_addr.s_addr = htonl (0xc0000201);
+  if (tree_type == MLDP_TYPE_P2MP)
+    down_type = up_type = MAP_TYPE_P2MP;
+  else
+    {
+      down_type = MAP_TYPE_MP2MP_DOWN;
+      up_type = MAP_TYPE_MP2MP_UP;
+    }
+
+  printf ("mldp scale: %s %s, %u trees, fan-out %u\n", role_names[role],
+	  tree_type == MLDP_TYPE_P2MP ? "p2mp" : "mp2mp", ntrees, fanout);
+
+  /* routes: the root, and every neighbor's LSR-ID via its address */
+  any.s_addr = INADDR_ANY;
+  if (role == BENCH_ROOT)
+    add_route (root_addr, any, 1);
+  else
+    add_route (root_addr, nbr_addr (up), 0);
+  for (i = up; i < first_down + fanout; i++)
+    add_route (nbr_id (i), nbr_addr (i), 0);
+  /* unrelated host routes for the initial label advertisement */
+  for (i = 0; i < nfecs; i++)
+    {
+      struct in_addr prefix;
+
+      prefix.s_addr = htonl (0x64000000 | i);
+      add_route (prefix, nbr_addr (up), 0);
+    }
+
+  phase_begin ();
+  for (i = up; i < first_down + fanout; i++)
+    nbr_up (i);
+  phase_end ("nbr-up");
+
+  phase_begin ();
+  for (i = up; i < first_down + fanout; i++)
+    dispatch (IMSG_LABEL_MAPPING_FULL, i, NULL, 0);
+  phase_end ("snapshot");
+
+  phase_begin ();
+  for (i = 0; i < ntrees; i++)
+    {
+      if (role == BENCH_LEAF)
+	tree_ctl (OP_TYPE_ADD, i);
+      for (j = 0; j < fanout; j++)
+	send_map (IMSG_LABEL_MAPPING, first_down + j, down_type, i, 1000 + i);
+    }
+  phase_end (role == BENCH_LEAF ? "join" : "map-down");
+
+  /* the MP2MP upstream LSR answers with its own label */
+  if (role != BENCH_ROOT && tree_type == MLDP_TYPE_MP2MP)
+    {
+      phase_begin ();
+      for (i = 0; i < ntrees; i++)
+	send_map (IMSG_LABEL_MAPPING, up, up_type, i, 100000 + i);
+      phase_end ("map-up");
+    }
+
+  phase_begin ();
+  for (i = 0; i < ntrees; i++)
+    {
+      if (role == BENCH_LEAF)
+	tree_ctl (OP_TYPE_DEL, i);
+      for (j = 0; j < fanout; j++)
+	send_map (IMSG_LABEL_WITHDRAW, first_down + j, down_type, i,
+		  1000 + i);
+    }
+  phase_end (role == BENCH_LEAF ? "leave" : "withdraw");
+
+  phase_begin ();
+  for (i = up; i < first_down + fanout; i++)
+    dispatch (IMSG_NEIGHBOR_DOWN, i, NULL, 0);
+  phase_end ("nbr-down");
+
+  report ("total", total_elapsed, 0);
+  getrusage (RUSAGE_SELF, &ru);
+  printf ("imsgs out: %lu to ldpe, %lu to parent\n", sent_ldpe, sent_parent);
+  printf ("peak rss: %ld kB\n", ru.ru_maxrss);
+
+  return 0;
+}
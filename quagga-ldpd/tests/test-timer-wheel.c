@@ -0,0 +1,235 @@
+/*
+ * Test program to verify that timers on a timer wheel fire exactly
+ * once, never early and in expiry order, across arming, re-arming and
+ * cancelling, including from within timer callbacks, and that they
+ * report the time they have left.
+ *
+ * This file is part of Quagga
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "memory.h"
+#include "prng.h"
+#include "thread.h"
+#include "timerwheel.h"
+
+/* A small wheel with short ticks, so timers wrap around it several
+   times before they fire. */
+#define WHEEL_SLOTS     64
+#define WHEEL_PERIOD    10
+
+#define SCHEDULE_TIMERS 800
+#define REMOVE_TIMERS   200
+#define REARM_TIMERS    200
+
+struct test_timer
+{
+  struct wheel_timer timer;
+  uint64_t deadline;		/* msecs, earliest time it may fire */
+  int fired;
+  int cancelled;
+  int rearm;			/* re-arm once from the callback */
+};
+
+struct thread_master *master;
+
+static struct timer_wheel *wheel;
+static struct prng *prng;
+static struct test_timer *timers;
+static int timers_pending;
+static uint64_t last_expiry;
+static int errors;
+
+static uint64_t
+now_msec (void)
+{
+  struct timeval tv;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &tv);
+  return (uint64_t) tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static void
+arm (struct test_timer *t, unsigned long msec)
+{
+  unsigned long remain;
+
+  t->deadline = now_msec () + msec;
+  wheel_timer_add (wheel, &t->timer, msec);
+
+  /* The remaining time covers the full interval, plus rounding up to
+     the next tick boundary. */
+  remain = wheel_timer_remain (wheel, &t->timer);
+  if (now_msec () + remain < t->deadline
+      || remain > msec + 2 * WHEEL_PERIOD)
+    {
+      fprintf (stderr, "Timer %d armed for %lu msecs reports %lu left.\n",
+	       (int) (t - timers), msec, remain);
+      errors++;
+    }
+}
+
+static void
+cancel (struct test_timer *t)
+{
+  wheel_timer_del (wheel, &t->timer);
+  if (wheel_timer_remain (wheel, &t->timer) != 0)
+    {
+      fprintf (stderr, "Cancelled timer %d reports time left.\n",
+	       (int) (t - timers));
+      errors++;
+    }
+  t->cancelled = 1;
+  timers_pending--;
+}
+
+static void
+terminate_test (void)
+{
+  int i;
+
+  for (i = 0; i < SCHEDULE_TIMERS; i++)
+    {
+      if (timers[i].cancelled && timers[i].fired)
+	{
+	  fprintf (stderr, "Timer %d fired after being cancelled.\n", i);
+	  errors++;
+	}
+      if (!timers[i].cancelled && timers[i].fired != 1)
+	{
+	  fprintf (stderr, "Timer %d fired %d times.\n", i, timers[i].fired);
+	  errors++;
+	}
+    }
+  if (wheel->count != 0)
+    {
+      fprintf (stderr, "Wheel still counts %lu armed timers.\n", wheel->count);
+      errors++;
+    }
+
+  if (errors)
+    printf ("Timer wheel checks failed.\n");
+  else
+    printf ("Timer wheel checks passed.\n");
+
+  timer_wheel_free (wheel);
+  thread_master_free (master);
+  prng_free (prng);
+  XFREE (MTYPE_TMP, timers);
+
+  exit (errors ? 1 : 0);
+}
+
+static void
+timer_func (void *arg)
+{
+  struct test_timer *t = arg;
+  struct test_timer *other;
+
+  if (now_msec () < t->deadline)
+    {
+      fprintf (stderr, "Timer %d fired %llu msecs early.\n",
+	       (int) (t - timers),
+	       (unsigned long long) (t->deadline - now_msec ()));
+      errors++;
+    }
+  if (t->timer.expiry < last_expiry)
+    {
+      fprintf (stderr, "Timer %d fired out of order.\n", (int) (t - timers));
+      errors++;
+    }
+  last_expiry = t->timer.expiry;
+
+  if (t->rearm)
+    {
+      t->rearm = 0;
+      arm (t, prng_rand (prng) % 500);
+      return;
+    }
+
+  t->fired++;
+  timers_pending--;
+
+  /* Cancel another timer from within the callback now and then. */
+  other = &timers[prng_rand (prng) % SCHEDULE_TIMERS];
+  if (other != t && !other->cancelled && !other->fired
+      && !other->rearm && prng_rand (prng) % 8 == 0)
+    cancel (other);
+
+  if (!timers_pending)
+    terminate_test ();
+}
+
+int
+main (int argc, char **argv)
+{
+  int i;
+  struct thread t;
+
+  master = thread_master_create ();
+  wheel = timer_wheel_new (master, WHEEL_SLOTS, WHEEL_PERIOD);
+  prng = prng_new (0);
+
+  timers = XCALLOC (MTYPE_TMP, SCHEDULE_TIMERS * sizeof (*timers));
+
+  for (i = 0; i < SCHEDULE_TIMERS; i++)
+    {
+      wheel_timer_init (&timers[i].timer, timer_func, &timers[i]);
+
+      /* Schedule timers to expire in 0..2 seconds, a few revolutions. */
+      arm (&timers[i], prng_rand (prng) % 2000);
+      timers_pending++;
+    }
+
+  for (i = 0; i < REARM_TIMERS; i++)
+    {
+      struct test_timer *rt = &timers[prng_rand (prng) % SCHEDULE_TIMERS];
+
+      if (prng_rand (prng) % 2)
+	arm (rt, prng_rand (prng) % 2000);
+      else
+	rt->rearm = 1;
+    }
+
+  for (i = 0; i < REMOVE_TIMERS; i++)
+    {
+      struct test_timer *rt = &timers[prng_rand (prng) % SCHEDULE_TIMERS];
+
+      if (rt->cancelled)
+	continue;
+
+      cancel (rt);
+      rt->rearm = 0;
+    }
+
+  if (wheel->count != (unsigned long) timers_pending)
+    {
+      fprintf (stderr, "Wheel counts %lu armed timers, expected %d.\n",
+	       wheel->count, timers_pending);
+      errors++;
+    }
+
+  while (thread_fetch (master, &t))
+    thread_call (&t);
+
+  return 0;
+}
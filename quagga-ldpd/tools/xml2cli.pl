@@ -51,7 +51,9 @@ use XML::LibXML;
 		"disc_time"		=> "<1-65535>",
 		"session_time"		=> "<15-65535>",
 		"pwid"			=> "<1-4294967295>",
-		"hops"			=> "<1-254>"
+		"hops"			=> "<1-254>",
+		"label"			=> "<16-1048575>",
+		"route_delay"		=> "<0-1000>"
 		);
 
 # parse options node and store the corresponding information
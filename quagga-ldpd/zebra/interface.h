@@ -188,6 +188,9 @@ struct zebra_if
   /* Installed addresses chains tree. */
   struct route_table *ipv4_subnets;
 
+  /* LDP-IGP synchronization state, as reported by ldpd. */
+  u_char ldp_sync;
+
 #if defined(HAVE_RTADV)
   struct rtadvconf rtadv;
 #endif /* RTADV */
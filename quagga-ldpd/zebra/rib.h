@@ -404,6 +404,10 @@ struct zebra_vrf
   /* MPLS processing flags */
   u_int16_t mpls_flags;
 #define MPLS_FLAG_SCHEDULE_LSPS    (1 << 0)
+
+  /* LDP graceful restart: seconds LDP LSPs outlive an ldpd session */
+  u_int32_t ldp_gr_time;
+  struct thread *t_ldp_gr;
 };
 
 /*
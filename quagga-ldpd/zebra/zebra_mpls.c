@@ -91,7 +91,7 @@ static int
 nhlfe_del (zebra_nhlfe_t *snhlfe);
 static int
 mpls_lsp_uninstall_all (struct hash *lsp_table, zebra_lsp_t *lsp,
-			enum lsp_types_t type);
+			enum lsp_types_t type, u_int32_t flags);
 static int
 mpls_static_lsp_uninstall_all (struct zebra_vrf *zvrf, mpls_label_t in_label);
 static void
@@ -309,6 +309,7 @@ lsp_select_best_nhlfe (zebra_lsp_t *lsp)
   zebra_nhlfe_t *best;
   struct nexthop *nexthop;
   int changed = 0;
+  u_int32_t branches = 0;
 
   if (!lsp)
     return;
@@ -359,9 +360,20 @@ lsp_select_best_nhlfe (zebra_lsp_t *lsp)
           CHECK_FLAG (nexthop->flags, NEXTHOP_FLAG_ACTIVE) &&
           (nhlfe->distance == lsp->best_nhlfe->distance))
         {
-          SET_FLAG (nhlfe->flags, NHLFE_FLAG_SELECTED);
-          SET_FLAG (nhlfe->flags, NHLFE_FLAG_MULTIPATH);
-          lsp->num_ecmp++;
+          /*
+           * The kernel treats the paths of an entry as equal-cost and
+           * load-balances over them instead of replicating, so only one
+           * branch of an mLDP tree can be installed.
+           */
+          if (CHECK_FLAG (lsp->flags, LSP_FLAG_REPLICATE))
+            branches++;
+          if (!CHECK_FLAG (lsp->flags, LSP_FLAG_REPLICATE) ||
+              nhlfe == lsp->best_nhlfe)
+            {
+              SET_FLAG (nhlfe->flags, NHLFE_FLAG_SELECTED);
+              SET_FLAG (nhlfe->flags, NHLFE_FLAG_MULTIPATH);
+              lsp->num_ecmp++;
+            }
         }
 
       if (CHECK_FLAG (lsp->flags, LSP_FLAG_INSTALLED) &&
@@ -383,6 +395,16 @@ lsp_select_best_nhlfe (zebra_lsp_t *lsp)
 
   if (changed)
     SET_FLAG (lsp->flags, LSP_FLAG_CHANGED);
+
+  if (branches <= 1)
+    UNSET_FLAG (lsp->flags, LSP_FLAG_BRANCH_WARNED);
+  else if (!CHECK_FLAG (lsp->flags, LSP_FLAG_BRANCH_WARNED))
+    {
+      zlog_warn ("LSP in-label %u: %u mLDP branches, only one installed "
+                 "(replication is not supported by the dataplane)",
+                 lsp->ile.in_label, branches);
+      SET_FLAG (lsp->flags, LSP_FLAG_BRANCH_WARNED);
+    }
 }
 
 /*
@@ -707,6 +729,7 @@ static int
 nhlfe_del (zebra_nhlfe_t *nhlfe)
 {
   zebra_lsp_t *lsp;
+  zebra_nhlfe_t *n;
 
   if (!nhlfe)
     return -1;
@@ -727,14 +750,28 @@ nhlfe_del (zebra_nhlfe_t *nhlfe)
   else
     lsp->nhlfe_list = nhlfe->next;
 
+  /* Once the last mLDP branch is gone the in-label is a plain LSP again. */
+  if (nhlfe->type == ZEBRA_LSP_MLDP)
+    {
+      for (n = lsp->nhlfe_list; n; n = n->next)
+        if (n->type == ZEBRA_LSP_MLDP)
+          break;
+      if (!n)
+        UNSET_FLAG (lsp->flags, LSP_FLAG_REPLICATE | LSP_FLAG_BRANCH_WARNED);
+    }
+
   XFREE (MTYPE_NHLFE, nhlfe);
 
   return 0;
 }
 
+/*
+ * Uninstall the NHLFEs of the given type for an LSP, restricted to those
+ * carrying all of 'flags' when non-zero.
+ */
 static int
 mpls_lsp_uninstall_all (struct hash *lsp_table, zebra_lsp_t *lsp,
-			enum lsp_types_t type)
+			enum lsp_types_t type, u_int32_t flags)
 {
   zebra_nhlfe_t *nhlfe, *nhlfe_next;
   int schedule_lsp = 0;
@@ -748,6 +785,8 @@ mpls_lsp_uninstall_all (struct hash *lsp_table, zebra_lsp_t *lsp,
       /* Skip non-static NHLFEs */
       if (nhlfe->type != type)
         continue;
+      if ((nhlfe->flags & flags) != flags)
+        continue;
 
       if (IS_ZEBRA_DEBUG_MPLS)
         {
@@ -811,7 +850,7 @@ mpls_static_lsp_uninstall_all (struct zebra_vrf *zvrf, mpls_label_t in_label)
   if (!lsp || !lsp->nhlfe_list)
     return 0;
 
-  return mpls_lsp_uninstall_all (lsp_table, lsp, ZEBRA_LSP_STATIC);
+  return mpls_lsp_uninstall_all (lsp_table, lsp, ZEBRA_LSP_STATIC, 0);
 }
 
 /*
@@ -848,6 +887,8 @@ nhlfe_print (zebra_nhlfe_t *nhlfe, struct vty *vty)
     }
   vty_out(vty, "%s", CHECK_FLAG (nhlfe->flags, NHLFE_FLAG_INSTALLED) ?
           " (installed)" : "");
+  vty_out(vty, "%s", CHECK_FLAG (nhlfe->flags, NHLFE_FLAG_STALE) ?
+          " (stale)" : "");
   vty_out(vty, "%s", VTY_NEWLINE);
 }
 
@@ -1222,6 +1263,18 @@ mpls_lsp_install (struct zebra_vrf *zvrf, enum lsp_types_t type,
 
       /* Clear deleted flag (in case it was set) */
       UNSET_FLAG (nhlfe->flags, NHLFE_FLAG_DELETED);
+      if (CHECK_FLAG (nhlfe->flags, NHLFE_FLAG_STALE))
+        {
+          /*
+           * Refreshed after a graceful restart. Stale siblings stay until
+           * they are refreshed too or the restart timer sweeps them: the
+           * restarted ldpd keeps their in-labels reserved, so nothing else
+           * can be bound to this LSP meanwhile.
+           */
+          UNSET_FLAG (nhlfe->flags, NHLFE_FLAG_STALE);
+          if (nh->nh_label->label[0] == out_label)
+            return lsp_processq_add (lsp) ? -1 : 0;
+        }
       if (nh->nh_label->label[0] == out_label)
         /* No change */
         return 0;
@@ -1256,6 +1309,10 @@ mpls_lsp_install (struct zebra_vrf *zvrf, enum lsp_types_t type,
       lsp->addr_family = NHLFE_FAMILY (nhlfe);
     }
 
+  /* mLDP NHLFEs are branches of a tree, not equal-cost paths. */
+  if (type == ZEBRA_LSP_MLDP)
+    SET_FLAG (lsp->flags, LSP_FLAG_REPLICATE);
+
   /* Mark NHLFE, queue LSP for processing. */
   SET_FLAG(nhlfe->flags, NHLFE_FLAG_CHANGED);
   if (lsp_processq_add (lsp))
@@ -1329,7 +1386,7 @@ mpls_lsp_uninstall (struct zebra_vrf *zvrf, enum lsp_types_t type,
 }
 
 /*
- * Uninstall all LDP NHLFEs for a particular LSP forwarding entry.
+ * Uninstall all LDP and mLDP NHLFEs for a particular LSP forwarding entry.
  * If no other NHLFEs exist, the entry would be deleted.
  */
 void
@@ -1348,7 +1405,144 @@ mpls_ldp_lsp_uninstall_all (struct hash_backet *backet, void *ctxt)
   if (!lsp_table)
     return;
 
-  mpls_lsp_uninstall_all (lsp_table, lsp, ZEBRA_LSP_LDP);
+  /* ldpd never mixes unicast and mLDP NHLFEs under one in-label */
+  mpls_lsp_uninstall_all (lsp_table, lsp,
+                          CHECK_FLAG (lsp->flags, LSP_FLAG_REPLICATE) ?
+                          ZEBRA_LSP_MLDP : ZEBRA_LSP_LDP, 0);
+}
+
+/*
+ * LDP graceful restart (RFC 3478). When ldpd goes away its LSPs are kept
+ * in the forwarding plane but flagged stale. Each NHLFE the restarted
+ * ldpd installs again clears the flag; when the timer fires, only what
+ * is still stale is removed.
+ */
+static void
+mpls_ldp_lsp_mark_stale (struct hash_backet *backet, void *ctxt)
+{
+  zebra_lsp_t *lsp;
+  zebra_nhlfe_t *nhlfe;
+
+  lsp = (zebra_lsp_t *) backet->data;
+  if (!lsp)
+    return;
+
+  for (nhlfe = lsp->nhlfe_list; nhlfe; nhlfe = nhlfe->next)
+    if (nhlfe->type == ZEBRA_LSP_LDP || nhlfe->type == ZEBRA_LSP_MLDP)
+      SET_FLAG (nhlfe->flags, NHLFE_FLAG_STALE);
+}
+
+static void
+mpls_ldp_lsp_sweep_stale (struct hash_backet *backet, void *ctxt)
+{
+  zebra_lsp_t *lsp;
+  struct zebra_vrf *zvrf;
+
+  lsp = (zebra_lsp_t *) backet->data;
+  if (!lsp || !lsp->nhlfe_list)
+    return;
+
+  zvrf = ctxt;
+  mpls_lsp_uninstall_all (zvrf->lsp_table, lsp,
+                          CHECK_FLAG (lsp->flags, LSP_FLAG_REPLICATE) ?
+                          ZEBRA_LSP_MLDP : ZEBRA_LSP_LDP, NHLFE_FLAG_STALE);
+}
+
+static int
+mpls_ldp_gr_timer (struct thread *thread)
+{
+  struct zebra_vrf *zvrf;
+
+  zvrf = THREAD_ARG (thread);
+  zvrf->t_ldp_gr = NULL;
+
+  if (IS_ZEBRA_DEBUG_MPLS)
+    zlog_debug ("LDP graceful restart timer expired, sweeping stale LSPs");
+  hash_iterate (zvrf->lsp_table, mpls_ldp_lsp_sweep_stale, zvrf);
+
+  return 0;
+}
+
+void
+zebra_mpls_ldp_gr_set (struct zebra_vrf *zvrf, u_int32_t seconds)
+{
+  zvrf->ldp_gr_time = seconds;
+}
+
+struct ldp_stale_labels
+{
+  mpls_label_t *labels;
+  u_int32_t count;
+  u_int32_t size;
+};
+
+static void
+mpls_ldp_lsp_collect_stale (struct hash_backet *backet, void *ctxt)
+{
+  struct ldp_stale_labels *stale = ctxt;
+  zebra_lsp_t *lsp;
+  zebra_nhlfe_t *nhlfe;
+
+  lsp = (zebra_lsp_t *) backet->data;
+  if (!lsp)
+    return;
+
+  for (nhlfe = lsp->nhlfe_list; nhlfe; nhlfe = nhlfe->next)
+    if (CHECK_FLAG (nhlfe->flags, NHLFE_FLAG_STALE))
+      break;
+  if (!nhlfe)
+    return;
+
+  if (stale->count == stale->size)
+    {
+      stale->size = stale->size ? stale->size * 2 : 256;
+      stale->labels = XREALLOC (MTYPE_TMP, stale->labels,
+                                stale->size * sizeof (mpls_label_t));
+    }
+  stale->labels[stale->count++] = lsp->ile.in_label;
+}
+
+u_int32_t
+zebra_mpls_ldp_gr_remain (struct zebra_vrf *zvrf)
+{
+  if (!zvrf->t_ldp_gr)
+    return 0;
+
+  return thread_timer_remain_second (zvrf->t_ldp_gr);
+}
+
+mpls_label_t *
+zebra_mpls_ldp_stale_labels (struct zebra_vrf *zvrf, u_int32_t *count)
+{
+  struct ldp_stale_labels stale;
+
+  memset (&stale, 0, sizeof (stale));
+  if (zvrf->t_ldp_gr && zvrf->lsp_table)
+    hash_iterate (zvrf->lsp_table, mpls_ldp_lsp_collect_stale, &stale);
+
+  *count = stale.count;
+  return stale.labels;
+}
+
+void
+zebra_mpls_ldp_client_close (struct zebra_vrf *zvrf)
+{
+  if (!zvrf || !zvrf->lsp_table)
+    return;
+
+  if (zvrf->ldp_gr_time == 0)
+    {
+      THREAD_TIMER_OFF (zvrf->t_ldp_gr);
+      hash_iterate (zvrf->lsp_table, mpls_ldp_lsp_uninstall_all, zvrf);
+      return;
+    }
+
+  zlog_notice ("LDP graceful restart: preserving LDP LSPs for %u seconds",
+               zvrf->ldp_gr_time);
+  hash_iterate (zvrf->lsp_table, mpls_ldp_lsp_mark_stale, NULL);
+  THREAD_TIMER_OFF (zvrf->t_ldp_gr);
+  zvrf->t_ldp_gr = thread_add_timer (zebrad.master, mpls_ldp_gr_timer, zvrf,
+                                     zvrf->ldp_gr_time);
 }
 
 /*
@@ -94,6 +94,7 @@ struct zebra_nhlfe_t_
 #define NHLFE_FLAG_MULTIPATH   (1 << 2)
 #define NHLFE_FLAG_DELETED     (1 << 3)
 #define NHLFE_FLAG_INSTALLED   (1 << 4)
+#define NHLFE_FLAG_STALE       (1 << 5)
 
   zebra_nhlfe_t *next;
   zebra_nhlfe_t *prev;
@@ -139,6 +140,8 @@ struct zebra_lsp_t_
 #define LSP_FLAG_SCHEDULED        (1 << 0)
 #define LSP_FLAG_INSTALLED        (1 << 1)
 #define LSP_FLAG_CHANGED          (1 << 2)
+#define LSP_FLAG_REPLICATE        (1 << 3)
+#define LSP_FLAG_BRANCH_WARNED    (1 << 4)
 
   /* Address-family of NHLFE - saved here for delete. All NHLFEs */
   /* have to be of the same AF */
@@ -190,6 +193,33 @@ mpls_lsp_uninstall (struct zebra_vrf *zvrf, enum lsp_types_t type,
 void
 mpls_ldp_lsp_uninstall_all (struct hash_backet *backet, void *ctxt);
 
+/*
+ * Set how long LDP LSPs are preserved when the ldpd session drops
+ * (graceful restart). Zero disables preservation.
+ */
+void
+zebra_mpls_ldp_gr_set (struct zebra_vrf *zvrf, u_int32_t seconds);
+
+/*
+ * Seconds left before stale LDP LSPs are swept, zero when none are kept.
+ */
+u_int32_t
+zebra_mpls_ldp_gr_remain (struct zebra_vrf *zvrf);
+
+/*
+ * In-labels that still have stale LDP NHLFEs. The array is allocated
+ * with MTYPE_TMP and its length stored in count; the caller frees it.
+ */
+mpls_label_t *
+zebra_mpls_ldp_stale_labels (struct zebra_vrf *zvrf, u_int32_t *count);
+
+/*
+ * ldpd went away: either flush its LSPs or, with graceful restart,
+ * mark them stale and sweep whatever was not refreshed on expiry.
+ */
+void
+zebra_mpls_ldp_client_close (struct zebra_vrf *zvrf);
+
 /*
  * Check that the label values used in LSP creation are consistent. The
  * main criteria is that if there is ECMP, the label operation must still
@@ -313,6 +343,8 @@ nhlfe_type2str(enum lsp_types_t lsp_type)
         return "Static";
       case ZEBRA_LSP_LDP:
         return "LDP";
+      case ZEBRA_LSP_MLDP:
+        return "mLDP";
       default:
         return "Unknown";
     }
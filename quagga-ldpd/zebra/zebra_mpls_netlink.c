@@ -49,11 +49,9 @@ kernel_add_lsp (zebra_lsp_t *lsp)
  * forwarding entry is already installed and needs an update - either a new
  * path is to be added, an installed path has changed (e.g., outgoing label)
  * or an installed path (but not all paths) has to be removed.
- * TODO: Performs a DEL followed by ADD now, need to change to REPLACE. Note
- * that REPLACE was originally implemented for IPv4 nexthops but removed as
- * it was not functioning when moving from swap to PHP as that was signaled
- * through the metric field (before kernel-MPLS). This shouldn't be an issue
- * any longer, so REPLACE can be reintroduced.
+ * The whole path set is rewritten with a single REPLACE, so the paths that
+ * did not change (e.g. the other branches of an mLDP tree) keep forwarding
+ * while the entry is updated.
  */
 int
 kernel_upd_lsp (zebra_lsp_t *lsp)
@@ -65,11 +63,8 @@ kernel_upd_lsp (zebra_lsp_t *lsp)
 
   UNSET_FLAG (lsp->flags, LSP_FLAG_CHANGED);
 
-  /* First issue a DEL and clear the installed flag. */
-  netlink_mpls_multipath (RTM_DELROUTE, lsp);
-  UNSET_FLAG (lsp->flags, LSP_FLAG_INSTALLED);
-
-  /* Then issue an ADD. */
+  /* Only the paths in the new set end up marked as installed. */
+  clear_nhlfe_installed (lsp);
   ret = netlink_mpls_multipath (RTM_NEWROUTE, lsp);
   if (!ret)
     SET_FLAG (lsp->flags, LSP_FLAG_INSTALLED);
@@ -39,6 +39,7 @@
 #include "vrf.h"
 
 #include "zebra/zserv.h"
+#include "zebra/interface.h"
 #include "zebra/router-id.h"
 #include "zebra/redistribute.h"
 #include "zebra/debug.h"
@@ -772,6 +773,30 @@ zsend_router_id_update (struct zserv *client, struct prefix *p,
   return zebra_server_send_message(client);
 }
 
+/* Relay the LDP-IGP synchronization state of an interface to a client. */
+int
+zsend_ldp_sync_update (struct zserv *client, struct interface *ifp)
+{
+  struct zebra_if *zif = ifp->info;
+  struct stream *s;
+
+  /* Check this client need interface information. */
+  if (! vrf_bitmap_check (client->ifinfo, ifp->vrf_id))
+    return 0;
+
+  s = client->obuf;
+  stream_reset (s);
+
+  zserv_create_header (s, ZEBRA_MPLS_LDP_SYNC, ifp->vrf_id);
+  stream_putl (s, ifp->ifindex);
+  stream_putc (s, zif->ldp_sync);
+
+  /* Write packet size. */
+  stream_putw_at (s, 0, stream_get_endp (s));
+
+  return zebra_server_send_message(client);
+}
+
 /* Register zebra server interface information.  Send current all
    interface and address information. */
 static int
@@ -781,6 +806,7 @@ zread_interface_add (struct zserv *client, u_short length, vrf_id_t vrf_id)
   struct listnode *cnode, *cnnode;
   struct interface *ifp;
   struct connected *c;
+  struct zebra_if *zif;
 
   /* Interface information is needed. */
   vrf_bitmap_set (client->ifinfo, vrf_id);
@@ -801,6 +827,11 @@ zread_interface_add (struct zserv *client, u_short length, vrf_id_t vrf_id)
 				        ifp, c) < 0))
 	    return -1;
 	}
+
+      zif = ifp->info;
+      if (zif && zif->ldp_sync != LDP_IGP_SYNC_OFF &&
+	  zsend_ldp_sync_update (client, ifp) < 0)
+	return -1;
     }
   return 0;
 }
@@ -1328,6 +1359,122 @@ zread_mpls_lsp (int command, struct zserv *client, u_short length,
 #endif
 }
 
+#if defined(HAVE_MPLS)
+/* Stale in-labels per message, well within ZEBRA_MAX_PACKET_SIZ. */
+#define ZEBRA_LDP_GR_STALE_CHUNK 512
+
+/*
+ * Tell a (re)started ldpd which in-labels still forward on stale LSPs
+ * and for how many seconds, so it keeps them out of its allocator. A
+ * single empty message with zero seconds means a cold start.
+ */
+static int
+zsend_mpls_ldp_gr_stale (struct zserv *client, struct zebra_vrf *zvrf)
+{
+  struct stream *s;
+  mpls_label_t *labels;
+  u_int32_t remain, count, i, n;
+
+  remain = zebra_mpls_ldp_gr_remain (zvrf);
+  labels = zebra_mpls_ldp_stale_labels (zvrf, &count);
+
+  i = 0;
+  do
+    {
+      n = MIN (count - i, ZEBRA_LDP_GR_STALE_CHUNK);
+
+      s = client->obuf;
+      stream_reset (s);
+
+      zserv_create_header (s, ZEBRA_MPLS_LDP_GR_STALE, zvrf->vrf_id);
+      stream_putl (s, remain);
+      stream_putl (s, n);
+      for (; n > 0; n--)
+        stream_putl (s, labels[i++]);
+
+      /* Write packet size. */
+      stream_putw_at (s, 0, stream_get_endp (s));
+
+      if (zebra_server_send_message (client) < 0)
+        break;
+    }
+  while (i < count);
+
+  if (labels)
+    XFREE (MTYPE_TMP, labels);
+
+  return 0;
+}
+#endif /* HAVE_MPLS */
+
+/* ldpd tells how long its LSPs should survive a session loss. */
+static int
+zread_mpls_ldp_gr (struct zserv *client, u_short length, vrf_id_t vrf_id)
+{
+#if defined(HAVE_MPLS)
+  struct zebra_vrf *zvrf;
+  u_int32_t seconds;
+
+  seconds = stream_getl (client->ibuf);
+
+  zvrf = vrf_info_lookup (vrf_id);
+  if (!zvrf)
+    return -1;
+
+  zebra_mpls_ldp_gr_set (zvrf, seconds);
+  zsend_mpls_ldp_gr_stale (client, zvrf);
+#endif
+  return 0;
+}
+
+static void
+zebra_ldp_sync_set (struct interface *ifp, u_char state)
+{
+  struct zebra_if *zif = ifp->info;
+  struct listnode *node;
+  struct zserv *client;
+
+  if (zif == NULL || zif->ldp_sync == state)
+    return;
+  zif->ldp_sync = state;
+
+  for (ALL_LIST_ELEMENTS_RO (zebrad.client_list, node, client))
+    zsend_ldp_sync_update (client, ifp);
+}
+
+/* ldpd reports whether the label exchange over a link is complete, the
+ * IGPs keep the link at maximum metric until it is (RFC 5443). */
+static int
+zread_mpls_ldp_sync (struct zserv *client, u_short length, vrf_id_t vrf_id)
+{
+  struct interface *ifp;
+  ifindex_t ifindex;
+  u_char state;
+
+  ifindex = stream_getl (client->ibuf);
+  state = stream_getc (client->ibuf);
+
+  client->ldp_sync = 1;
+
+  ifp = if_lookup_by_index_vrf (ifindex, vrf_id);
+  if (ifp == NULL)
+    return 0;
+
+  zebra_ldp_sync_set (ifp, state);
+  return 0;
+}
+
+/* Without ldpd the IGPs go back to their configured metrics. */
+static void
+zebra_ldp_sync_reset (void)
+{
+  struct listnode *node;
+  struct interface *ifp;
+
+  for (ALL_LIST_ELEMENTS_RO (vrf_iflist (VRF_DEFAULT), node, ifp))
+    zebra_ldp_sync_set (ifp, LDP_IGP_SYNC_OFF);
+}
+
 /* If client sent routes of specific type, zebra removes it
  * and returns number of deleted routes.
  */
@@ -1346,7 +1493,7 @@ zebra_score_rib (int client_sock)
                       client_sock, rib_score_proto (i), zebra_route_string (i));
         route_type_oaths[i] = 0;
         if (i == ZEBRA_ROUTE_LDP)
-	  hash_iterate(zvrf->lsp_table, mpls_ldp_lsp_uninstall_all, zvrf);
+	  zebra_mpls_ldp_client_close (zvrf);
         break;
       }
 }
@@ -1381,6 +1528,8 @@ zebra_client_close (struct zserv *client)
 
   /* Free client structure. */
   listnode_delete (zebrad.client_list, client);
+  if (client->ldp_sync)
+    zebra_ldp_sync_reset ();
   XFREE (0, client);
 }
 
@@ -1587,6 +1736,12 @@ zebra_client_read (struct thread *thread)
     case ZEBRA_MPLS_LSP_DELETE:
       zread_mpls_lsp(command, client, length, vrf_id);
       break;
+    case ZEBRA_MPLS_LDP_GR:
+      zread_mpls_ldp_gr(client, length, vrf_id);
+      break;
+    case ZEBRA_MPLS_LDP_SYNC:
+      zread_mpls_ldp_sync (client, length, vrf_id);
+      break;
     default:
       zlog_info ("Zebra received unknown command %d", command);
       break;
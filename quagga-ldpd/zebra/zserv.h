@@ -67,6 +67,9 @@ struct zserv
 
   /* Router-id information. */
   vrf_bitmap_t ridinfo;
+
+  /* This client reports LDP-IGP synchronization state. */
+  u_char ldp_sync;
 };
 
 /* Zebra instance */
@@ -111,6 +114,7 @@ extern int zsend_interface_address (int, struct zserv *, struct interface *,
 extern int zsend_interface_update (int, struct zserv *, struct interface *);
 extern int zsend_route_multipath (int, struct zserv *, struct prefix *, 
                                   struct rib *);
+extern int zsend_ldp_sync_update (struct zserv *, struct interface *);
 extern int zsend_router_id_update (struct zserv *, struct prefix *,
                                    vrf_id_t);
 